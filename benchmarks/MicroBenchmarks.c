@@ -0,0 +1,280 @@
+/* iMate -- Copyright (C) 2024 Martin Newbound */
+
+/**
+ * @file MicroBenchmarks.c
+ * @brief Times the primitives the search is built on, in isolation, over the positions of the "bench" command.
+ *
+ * @details Every benchmark runs one warm-up pass over the corpus, then a number of timed samples. Each sample
+ * runs the primitive enough times to last about SAMPLE_TARGET_NS, and the median, minimum and spread of the
+ * samples are reported in nanoseconds per operation. Comparing two builds shows which primitive a change
+ * in search speed comes from.
+ *
+ * Usage: iMateBench [samples] [name filter] [auto|pext|magic]
+ */
+
+#include "State/GameState.h"
+#include "State/Zobrist.h"
+#include "Moves/MoveGeneration.h"
+#include "Moves/SliderAttacks.h"
+#include "Evaluation/Evaluation.h"
+#include "Evaluation/BatchEvaluation.h"
+#include "Utils/Clock.h"
+#include "Utils/BenchPositions.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DEFAULT_SAMPLE_COUNT 15
+#define MAX_SAMPLE_COUNT 101
+
+// Each sample should last long enough for the clock resolution to be irrelevant
+#define SAMPLE_TARGET_NS 20000000LL
+
+#define MAX_CORPUS_SIZE 256
+
+// Most legal moves kept per position for the play_move benchmark
+#define MAX_POSITION_MOVES 256
+
+/**
+ * @brief A benchmark: runs a primitive once over every position of the corpus.
+ *
+ * @return The number of operations performed.
+ */
+typedef uint64_t (*benchmark_func_t)(void);
+
+typedef struct {
+    const char *name;
+    benchmark_func_t func;
+} benchmark_t;
+
+// The corpus, loaded once
+static state_t *positions[MAX_CORPUS_SIZE];
+static move_t *position_moves[MAX_CORPUS_SIZE][MAX_POSITION_MOVES];
+static int position_move_counts[MAX_CORPUS_SIZE];
+static int position_count;
+
+// The corpus as a batch, and the scores it is evaluated into
+static evaluation_batch_t *batch;
+static float batch_scores[MAX_CORPUS_SIZE];
+
+// Results are accumulated here so the compiler cannot discard the work being timed
+static volatile uint64_t sink;
+
+
+/*
++=============================================================================+
+|             Benchmarks                                                      |
++=============================================================================+
+*/
+
+static uint64_t bench_pseudo_legal_generation(void) {
+    for (int i = 0; i < position_count; i++) {
+        move_collection_t *collection = generate_psudo_legal_moves(positions[i]);
+        move_t *move;
+        while ((move = pop_collection_head(collection)) != NULL) free_move(move);
+        free_move_collection(collection);
+    }
+    return position_count;
+}
+
+static uint64_t bench_legal_generation(void) {
+    for (int i = 0; i < position_count; i++) {
+        move_collection_t *collection = get_legal_moves_of_state(positions[i]);
+        move_t *move;
+        while ((move = pop_collection_head(collection)) != NULL) free_move(move);
+        free_move_collection(collection);
+    }
+    return position_count;
+}
+
+static uint64_t bench_play_move(void) {
+    state_t *scratch = new_state();
+    uint64_t operations = 0;
+
+    // The search copies the state before every move, so the copy is part of the cost of a move
+    for (int i = 0; i < position_count; i++) {
+        for (int j = 0; j < position_move_counts[i]; j++) {
+            copy_state(positions[i], scratch);
+            play_move(scratch, position_moves[i][j]);
+            sink += get_state_hash_key(scratch);
+        }
+        operations += position_move_counts[i];
+    }
+
+    free_state(scratch);
+    return operations;
+}
+
+static uint64_t bench_attack_detection(void) {
+    for (int i = 0; i < position_count; i++) {
+        for (int square = 0; square < 64; square++) {
+            sink += is_square_attacked(positions[i], 1ULL << square, WHITE);
+            sink += is_square_attacked(positions[i], 1ULL << square, BLACK);
+        }
+    }
+    return (uint64_t)position_count * 128;
+}
+
+static uint64_t bench_slider_attacks(void) {
+    uint64_t operations = 0;
+    for (int i = 0; i < position_count; i++) {
+        const uint64_t occupancy = states_color_bitboard(positions[i], WHITE) | states_color_bitboard(positions[i], BLACK);
+        for (int square = 0; square < 64; square++) sink += get_queen_attacks(square, occupancy);
+        operations += 64;
+    }
+    return operations;
+}
+
+static uint64_t bench_check_detection(void) {
+    for (int i = 0; i < position_count; i++) {
+        sink += is_check(positions[i], get_state_to_move_color(positions[i]));
+    }
+    return position_count;
+}
+
+static uint64_t bench_evaluation(void) {
+    for (int i = 0; i < position_count; i++) {
+        sink += (uint64_t)(int64_t)evaluate_state(positions[i]);
+    }
+    return position_count;
+}
+
+static uint64_t bench_batch_evaluation(void) {
+    evaluate_batch(batch, batch_scores);
+    sink += (uint64_t)(int64_t)batch_scores[0];
+    return get_evaluation_batch_size(batch);
+}
+
+// The batch refilled from the states before it is evaluated, the cost to compare with evaluate_state
+static uint64_t bench_filled_batch_evaluation(void) {
+    clear_evaluation_batch(batch);
+    for (int i = 0; i < position_count; i++) add_evaluation_batch_position(batch, positions[i]);
+    return bench_batch_evaluation();
+}
+
+static uint64_t bench_hashing(void) {
+    for (int i = 0; i < position_count; i++) {
+        sink += compute_state_hash_key(positions[i]);
+    }
+    return position_count;
+}
+
+static const benchmark_t BENCHMARKS[] = {
+    {"pseudo_legal_generation", bench_pseudo_legal_generation},
+    {"legal_generation",        bench_legal_generation},
+    {"play_move",               bench_play_move},
+    {"is_square_attacked",      bench_attack_detection},
+    {"is_check",                bench_check_detection},
+    {"queen_attacks",           bench_slider_attacks},
+    {"evaluate_state",          bench_evaluation},
+    {"evaluate_batch",          bench_batch_evaluation},
+    {"add_and_evaluate_batch",  bench_filled_batch_evaluation},
+    {"compute_hash_key",        bench_hashing},
+};
+
+
+/*
++=============================================================================+
+|             Measurement                                                     |
++=============================================================================+
+*/
+
+static int compare_doubles(const void *a, const void *b) {
+    const double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Times a benchmark and prints one line of results.
+ *
+ * @param benchmark The benchmark to run.
+ * @param sample_count The number of timed samples.
+ */
+static void run_benchmark(const benchmark_t *benchmark, int sample_count) {
+    // Warm up the caches and branch predictors, and find how many passes fill a sample
+    int64_t start = get_time_ns();
+    uint64_t operations_per_pass = benchmark->func();
+    const int64_t pass_ns = get_time_ns() - start;
+    const int passes = pass_ns > 0 && pass_ns < SAMPLE_TARGET_NS ? (int)(SAMPLE_TARGET_NS / pass_ns) : 1;
+
+    double samples[MAX_SAMPLE_COUNT];
+    for (int i = 0; i < sample_count; i++) {
+        uint64_t operations = 0;
+        start = get_time_ns();
+        for (int pass = 0; pass < passes; pass++) operations += benchmark->func();
+        samples[i] = (double)(get_time_ns() - start) / (double)operations;
+    }
+
+    double mean = 0, variance = 0;
+    for (int i = 0; i < sample_count; i++) mean += samples[i];
+    mean /= sample_count;
+    for (int i = 0; i < sample_count; i++) variance += (samples[i] - mean) * (samples[i] - mean);
+    const double deviation = sample_count > 1 ? sqrt(variance / (sample_count - 1)) : 0;
+
+    qsort(samples, sample_count, sizeof(double), compare_doubles);
+
+    printf("%-24s %12llu %12.1f %12.1f %9.1f%%\n", benchmark->name,
+           (unsigned long long)operations_per_pass * passes, samples[sample_count / 2], samples[0],
+           mean > 0 ? 100 * deviation / mean : 0);
+}
+
+/**
+ * @brief Loads the corpus and the legal moves of each of its positions.
+ */
+static void load_corpus(void) {
+    for (int i = 0; i < BENCH_POSITION_COUNT && position_count < MAX_CORPUS_SIZE; i++) {
+        state_t *state = new_state();
+        if (!load_fen_string(state, BENCH_POSITIONS[i])) {
+            free_state(state);
+            continue;
+        }
+
+        move_collection_t *collection = get_legal_moves_of_state(state);
+        move_t *move;
+        while ((move = pop_collection_head(collection)) != NULL) {
+            if (position_move_counts[position_count] < MAX_POSITION_MOVES) position_moves[position_count][position_move_counts[position_count]++] = move;
+            else free_move(move);
+        }
+        free_move_collection(collection);
+
+        positions[position_count++] = state;
+    }
+
+    batch = new_evaluation_batch(position_count);
+    for (int i = 0; i < position_count; i++) add_evaluation_batch_position(batch, positions[i]);
+}
+
+static void free_corpus(void) {
+    for (int i = 0; i < position_count; i++) {
+        for (int j = 0; j < position_move_counts[i]; j++) free_move(position_moves[i][j]);
+        free_state(positions[i]);
+    }
+    free_evaluation_batch(batch);
+}
+
+int main(int argc, char **argv) {
+    int sample_count = argc > 1 ? atoi(argv[1]) : DEFAULT_SAMPLE_COUNT;
+    if (sample_count < 1) sample_count = 1;
+    if (sample_count > MAX_SAMPLE_COUNT) sample_count = MAX_SAMPLE_COUNT;
+    const char *filter = argc > 2 ? argv[2] : "";
+    const char *lookup = argc > 3 ? argv[3] : "auto";
+
+    init_zobrist_keys();
+    if (!set_slider_lookup(strcmp(lookup, "pext") == 0 ? SLIDER_LOOKUP_PEXT : strcmp(lookup, "magic") == 0 ? SLIDER_LOOKUP_MAGIC : SLIDER_LOOKUP_AUTO)) {
+        fprintf(stderr, "slider lookup %s not supported\n", lookup);
+        return 1;
+    }
+    load_corpus();
+
+    printf("%d positions, %d samples per benchmark, %s slider lookups\n\n", position_count, sample_count, get_slider_lookup_name());
+    printf("%-24s %12s %12s %12s %10s\n", "benchmark", "ops/sample", "median ns", "min ns", "spread");
+
+    for (size_t i = 0; i < sizeof(BENCHMARKS) / sizeof(BENCHMARKS[0]); i++) {
+        if (strstr(BENCHMARKS[i].name, filter) != NULL) run_benchmark(&BENCHMARKS[i], sample_count);
+    }
+
+    free_corpus();
+    return 0;
+}
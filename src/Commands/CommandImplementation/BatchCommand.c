@@ -0,0 +1,247 @@
+/* iMate -- Copyright (C) 2024 Martin Newbound */
+
+#include "../Commands.h"
+#include "../../Search/Search.h"
+#include "../../Search/TranspositionTable.h"
+#include "../../Search/SearchStats.h"
+#include "../../Threads/ThreadPool.h"
+#include "../../Utils/Clock.h"
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Search time per position when the command sets no limit, in milliseconds
+#define DEFAULT_BATCH_MOVE_TIME 1000
+
+// Large enough for a result with a full length principal variation
+#define RESULT_BUFFER_LENGTH 2048
+
+// Longest part of the input line echoed in a result, longer lines are cut
+#define MAX_ECHOED_FEN_LENGTH 128
+
+// Room kept at the end of a result for the closing "]}\n"
+#define RESULT_CLOSING_LENGTH 4
+
+/**
+ * @brief The resources shared by the jobs of a batch run.
+ */
+typedef struct {
+    search_limits_t limits;
+
+    // One search context, state and transposition table per worker, the tables may all be the same one
+    search_t **searches;
+    state_t **states;
+    transposition_table_t **tables;
+    bool shared_hash;
+
+    pthread_mutex_t output_lock;
+    uint64_t total_nodes;
+    int position_count;
+} batch_t;
+
+/**
+ * @brief A position to analyze.
+ */
+typedef struct {
+    batch_t *batch;
+    int index;
+    char *fen;
+} batch_job_t;
+
+/**
+ * @brief Writes at most MAX_ECHOED_FEN_LENGTH characters of a string as a JSON string literal.
+ *
+ * @param buffer The buffer to write to.
+ * @param size The size of the buffer, at least 3.
+ * @param text The string to write.
+ * @return The number of characters written.
+ */
+static int write_json_string(char *buffer, size_t size, const char *text) {
+    size_t length = 0;
+    buffer[length++] = '"';
+
+    // Every character takes at most two places, the closing quote and terminator two more
+    for (int i = 0; *text && i < MAX_ECHOED_FEN_LENGTH && length + 4 <= size; text++, i++) {
+        if (*text == '"' || *text == '\\') buffer[length++] = '\\';
+        if ((unsigned char)*text >= ' ') buffer[length++] = *text;
+    }
+
+    buffer[length++] = '"';
+    buffer[length] = '\0';
+    return (int)length;
+}
+
+/**
+ * @brief Appends formatted text to a result, dropping it unless it fits whole before the closing characters.
+ *
+ * @param buffer The result buffer, RESULT_BUFFER_LENGTH characters long.
+ * @param length The length of the result, updated.
+ * @param format The format of the text, as for printf.
+ */
+static void append_result(char *buffer, int *length, const char *format, ...) {
+    const int size = RESULT_BUFFER_LENGTH - RESULT_CLOSING_LENGTH;
+    if (*length >= size) return;
+
+    va_list arguments;
+    va_start(arguments, format);
+    const int written = vsnprintf(buffer + *length, size - *length, format, arguments);
+    va_end(arguments);
+
+    if (written > 0 && *length + written < size) *length += written;
+    else buffer[*length] = '\0';
+}
+
+/**
+ * @brief Analyzes one position and prints the result as a line of JSON.
+ *
+ * @param argument The batch job, freed once the result is printed.
+ * @param worker_index The index of the worker running the job.
+ */
+static void run_batch_job(void *argument, int worker_index) {
+    batch_job_t *job = argument;
+    batch_t *batch = job->batch;
+
+    char output[RESULT_BUFFER_LENGTH];
+    int length = snprintf(output, sizeof(output), "{\"index\":%d,\"fen\":", job->index);
+    length += write_json_string(output + length, sizeof(output) - RESULT_CLOSING_LENGTH - length, job->fen);
+
+    search_result_t result = {0};
+    state_t *state = batch->states[worker_index];
+
+    if (!load_fen_string(state, job->fen)) {
+        append_result(output, &length, ",\"error\":\"invalid fen\"");
+    } else {
+        search_t *search = batch->searches[worker_index];
+        clear_search_heuristics(search);
+        if (!batch->shared_hash) age_transposition_table(batch->tables[worker_index]);
+        result = do_move_search(search, state, &batch->limits);
+
+        char move_string[MOVE_STRING_LENGTH] = "0000";
+        if (result.best_move != NULL_MOVE_KEY) move_key_to_string(result.best_move, move_string);
+
+        append_result(output, &length, ",\"bestmove\":\"%s\",\"score\":{\"%s\":%d}",
+                      move_string, IS_MATE_SCORE(result.score) ? "mate" : "cp",
+                      IS_MATE_SCORE(result.score) ? MATE_IN_MOVES(result.score) : result.score);
+        append_result(output, &length, ",\"depth\":%d,\"seldepth\":%d,\"nodes\":%llu,\"time_ms\":%lld,\"pv\":[",
+                      result.depth, result.seldepth, (unsigned long long)result.nodes, (long long)result.time_ms);
+
+        for (int i = 0; i < result.pv_length; i++) {
+            move_key_to_string(result.pv[i], move_string);
+            append_result(output, &length, i == 0 ? "\"%s\"" : ",\"%s\"", move_string);
+        }
+
+        output[length++] = ']';
+    }
+
+    // The closing characters always fit, their room is kept by every write above
+    output[length++] = '}';
+    output[length++] = '\n';
+    output[length] = '\0';
+
+    // Results are written whole, in the order they complete
+    pthread_mutex_lock(&batch->output_lock);
+    fputs(output, stdout);
+    fflush(stdout);
+    batch->total_nodes += result.nodes;
+    batch->position_count++;
+    pthread_mutex_unlock(&batch->output_lock);
+
+    free(job->fen);
+    free(job);
+}
+
+/**
+ * @brief Executes the 'batch' command.
+ *
+ * This function analyzes every FEN string of a file (or of standard input when the file is "-") on a pool of
+ * worker threads, each with its own game state and search context. By default every worker has a private
+ * transposition table of the given size in megabytes, "sharedhash" makes all workers share the engine's table.
+ * A line of JSON is printed per position as soon as its search ends, followed by a summary line.
+ * The command has the form "batch <file>|- [depth|nodes|movetime <x>] [threads <n>] [hash <mb>] [sharedhash]".
+ * 
+ * @param params The command parameters, including the engine's search thread.
+ */
+void batch_command(const CommandParams params) {
+    const bool read_stdin = strcmp(params.tokens[1], "-") == 0;
+    FILE *file = read_stdin ? stdin : fopen(params.tokens[1], "r");
+    if (file == NULL) {
+        printf("info string cannot open %s\n", params.tokens[1]);
+        return;
+    }
+
+    batch_t batch = {0};
+    init_search_limits(&batch.limits);
+    parse_go_arguments(params.tokens + 2, params.token_count - 2, &batch.limits);
+    if (!batch.limits.depth && !batch.limits.nodes && !batch.limits.move_time) batch.limits.move_time = DEFAULT_BATCH_MOVE_TIME;
+    batch.limits.infinite = false;
+
+    int thread_count = get_processor_count();
+    size_t hash_size_mb = DEFAULT_HASH_SIZE_MB;
+    for (int i = 2; i < params.token_count; i++) {
+        if (strcmp(params.tokens[i], "sharedhash") == 0) batch.shared_hash = true;
+        else if (i + 1 < params.token_count && strcmp(params.tokens[i], "threads") == 0) thread_count = atoi(params.tokens[++i]);
+        else if (i + 1 < params.token_count && strcmp(params.tokens[i], "hash") == 0) hash_size_mb = (size_t)atoll(params.tokens[++i]);
+    }
+
+    stop_search_thread(params.engine_search_thread);
+
+    thread_pool_t *pool = new_thread_pool(thread_count);
+    thread_count = get_thread_pool_size(pool);
+
+    batch.searches = malloc(sizeof(search_t *) * thread_count);
+    batch.states = malloc(sizeof(state_t *) * thread_count);
+    batch.tables = malloc(sizeof(transposition_table_t *) * thread_count);
+    pthread_mutex_init(&batch.output_lock, NULL);
+
+    for (int i = 0; i < thread_count; i++) {
+        batch.tables[i] = batch.shared_hash ? get_search_thread_table(params.engine_search_thread) : new_transposition_table(hash_size_mb);
+        batch.searches[i] = new_search(batch.tables[i]);
+        batch.states[i] = new_state();
+        set_search_reporting(batch.searches[i], false);
+    }
+
+    // A shared table is aged once, the searches running in parallel all belong to the same generation
+    if (batch.shared_hash) age_transposition_table(get_search_thread_table(params.engine_search_thread));
+
+    reset_search_stats_report();
+    const int64_t start_time = get_time_ms();
+
+    // Jobs are queued as lines are read, so results stream out while the input is still arriving
+    char *line = NULL;
+    size_t line_capacity = 0;
+    int job_count = 0;
+
+    while (getline(&line, &line_capacity, file) != -1) {
+        line[strcspn(line, "\r\n")] = '\0';
+        const char *fen = line + strspn(line, " \t");
+        if (*fen == '\0' || *fen == '#') continue;
+
+        batch_job_t *job = malloc(sizeof(batch_job_t));
+        job->batch = &batch;
+        job->index = job_count++;
+        job->fen = strdup(fen);
+        submit_thread_pool_task(pool, run_batch_job, job);
+    }
+
+    free(line);
+    free_thread_pool(pool);
+
+    const int64_t elapsed = get_time_ms() - start_time;
+    printf("{\"positions\":%d,\"threads\":%d,\"nodes\":%llu,\"time_ms\":%lld,\"nps\":%llu}\n",
+           batch.position_count, thread_count, (unsigned long long)batch.total_nodes, (long long)elapsed,
+           (unsigned long long)(elapsed > 0 ? batch.total_nodes * 1000 / elapsed : batch.total_nodes));
+
+    for (int i = 0; i < thread_count; i++) {
+        free_search(batch.searches[i]);
+        free_state(batch.states[i]);
+        if (!batch.shared_hash) free_transposition_table(batch.tables[i]);
+    }
+
+    free(batch.searches);
+    free(batch.states);
+    free(batch.tables);
+    pthread_mutex_destroy(&batch.output_lock);
+    if (!read_stdin) fclose(file);
+}
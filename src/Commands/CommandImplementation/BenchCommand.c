@@ -0,0 +1,69 @@
+/* iMate -- Copyright (C) 2024 Martin Newbound */
+
+#include "../Commands.h"
+#include "../../Search/Search.h"
+#include "../../Search/TranspositionTable.h"
+#include "../../Search/SearchStats.h"
+#include "../../Moves/SliderAttacks.h"
+#include "../../Utils/Clock.h"
+#include "../../Utils/BenchPositions.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define DEFAULT_BENCH_DEPTH 6
+
+
+/**
+ * @brief Executes the 'bench' command.
+ *
+ * This function searches a fixed list of positions to a fixed depth with a private transposition table
+ * of the default size, cleared before every position, and prints the total node count, time and speed.
+ * The node count depends only on the search and evaluation code, so it serves as a signature: a change
+ * which alters the search changes the count, a pure speed-up does not.
+ * The command has the form "bench [depth]".
+ * 
+ * @param params The command parameters, including the engine's search thread.
+ */
+void bench_command(const CommandParams params) {
+    search_limits_t limits;
+    init_search_limits(&limits);
+    limits.depth = params.token_count > 1 ? atoi(params.tokens[1]) : DEFAULT_BENCH_DEPTH;
+    if (limits.depth < 1) limits.depth = DEFAULT_BENCH_DEPTH;
+
+    stop_search_thread(params.engine_search_thread);
+
+    transposition_table_t *table = new_transposition_table(DEFAULT_HASH_SIZE_MB);
+    search_t *search = new_search(table);
+    set_search_reporting(search, false);
+    state_t *state = new_state();
+
+    uint64_t total_nodes = 0;
+    reset_search_stats_report();
+    const int64_t start_time = get_time_ms();
+
+    for (int i = 0; i < BENCH_POSITION_COUNT; i++) {
+        load_fen_string(state, BENCH_POSITIONS[i]);
+        clear_transposition_table(table);
+        clear_search_heuristics(search);
+
+        const search_result_t result = do_move_search(search, state, &limits);
+        total_nodes += result.nodes;
+
+        char move_string[MOVE_STRING_LENGTH] = "0000";
+        if (result.best_move != NULL_MOVE_KEY) move_key_to_string(result.best_move, move_string);
+        printf("Position %2d/%d: bestmove %-5s nodes %llu\n", i + 1, BENCH_POSITION_COUNT, move_string, (unsigned long long)result.nodes);
+    }
+
+    const int64_t elapsed = get_time_ms() - start_time;
+
+    printf("===========================\n");
+    printf("Total time (ms) : %lld\n", (long long)elapsed);
+    printf("Nodes searched  : %llu\n", (unsigned long long)total_nodes);
+    printf("Nodes/second    : %llu\n", (unsigned long long)(elapsed > 0 ? total_nodes * 1000 / elapsed : total_nodes));
+    printf("Slider lookups  : %s\n", get_slider_lookup_name());
+    fflush(stdout);
+
+    free_state(state);
+    free_search(search);
+    free_transposition_table(table);
+}
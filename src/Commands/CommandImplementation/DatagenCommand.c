@@ -0,0 +1,369 @@
+/* iMate -- Copyright (C) 2024 Martin Newbound */
+
+#include "../Commands.h"
+#include "../../Match/SelfPlay.h"
+#include "../../Moves/MoveGeneration.h"
+#include "../../Search/Search.h"
+#include "../../Search/TranspositionTable.h"
+#include "../../State/PackedPosition.h"
+#include "../../Threads/ThreadPool.h"
+#include "../../Utils/Clock.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DEFAULT_DATAGEN_GAMES 1000
+
+// Nodes per move when the command sets no limit: fast games, still deep enough for meaningful scores
+#define DEFAULT_DATAGEN_NODES 5000
+
+// Transposition table of each worker, in megabytes
+#define DEFAULT_DATAGEN_HASH_MB 4
+
+// Random moves played from the starting position before a game is searched
+#define DEFAULT_RANDOM_PLIES 8
+
+// Records handed to the writer at a time (512 KB)
+#define DATAGEN_CHUNK_SIZE 16384
+
+// A progress line is printed every this many games
+#define DATAGEN_REPORT_INTERVAL 100
+
+/**
+ * @brief A buffer of records, written to the file as one piece.
+ */
+typedef struct datagen_chunk {
+    struct datagen_chunk *next;
+    size_t count;
+    packed_position_t positions[DATAGEN_CHUNK_SIZE];
+} datagen_chunk_t;
+
+/**
+ * @brief Writes the chunks filled by the workers on its own thread, so the workers never wait for the disk.
+ */
+typedef struct {
+    FILE *file;
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t has_chunks;
+    datagen_chunk_t *head;
+    datagen_chunk_t *tail;
+    bool is_closing;
+    bool has_failed;
+} datagen_writer_t;
+
+/**
+ * @brief What a worker owns: its player and the records of its current game and chunk.
+ */
+typedef struct {
+    selfplay_player_t player;
+    packed_position_t game[MAX_GAME_PLIES];
+    int game_length;
+    datagen_chunk_t *chunk;
+} datagen_worker_t;
+
+/**
+ * @brief The state of a run, shared by the games running on the workers.
+ */
+typedef struct {
+    datagen_worker_t *workers;
+    datagen_writer_t writer;
+    int random_plies;
+    uint64_t seed;
+
+    atomic_int games_played;
+    atomic_long positions_written;
+    int64_t start_time;
+} datagen_t;
+
+/**
+ * @brief A game of the run.
+ */
+typedef struct {
+    datagen_t *datagen;
+    int index;
+} datagen_job_t;
+
+/**
+ * @brief Generates the next number of a xorshift64* sequence.
+ *
+ * @param seed The generator state, updated in place.
+ * @return The next pseudo random number.
+ */
+static uint64_t next_random(uint64_t *seed) {
+    *seed ^= *seed >> 12;
+    *seed ^= *seed << 25;
+    *seed ^= *seed >> 27;
+    return *seed * 0x2545F4914F6CDD1DULL;
+}
+
+/**
+ * @brief Writes the queued chunks until the writer is closed and its queue is empty.
+ *
+ * @param argument The writer.
+ */
+static void *run_datagen_writer(void *argument) {
+    datagen_writer_t *writer = argument;
+    pthread_mutex_lock(&writer->lock);
+
+    for (;;) {
+        while (writer->head == NULL && !writer->is_closing) pthread_cond_wait(&writer->has_chunks, &writer->lock);
+        if (writer->head == NULL) break;
+
+        datagen_chunk_t *chunk = writer->head;
+        writer->head = chunk->next;
+        if (writer->head == NULL) writer->tail = NULL;
+
+        pthread_mutex_unlock(&writer->lock);
+        const bool written = write_packed_positions(writer->file, chunk->positions, chunk->count);
+        free(chunk);
+        pthread_mutex_lock(&writer->lock);
+
+        if (!written) writer->has_failed = true;
+    }
+
+    pthread_mutex_unlock(&writer->lock);
+    return NULL;
+}
+
+/**
+ * @brief Queues a chunk for writing, taking ownership of it.
+ */
+static void submit_datagen_chunk(datagen_writer_t *writer, datagen_chunk_t *chunk) {
+    chunk->next = NULL;
+
+    pthread_mutex_lock(&writer->lock);
+    if (writer->tail != NULL) writer->tail->next = chunk;
+    else writer->head = chunk;
+    writer->tail = chunk;
+    pthread_cond_signal(&writer->has_chunks);
+    pthread_mutex_unlock(&writer->lock);
+}
+
+static datagen_chunk_t *new_datagen_chunk(void) {
+    datagen_chunk_t *chunk = malloc(sizeof(datagen_chunk_t));
+    chunk->count = 0;
+    return chunk;
+}
+
+/**
+ * @brief Checks whether a move captures or promotes.
+ */
+static bool is_tactical_move(const state_t *state, uint16_t key) {
+    move_t *move = find_legal_move(state, key);
+    if (move == NULL) return false;
+
+    const uint64_t to_square = get_move_to_square(move);
+    const bool is_capture = (states_color_bitboard(state, get_state_to_move_color(state) == WHITE ? BLACK : WHITE) & to_square)
+                         || (to_square == get_en_passant_target(state) && get_piece_on_square(state, get_move_from_square(move)) == PIECE_PAWN);
+    const bool is_promotion = get_move_flags(move)->promotion_piece != NULL_PIECE;
+
+    free_move(move);
+    return is_capture || is_promotion;
+}
+
+/**
+ * @brief Records a searched position of the current game, unless it is not quiet or its score is a mate score.
+ *
+ * Positions in check, and positions whose best move captures or promotes, are dropped: their static evaluation
+ * misses what is about to happen on the board.
+ *
+ * @param context The worker playing the game.
+ * @param state The position searched.
+ * @param result The result of the search.
+ */
+static void record_datagen_position(void *context, const state_t *state, const search_result_t *result) {
+    datagen_worker_t *worker = context;
+    const color_t color = get_state_to_move_color(state);
+
+    if (IS_MATE_SCORE(result->score) || is_check(state, color) || is_tactical_move(state, result->best_move)) return;
+
+    const int score = color == WHITE ? result->score : -result->score;
+    if (pack_position(state, score, PACKED_DRAW, &worker->game[worker->game_length])) worker->game_length++;
+}
+
+/**
+ * @brief Plays random legal moves from the starting position.
+ *
+ * @param state Receives the opening.
+ * @param plies The number of random moves.
+ * @param seed The generator state.
+ * @return false if the random moves ended the game.
+ */
+static bool play_random_opening(state_t *state, int plies, uint64_t *seed) {
+    load_fen_string(state, START_FEN);
+
+    for (int ply = 0; ply < plies; ply++) {
+        move_collection_t *moves = get_legal_moves_of_state(state);
+        move_t *chosen = NULL;
+        uint64_t count = 0;
+
+        // Reservoir sampling picks a move uniformly without counting the moves first
+        move_t *move;
+        while ((move = pop_collection_head(moves)) != NULL) {
+            if (next_random(seed) % ++count == 0) {
+                if (chosen != NULL) free_move(chosen);
+                chosen = move;
+            } else {
+                free_move(move);
+            }
+        }
+
+        free_move_collection(moves);
+        if (chosen == NULL) return false;
+
+        play_move(state, chosen);
+        free_move(chosen);
+    }
+
+    return true;
+}
+
+/**
+ * @brief Plays one game of the run and hands its positions, labeled with the result, to the worker's chunk.
+ *
+ * @param argument The job, freed here.
+ * @param worker_index The index of the worker playing the game.
+ */
+static void run_datagen_job(void *argument, int worker_index) {
+    datagen_job_t *job = argument;
+    datagen_t *datagen = job->datagen;
+    datagen_worker_t *worker = &datagen->workers[worker_index];
+    uint64_t seed = datagen->seed ^ (0x9E3779B97F4A7C15ULL * (uint64_t)(job->index + 1));
+    free(job);
+
+    state_t *opening = new_state();
+    while (!play_random_opening(opening, datagen->random_plies, &seed)) {}
+
+    worker->game_length = 0;
+    const game_result_t result = play_selfplay_game(opening, &worker->player, &worker->player,
+                                                    record_datagen_position, worker, NULL);
+    free_state(opening);
+
+    const uint8_t packed_result = result == GAME_WHITE_WINS ? PACKED_WHITE_WINS
+                                : result == GAME_BLACK_WINS ? PACKED_BLACK_WINS : PACKED_DRAW;
+
+    for (int i = 0; i < worker->game_length; i++) {
+        worker->game[i].result = packed_result;
+        worker->chunk->positions[worker->chunk->count++] = worker->game[i];
+
+        if (worker->chunk->count == DATAGEN_CHUNK_SIZE) {
+            submit_datagen_chunk(&datagen->writer, worker->chunk);
+            worker->chunk = new_datagen_chunk();
+        }
+    }
+
+    const long positions = atomic_fetch_add(&datagen->positions_written, worker->game_length) + worker->game_length;
+    const int games = atomic_fetch_add(&datagen->games_played, 1) + 1;
+
+    if (games % DATAGEN_REPORT_INTERVAL == 0) {
+        const int64_t elapsed = get_time_ms() - datagen->start_time;
+        printf("games %d  positions %ld  %.0f positions/s\n", games, positions, elapsed > 0 ? positions * 1000.0 / elapsed : 0.0);
+        fflush(stdout);
+    }
+}
+
+/**
+ * @brief Executes the 'datagen' command.
+ *
+ * This function plays self-play games from randomized openings on a pool of worker threads and appends their
+ * quiet positions, scored by the search and labeled with the game result, to a file of packed positions. Each
+ * worker owns its search, transposition table and buffers, and full buffers are written by a separate thread.
+ *
+ * The command has the form "datagen <file> [games <n>] [threads <n>] [hash <mb>] [random <plies>] [seed <n>]
+ * [limits]", where limits are those of "go", by default a fixed number of nodes per move.
+ *
+ * @param params The command parameters, including the engine's search thread.
+ */
+void datagen_command(const CommandParams params) {
+    const char *path = params.tokens[1];
+    int game_count = DEFAULT_DATAGEN_GAMES;
+    int thread_count = get_processor_count();
+    size_t hash_size_mb = DEFAULT_DATAGEN_HASH_MB;
+
+    datagen_t datagen = {0};
+    datagen.random_plies = DEFAULT_RANDOM_PLIES;
+    datagen.seed = (uint64_t)get_time_ms();
+
+    for (int i = 2; i + 1 < params.token_count; i++) {
+        const char *token = params.tokens[i];
+
+        if (strcmp(token, "games") == 0) game_count = atoi(params.tokens[++i]);
+        else if (strcmp(token, "threads") == 0) thread_count = atoi(params.tokens[++i]);
+        else if (strcmp(token, "hash") == 0) hash_size_mb = (size_t)atoll(params.tokens[++i]);
+        else if (strcmp(token, "random") == 0) datagen.random_plies = atoi(params.tokens[++i]);
+        else if (strcmp(token, "seed") == 0) datagen.seed = strtoull(params.tokens[++i], NULL, 10);
+    }
+    if (datagen.seed == 0) datagen.seed = 1;
+
+    search_limits_t limits;
+    init_search_limits(&limits);
+    parse_go_arguments(params.tokens + 2, params.token_count - 2, &limits);
+    if (!limits.depth && !limits.nodes && !limits.move_time) limits.nodes = DEFAULT_DATAGEN_NODES;
+    limits.infinite = false;
+
+    datagen.writer.file = fopen(path, "ab");
+    if (datagen.writer.file == NULL) {
+        printf("info string cannot open %s\n", path);
+        return;
+    }
+
+    stop_search_thread(params.engine_search_thread);
+
+    thread_pool_t *pool = new_thread_pool(thread_count);
+    thread_count = get_thread_pool_size(pool);
+
+    datagen.workers = malloc(sizeof(datagen_worker_t) * (size_t)thread_count);
+    for (int i = 0; i < thread_count; i++) {
+        datagen_worker_t *worker = &datagen.workers[i];
+        worker->player.table = new_transposition_table(hash_size_mb);
+        worker->player.search = new_search(worker->player.table);
+        worker->player.limits = limits;
+        init_search_params(&worker->player.params);
+        worker->chunk = new_datagen_chunk();
+        set_search_reporting(worker->player.search, false);
+    }
+
+    pthread_mutex_init(&datagen.writer.lock, NULL);
+    pthread_cond_init(&datagen.writer.has_chunks, NULL);
+    pthread_create(&datagen.writer.thread, NULL, run_datagen_writer, &datagen.writer);
+    atomic_init(&datagen.games_played, 0);
+    atomic_init(&datagen.positions_written, 0);
+    datagen.start_time = get_time_ms();
+
+    for (int i = 0; i < game_count; i++) {
+        datagen_job_t *job = malloc(sizeof(datagen_job_t));
+        job->datagen = &datagen;
+        job->index = i;
+        submit_thread_pool_task(pool, run_datagen_job, job);
+    }
+
+    free_thread_pool(pool);
+
+    // The partly filled chunks are written last
+    for (int i = 0; i < thread_count; i++) {
+        submit_datagen_chunk(&datagen.writer, datagen.workers[i].chunk);
+        free_search(datagen.workers[i].player.search);
+        free_transposition_table(datagen.workers[i].player.table);
+    }
+
+    pthread_mutex_lock(&datagen.writer.lock);
+    datagen.writer.is_closing = true;
+    pthread_cond_signal(&datagen.writer.has_chunks);
+    pthread_mutex_unlock(&datagen.writer.lock);
+    pthread_join(datagen.writer.thread, NULL);
+
+    const bool has_failed = fclose(datagen.writer.file) != 0 || datagen.writer.has_failed;
+    const int64_t elapsed = get_time_ms() - datagen.start_time;
+    const long positions = atomic_load(&datagen.positions_written);
+
+    printf("info string %d games, %ld positions written to %s in %.1f s (%.0f positions/s)%s\n",
+           atomic_load(&datagen.games_played), positions, path, elapsed / 1000.0,
+           elapsed > 0 ? positions * 1000.0 / elapsed : 0.0, has_failed ? ", write failed" : "");
+
+    pthread_mutex_destroy(&datagen.writer.lock);
+    pthread_cond_destroy(&datagen.writer.has_chunks);
+    free(datagen.workers);
+}
@@ -0,0 +1,213 @@
+/* iMate -- Copyright (C) 2024 Martin Newbound */
+
+#include "../Commands.h"
+#include "../../Moves/SanNotation.h"
+#include "../../Search/Search.h"
+#include "../../Search/TranspositionTable.h"
+#include "../../Search/SearchStats.h"
+#include "../../Utils/Clock.h"
+#include <stdio.h>
+#include <string.h>
+
+// Longest EPD record read, longer lines are reported and skipped
+#define EPD_LINE_LENGTH 4096
+
+// Most moves a "bm" or "am" operation may list
+#define MAX_EPD_MOVES 16
+
+#define EPD_ID_LENGTH 64
+
+// Search time per position when the command sets no limit, in milliseconds
+#define DEFAULT_EPD_MOVE_TIME 1000
+
+/**
+ * @brief The operations of an EPD record the runner understands.
+ */
+typedef struct {
+    char id[EPD_ID_LENGTH];
+    uint16_t best_moves[MAX_EPD_MOVES];
+    int best_move_count;
+    uint16_t avoid_moves[MAX_EPD_MOVES];
+    int avoid_move_count;
+} epd_record_t;
+
+/**
+ * @brief Reads the moves of a "bm" or "am" operation.
+ *
+ * @param state The position of the record.
+ * @param operands The operands of the operation, the text is modified.
+ * @param keys Receives the keys of the moves.
+ * @param line_number The line of the record, for the error message.
+ * @return The number of moves read, or -1 if a move is not legal in the position or there are too many moves.
+ */
+static int parse_epd_moves(const state_t *state, char *operands, uint16_t *keys, int line_number) {
+    // One token more than fits is read so that a longer list is reported rather than cut short
+    char *tokens[MAX_EPD_MOVES + 1];
+    const int token_count = tokenize_command_line(operands, tokens, MAX_EPD_MOVES + 1);
+    if (token_count > MAX_EPD_MOVES) {
+        printf("info string more than %d moves on line %d\n", MAX_EPD_MOVES, line_number);
+        return -1;
+    }
+
+    for (int i = 0; i < token_count; i++) {
+        keys[i] = san_to_move_key(state, tokens[i]);
+        if (keys[i] == NULL_MOVE_KEY) {
+            printf("info string invalid move %s on line %d\n", tokens[i], line_number);
+            return -1;
+        }
+    }
+
+    return token_count;
+}
+
+/**
+ * @brief Reads the operations which follow the position of an EPD record, e.g. `bm Qg6; id "WAC.001";`.
+ *
+ * @param state The position of the record.
+ * @param operations The text after the position, it is modified.
+ * @param line_number The line of the record, for the error messages.
+ * @param[out] record Receives the operations.
+ * @return false if a "bm" or "am" list cannot be read, the record must then be skipped.
+ */
+static bool parse_epd_operations(const state_t *state, char *operations, int line_number, epd_record_t *record) {
+    memset(record, 0, sizeof(*record));
+
+    while (*operations) {
+        char *end = strchr(operations, ';');
+        if (end != NULL) *end = '\0';
+
+        while (*operations == ' ' || *operations == '\t') operations++;
+        char *operands = operations;
+        while (*operands && *operands != ' ' && *operands != '\t') operands++;
+        if (*operands) *operands++ = '\0';
+
+        if (strcmp(operations, "bm") == 0) {
+            record->best_move_count = parse_epd_moves(state, operands, record->best_moves, line_number);
+            if (record->best_move_count < 0) return false;
+        } else if (strcmp(operations, "am") == 0) {
+            record->avoid_move_count = parse_epd_moves(state, operands, record->avoid_moves, line_number);
+            if (record->avoid_move_count < 0) return false;
+        } else if (strcmp(operations, "id") == 0) {
+            while (*operands == ' ' || *operands == '"') operands++;
+            size_t length = strcspn(operands, "\"");
+            if (length >= EPD_ID_LENGTH) length = EPD_ID_LENGTH - 1;
+            memcpy(record->id, operands, length);
+            record->id[length] = '\0';
+        }
+
+        if (end == NULL) break;
+        operations = end + 1;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Checks whether a move is one of a list of moves.
+ *
+ * @param keys The list of moves.
+ * @param count The number of moves in the list.
+ * @param key The move to look for.
+ * @return true if the move is in the list.
+ */
+static bool contains_move(const uint16_t *keys, int count, uint16_t key) {
+    for (int i = 0; i < count; i++) {
+        if (keys[i] == key) return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Executes the 'epd' command.
+ *
+ * This function runs a test suite: every record of an EPD file is searched under the given limits and the
+ * move found is compared with the record's "bm" (best move) or "am" (avoid move) operation. A line is printed
+ * per position, followed by the solve rate, the total node count and the speed of the search.
+ * The command has the form "epd <file> [depth|nodes|movetime <x>]".
+ * 
+ * @param params The command parameters, including the engine's search thread.
+ */
+void epd_command(const CommandParams params) {
+    FILE *file = fopen(params.tokens[1], "r");
+    if (file == NULL) {
+        printf("info string cannot open %s\n", params.tokens[1]);
+        return;
+    }
+
+    search_limits_t limits;
+    init_search_limits(&limits);
+    parse_go_arguments(params.tokens + 2, params.token_count - 2, &limits);
+    if (!limits.depth && !limits.nodes && !limits.move_time) limits.move_time = DEFAULT_EPD_MOVE_TIME;
+    limits.infinite = false;
+
+    stop_search_thread(params.engine_search_thread);
+    search_t *search = get_search_thread_search(params.engine_search_thread);
+    transposition_table_t *table = get_search_thread_table(params.engine_search_thread);
+    set_search_reporting(search, false);
+
+    static char line[EPD_LINE_LENGTH];
+    state_t *state = new_state();
+    epd_record_t record;
+
+    int position_count = 0, solved_count = 0, line_number = 0;
+    uint64_t total_nodes = 0;
+    reset_search_stats_report();
+    const int64_t start_time = get_time_ms();
+
+    while (fgets(line, sizeof(line), file) != NULL) {
+        line_number++;
+
+        const size_t length = strlen(line);
+        if (length == sizeof(line) - 1 && line[length - 1] != '\n') {
+            int c;
+            while ((c = fgetc(file)) != EOF && c != '\n');
+            printf("info string line %d longer than %d characters skipped\n", line_number, EPD_LINE_LENGTH - 1);
+            continue;
+        }
+
+        if (line[0] == '#' || line[strspn(line, " \t\r\n")] == '\0') continue;
+
+        char *operations = (char *)load_fen_position(state, line);
+        if (operations == NULL) {
+            printf("info string invalid position on line %d\n", line_number);
+            continue;
+        }
+
+        // A record with a move which cannot be read is not run, as it would test something else than intended
+        if (!parse_epd_operations(state, operations, line_number, &record)) continue;
+        if (record.best_move_count == 0 && record.avoid_move_count == 0) continue;
+
+        // Every position is searched from scratch so results do not depend on the order of the suite
+        clear_transposition_table(table);
+        clear_search_heuristics(search);
+        reset_search_stop(search);
+
+        const search_result_t result = do_move_search(search, state, &limits);
+
+        const bool solved = (record.best_move_count == 0 || contains_move(record.best_moves, record.best_move_count, result.best_move))
+                         && !contains_move(record.avoid_moves, record.avoid_move_count, result.best_move);
+
+        position_count++;
+        solved_count += solved;
+        total_nodes += result.nodes;
+
+        char expected[MOVE_STRING_LENGTH] = "", found[MOVE_STRING_LENGTH] = "0000";
+        const uint16_t expected_key = record.best_move_count ? record.best_moves[0] : record.avoid_moves[0];
+        move_key_to_string(expected_key, expected);
+        if (result.best_move != NULL_MOVE_KEY) move_key_to_string(result.best_move, found);
+
+        printf("%5d %-16s %s %s %-5s found %-5s depth %2d nodes %llu\n",
+               position_count, record.id[0] ? record.id : "-", solved ? "solved" : "failed",
+               record.best_move_count ? "bm" : "am", expected, found, result.depth, (unsigned long long)result.nodes);
+    }
+
+    const int64_t elapsed = get_time_ms() - start_time;
+    printf("epd solved %d/%d (%.1f%%) nodes %llu time %lld ms nps %llu\n",
+           solved_count, position_count, position_count ? 100.0 * solved_count / position_count : 0.0,
+           (unsigned long long)total_nodes, (long long)elapsed,
+           (unsigned long long)(elapsed > 0 ? total_nodes * 1000 / elapsed : total_nodes));
+
+    set_search_reporting(search, true);
+    free_state(state);
+    fclose(file);
+}
@@ -1,16 +1,52 @@
 /* iMate -- Copyright (C) 2024 Martin Newbound */
 
 #include "../Commands.h"
+#include "../../Search/Search.h"
+#include <stdlib.h>
+#include <string.h>
+
+void parse_go_arguments(char **tokens, int token_count, search_limits_t *limits) {
+    for (int i = 0; i < token_count; i++) {
+        const char *token = tokens[i];
+
+        if (strcmp(token, "infinite") == 0 || strcmp(token, "ponder") == 0) {
+            limits->infinite = true;
+            continue;
+        }
+
+        if (i + 1 >= token_count) break;
+        const char *value = tokens[i + 1];
+
+        if (strcmp(token, "wtime") == 0) limits->time[WHITE] = atoll(value);
+        else if (strcmp(token, "btime") == 0) limits->time[BLACK] = atoll(value);
+        else if (strcmp(token, "winc") == 0) limits->increment[WHITE] = atoll(value);
+        else if (strcmp(token, "binc") == 0) limits->increment[BLACK] = atoll(value);
+        else if (strcmp(token, "movestogo") == 0) limits->moves_to_go = atoi(value);
+        else if (strcmp(token, "depth") == 0) limits->depth = atoi(value);
+        else if (strcmp(token, "nodes") == 0) limits->nodes = strtoull(value, NULL, 10);
+        else if (strcmp(token, "movetime") == 0) limits->move_time = atoll(value);
+        else continue;  // the token takes no value
+
+        i++;
+    }
+}
 
 /**
  * @brief Executes the 'go' command.
  *
  * This function is responsible for starting the engine's search for the best move.
  * The engine's search parameters are set based on the command parameters provided.
+ * The search runs in the background and prints "bestmove" when it ends.
  * 
  * @param params The command parameters, including the current game state and any search parameters.
- *
- * @todo Implement the function to start the engine's search for the best move.
  */
 void go_command(const CommandParams params) {
-}
\ No newline at end of file
+    search_limits_t limits;
+    init_search_limits(&limits);
+
+    parse_go_arguments(params.tokens + 1, params.token_count - 1, &limits);
+
+    start_search_thread(params.engine_search_thread, params.engine_game_state,
+                        get_game_history_keys(params.engine_game_history),
+                        get_game_history_length(params.engine_game_history) + 1, &limits);
+}
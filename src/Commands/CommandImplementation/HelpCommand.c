@@ -16,12 +16,25 @@
  */
 const char* CMD_DESCRIPTIONS[][2] = {
     {"help",                                            "Shows this help message"},
-    {"position startpos|<fen> [<move> <move>...]",      "Sets the state of the engine's internal game board"},
-    {"go",                                              "Start searching for the best move"},
+    {"uci",                                             "Identify the engine and list its options"},
+    {"isready",                                         "Ask the engine to confirm it is ready"},
+    {"ucinewgame",                                      "Forget everything learnt in the previous game"},
+    {"setoption name <name> [value <value>]",           "Change the value of an engine option"},
+    {"position startpos|fen <fen> [moves <move>...]",   "Sets the state of the engine's internal game board"},
+    {"go [depth|nodes|movetime|wtime|btime|winc|binc|movestogo <x>] [infinite]", "Start searching for the best move"},
+    {"stop",                                            "Stop searching and print the best move"},
     {"print board",                                     "Print the current board state"},
     {"print moves <from_square>",                       "Print all possible moves from a square"},
     {"move <from_square> <to_square>",                  "Make a move on the board"},
     {"status",                                          "Prints the current status of the game"},
+    {"epd <file> [depth|nodes|movetime <x>]",           "Run a test suite and report the solve rate"},
+    {"batch <file>|- [depth|nodes|movetime <x>] [threads <n>] [hash <mb>] [sharedhash]", "Analyze many positions in parallel, printing JSON lines"},
+    {"datagen <file> [games|threads|hash|random|seed <n>] [limits]", "Append scored self-play positions to a packed position file"},
+    {"match <file>|startpos [games|threads|hash <n>] [player] [second <player>] [sprt <elo0> <elo1>]", "Play games between two players (limits and param <name> <value>) and report Elo and an SPRT verdict"},
+    {"bench [depth]",                                   "Search a fixed set of positions and print the node count and speed"},
+    {"stats",                                           "Print the search statistics of the last search (SEARCH_STATS builds)"},
+    {"profile [reset]",                                 "Print or clear the time spent in each subsystem (ENGINE_PROFILE builds)"},
+    {"trace [dump <file>]",                             "Print the size of or dump the search trace rings (SEARCH_TRACE builds)"},
     {"quit",                                            "Quit the engine"}
 };
 
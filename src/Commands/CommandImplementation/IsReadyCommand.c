@@ -0,0 +1,17 @@
+/* iMate -- Copyright (C) 2024 Martin Newbound */
+
+#include "../Commands.h"
+#include <stdio.h>
+
+/**
+ * @brief Executes the 'isready' command.
+ *
+ * This function answers the GUI's synchronisation request. Commands are processed in order,
+ * so by the time this runs all previous commands have been handled. A running search keeps running.
+ * 
+ * @param params The command parameters. This parameter is not used in this function.
+ */
+void isready_command(const CommandParams params) {
+    printf("readyok\n");
+    fflush(stdout);
+}
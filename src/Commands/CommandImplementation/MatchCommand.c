@@ -0,0 +1,320 @@
+/* iMate -- Copyright (C) 2024 Martin Newbound */
+
+#include "../Commands.h"
+#include "../../Match/SelfPlay.h"
+#include "../../Match/MatchStatistics.h"
+#include "../../Search/Search.h"
+#include "../../Search/TranspositionTable.h"
+#include "../../Threads/ThreadPool.h"
+#include "../../Utils/Clock.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DEFAULT_MATCH_GAMES 100
+
+// Nodes per move when the command sets no limit, enough for sensible games at a high throughput
+#define DEFAULT_MATCH_NODES 10000
+
+// Transposition table of each player, in megabytes
+#define DEFAULT_MATCH_HASH_MB 4
+
+// A progress line is printed every this many games
+#define MATCH_REPORT_INTERVAL 50
+
+#define OPENING_LINE_LENGTH 4096
+
+/**
+ * @brief The state of a match, shared by the games running on the workers.
+ */
+typedef struct {
+    state_t **openings;
+    int opening_count;
+    int game_count;
+
+    // The parameters and limits of the first and second player, and the players of each worker (first, second)
+    search_params_t params[2];
+    search_limits_t limits[2];
+    selfplay_player_t (*players)[2];
+
+    bool use_sprt;
+    sprt_t sprt;
+    atomic_bool is_decided;     // the SPRT reached a verdict, the remaining games are skipped
+
+    pthread_mutex_t lock;
+    match_score_t score;
+    int end_counts[GAME_END_MAX_LENGTH + 1];
+    int games_played;
+    int64_t start_time;
+} match_t;
+
+/**
+ * @brief A game of the match.
+ */
+typedef struct {
+    match_t *match;
+    int index;
+} match_job_t;
+
+/**
+ * @brief Prints the results so far: W/D/L, Elo with its error bar, LOS and the SPRT state.
+ *
+ * @param match The match, its lock held by the caller.
+ */
+static void print_match_report(const match_t *match) {
+    const match_score_t *score = &match->score;
+    double error;
+    const double elo = compute_match_elo(score, &error);
+    const int64_t elapsed = get_time_ms() - match->start_time;
+
+    printf("games %d  +%d =%d -%d  elo %.1f +/- %.1f  los %.1f%%  %.1f games/s",
+           match->games_played, score->wins, score->draws, score->losses, elo, error,
+           100.0 * compute_match_los(score), elapsed > 0 ? match->games_played * 1000.0 / elapsed : 0.0);
+
+    if (match->use_sprt) {
+        double lower, upper;
+        get_sprt_bounds(&match->sprt, &lower, &upper);
+        printf("  llr %.2f (%.2f, %.2f)", compute_sprt_llr(score, &match->sprt), lower, upper);
+    }
+
+    printf("\n");
+    fflush(stdout);
+}
+
+/**
+ * @brief Plays one game of the match and records its result.
+ *
+ * Games come in pairs playing the same opening, the first player taking white in the first game of the pair.
+ *
+ * @param argument The match job, freed once the game is recorded.
+ * @param worker_index The index of the worker playing the game.
+ */
+static void run_match_job(void *argument, int worker_index) {
+    match_job_t *job = argument;
+    match_t *match = job->match;
+    const int index = job->index;
+    free(job);
+
+    if (atomic_load(&match->is_decided)) return;
+
+    const state_t *opening = match->openings[(index / 2) % match->opening_count];
+    selfplay_player_t *players = match->players[worker_index];
+    const bool first_is_white = index % 2 == 0;
+
+    game_end_t end;
+    const game_result_t result = play_selfplay_game(opening, first_is_white ? &players[0] : &players[1],
+                                                    first_is_white ? &players[1] : &players[0], NULL, NULL, &end);
+
+    pthread_mutex_lock(&match->lock);
+
+    if (result == GAME_DRAW) match->score.draws++;
+    else if ((result == GAME_WHITE_WINS) == first_is_white) match->score.wins++;
+    else match->score.losses++;
+
+    match->end_counts[end]++;
+    match->games_played++;
+
+    if (match->games_played % MATCH_REPORT_INTERVAL == 0) print_match_report(match);
+    if (match->use_sprt && get_sprt_verdict(&match->score, &match->sprt) != SPRT_CONTINUE) atomic_store(&match->is_decided, true);
+
+    pthread_mutex_unlock(&match->lock);
+}
+
+/**
+ * @brief Reads the "param <name> <value>" arguments of a player.
+ *
+ * @param tokens The arguments of the player.
+ * @param token_count The number of arguments.
+ * @param params The parameters to change.
+ * @return false if a parameter does not exist or its value is out of range.
+ */
+static bool parse_player_params(char **tokens, int token_count, search_params_t *params) {
+    for (int i = 0; i + 2 < token_count; i++) {
+        if (strcmp(tokens[i], "param") != 0) continue;
+
+        if (!set_search_param(params, tokens[i + 1], atoi(tokens[i + 2]))) {
+            printf("info string invalid parameter %s %s, the parameters are:\n", tokens[i + 1], tokens[i + 2]);
+            print_search_params();
+            return false;
+        }
+        i += 2;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Reads the opening positions of a file, one FEN or EPD record per line.
+ *
+ * @param path The file to read, or "startpos" for the starting position alone.
+ * @param[out] count Receives the number of openings.
+ * @return The openings, NULL if the file cannot be read or holds no valid position.
+ */
+static state_t **read_openings(const char *path, int *count) {
+    *count = 0;
+    state_t **openings = NULL;
+
+    if (strcmp(path, "startpos") == 0) {
+        openings = malloc(sizeof(state_t *));
+        openings[0] = new_state();
+        load_fen_string(openings[0], START_FEN);
+        *count = 1;
+        return openings;
+    }
+
+    FILE *file = fopen(path, "r");
+    if (file == NULL) return NULL;
+
+    static char line[OPENING_LINE_LENGTH];
+    int capacity = 0;
+    state_t *state = new_state();
+
+    while (fgets(line, sizeof(line), file) != NULL) {
+        if (line[0] == '#' || line[strspn(line, " \t\r\n")] == '\0') continue;
+        if (load_fen_position(state, line) == NULL) continue;
+
+        if (*count == capacity) {
+            capacity = capacity ? capacity * 2 : 64;
+            openings = realloc(openings, sizeof(state_t *) * (size_t)capacity);
+        }
+
+        openings[(*count)++] = state;
+        state = new_state();
+    }
+
+    free_state(state);
+    fclose(file);
+    return openings;
+}
+
+/**
+ * @brief Executes the 'match' command.
+ *
+ * This function plays games between two players inside the engine, on a pool of worker threads, and reports
+ * the results from the point of view of the first player: wins, draws and losses, the Elo difference with its
+ * 95% error bar, the likelihood of superiority and, when requested, the state of an SPRT which ends the match
+ * as soon as it reaches a verdict. Every opening is played twice with the colors reversed.
+ *
+ * The command has the form "match <file>|startpos [games <n>] [threads <n>] [hash <mb>] [player]
+ * [second <player>] [sprt <elo0> <elo1> [<alpha> <beta>]]", where a player is given by the limits of "go"
+ * (depth, nodes, movetime, or wtime and winc for a game clock) and any number of "param <name> <value>"
+ * search parameters (see set_search_param). The second player starts from the first player's parameters and,
+ * unless others follow "second", its limits. A change to the search or evaluation made tunable through a
+ * parameter is thus tested by giving it to the second player only.
+ *
+ * @param params The command parameters, including the engine's search thread.
+ */
+void match_command(const CommandParams params) {
+    match_t match = {0};
+    match.openings = read_openings(params.tokens[1], &match.opening_count);
+    if (match.opening_count == 0) {
+        printf("info string no opening positions in %s\n", params.tokens[1]);
+        free(match.openings);
+        return;
+    }
+
+    int second_index = params.token_count;
+    int thread_count = get_processor_count();
+    size_t hash_size_mb = DEFAULT_MATCH_HASH_MB;
+    match.game_count = DEFAULT_MATCH_GAMES;
+    match.sprt = (sprt_t){.elo0 = 0.0, .elo1 = 5.0, .alpha = 0.05, .beta = 0.05};
+
+    for (int i = 2; i < params.token_count; i++) {
+        const char *token = params.tokens[i];
+        const bool has_value = i + 1 < params.token_count;
+
+        if (strcmp(token, "second") == 0) second_index = i;
+        else if (has_value && strcmp(token, "games") == 0) match.game_count = atoi(params.tokens[++i]);
+        else if (has_value && strcmp(token, "threads") == 0) thread_count = atoi(params.tokens[++i]);
+        else if (has_value && strcmp(token, "hash") == 0) hash_size_mb = (size_t)atoll(params.tokens[++i]);
+        else if (i + 2 < params.token_count && strcmp(token, "sprt") == 0) {
+            match.use_sprt = true;
+            match.sprt.elo0 = atof(params.tokens[++i]);
+            match.sprt.elo1 = atof(params.tokens[++i]);
+            if (i + 2 < params.token_count && atof(params.tokens[i + 1]) > 0.0) {
+                match.sprt.alpha = atof(params.tokens[++i]);
+                match.sprt.beta = atof(params.tokens[++i]);
+            }
+        }
+    }
+
+    for (int player = 0; player < 2; player++) {
+        // The arguments of the first player come before "second", those of the second player after it
+        char **tokens = player == 0 ? params.tokens + 2 : params.tokens + second_index + 1;
+        const int token_count = player == 0 ? second_index - 2 : params.token_count - second_index - 1;
+
+        search_limits_t *limits = &match.limits[player];
+        init_search_limits(limits);
+        if (token_count > 0) parse_go_arguments(tokens, token_count, limits);
+
+        if (player == 0) init_search_params(&match.params[0]);
+        else match.params[1] = match.params[0];
+
+        if (!parse_player_params(tokens, token_count, &match.params[player])) {
+            for (int i = 0; i < match.opening_count; i++) free_state(match.openings[i]);
+            free(match.openings);
+            return;
+        }
+
+        const bool has_limit = limits->depth || limits->nodes || limits->move_time || limits->time[WHITE];
+        if (player == 1 && !has_limit) *limits = match.limits[0];
+        else if (!has_limit) limits->nodes = DEFAULT_MATCH_NODES;
+        limits->infinite = false;
+    }
+
+    stop_search_thread(params.engine_search_thread);
+
+    thread_pool_t *pool = new_thread_pool(thread_count);
+    thread_count = get_thread_pool_size(pool);
+
+    match.players = malloc(sizeof(*match.players) * (size_t)thread_count);
+    for (int i = 0; i < thread_count; i++) {
+        for (int player = 0; player < 2; player++) {
+            selfplay_player_t *self_player = &match.players[i][player];
+            self_player->table = new_transposition_table(hash_size_mb);
+            self_player->search = new_search(self_player->table);
+            self_player->params = match.params[player];
+            self_player->limits = match.limits[player];
+            set_search_reporting(self_player->search, false);
+        }
+    }
+
+    pthread_mutex_init(&match.lock, NULL);
+    atomic_init(&match.is_decided, false);
+    match.start_time = get_time_ms();
+
+    for (int i = 0; i < match.game_count; i++) {
+        match_job_t *job = malloc(sizeof(match_job_t));
+        job->match = &match;
+        job->index = i;
+        submit_thread_pool_task(pool, run_match_job, job);
+    }
+
+    free_thread_pool(pool);
+
+    print_match_report(&match);
+    for (game_end_t end = GAME_END_CHECKMATE; end <= GAME_END_MAX_LENGTH; end++) {
+        if (match.end_counts[end]) printf("  %-22s %d\n", get_game_end_name(end), match.end_counts[end]);
+    }
+
+    if (match.use_sprt) {
+        const sprt_verdict_t verdict = get_sprt_verdict(&match.score, &match.sprt);
+        printf("sprt elo0 %.1f elo1 %.1f alpha %.3f beta %.3f: %s\n", match.sprt.elo0, match.sprt.elo1,
+               match.sprt.alpha, match.sprt.beta,
+               verdict == SPRT_ACCEPT_H1 ? "H1 accepted" : verdict == SPRT_ACCEPT_H0 ? "H0 accepted" : "inconclusive");
+    }
+
+    for (int i = 0; i < thread_count; i++) {
+        for (int player = 0; player < 2; player++) {
+            free_search(match.players[i][player].search);
+            free_transposition_table(match.players[i][player].table);
+        }
+    }
+    for (int i = 0; i < match.opening_count; i++) free_state(match.openings[i]);
+
+    free(match.players);
+    free(match.openings);
+    pthread_mutex_destroy(&match.lock);
+}
@@ -1,16 +1,28 @@
 /* iMate -- Copyright (C) 2024 Martin Newbound */
 
 #include "../Commands.h"
+#include "../../Moves/MoveGeneration.h"
+#include <stdio.h>
 
 /**
  * @brief Executes the 'move' command.
  *
- * This function is responsible for making a move on the game board. The move is specified by the command parameters.
+ * This function is responsible for making a move on the game board. The move is specified either as
+ * two squares ("move e2 e4", "move e7 e8q") or as a single move ("move e2e4").
  * 
- * @param params The command parameters, including the current game state and the move to make.
- *
- * @todo Implement the function to make a move on the game board.
+ * @param params The command parameters, including the current game state and the tokens of the command.
  */
 void move_command(const CommandParams params) {
+    char move_string[MOVE_STRING_LENGTH + 1];
+    snprintf(move_string, sizeof(move_string), "%s%s", params.tokens[1], params.token_count > 2 ? params.tokens[2] : "");
+
+    move_t *move = find_legal_move(params.engine_game_state, move_string_to_key(move_string));
+    if (move == NULL) {
+        printf("Illegal move %s\n", move_string);
+        return;
+    }
 
-}
\ No newline at end of file
+    play_move(params.engine_game_state, move);
+    push_game_history(params.engine_game_history, get_move_key(move), params.engine_game_state);
+    free_move(move);
+}
@@ -1,20 +1,106 @@
 /* iMate -- Copyright (C) 2024 Martin Newbound */
 
 #include "../Commands.h"
+#include "../../Moves/MoveGeneration.h"
+#include <stdio.h>
+#include <string.h>
 
-#define START_FEN "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1"
+// A FEN string has at most six fields, the longest legal one is under 100 characters
+#define FEN_FIELD_COUNT 6
+#define FEN_BUFFER_LENGTH 128
+
+/**
+ * @brief Plays a list of moves in long algebraic notation on a state and records them in the game history.
+ *
+ * Playing stops at the first move which is not legal in the position reached so far.
+ *
+ * @param state The state to play the moves on.
+ * @param history The history of the game the state belongs to.
+ * @param moves The moves, one per token, e.g. {"e2e4", "e7e5", "g1f3"}.
+ * @param move_count The number of moves.
+ */
+void play_move_list(state_t *state, game_history_t *history, char **moves, int move_count) {
+    for (int i = 0; i < move_count; i++) {
+        move_t *move = find_legal_move(state, move_string_to_key(moves[i]));
+        if (move == NULL) {
+            printf("info string illegal move %s\n", moves[i]);
+            fflush(stdout);
+            return;
+        }
+
+        play_move(state, move);
+        push_game_history(history, get_move_key(move), state);
+        free_move(move);
+    }
+}
+
+/**
+ * @brief Checks whether a move list starts with the moves already recorded in a game history.
+ *
+ * @param history The history of the game.
+ * @param moves The moves of the new move list.
+ * @param move_count The number of moves in the new move list.
+ * @return true if every recorded move is also the move at the same index of the list.
+ */
+bool move_list_extends_history(const game_history_t *history, char **moves, int move_count) {
+    const int played = get_game_history_length(history);
+    if (played > move_count) return false;
+
+    for (int i = 0; i < played; i++) {
+        if (get_game_history_move(history, i) != move_string_to_key(moves[i])) return false;
+    }
+
+    return true;
+}
 
 /**
  * @brief Executes the 'position' command.
  *
  * This function is responsible for setting the state of the engine's internal game board.
- * The board state is set based on the command parameters provided.
- * 
- * @param params The command parameters, including the current game state and the FEN string representing the new board state.
+ * The command has the form "position startpos|fen <fen> [moves <move>...]". The board is set up
+ * from the starting position or the FEN string, then the optional list of moves is played.
  *
- * @todo Implement the function to parse the FEN string and set the game state.
+ * A GUI sends the whole game with every move. When the position is the one the engine already holds
+ * plus some new moves, only the new moves are played and the game history is kept.
+ * 
+ * @param params The command parameters, including the current game state and the tokens of the command.
  */
 void position_command(const CommandParams params) {
-    // The following line is commented out because the 'fen' variable is not defined.
-    // load_fen_string(params.engine_game_state, fen);
-}
\ No newline at end of file
+    char fen[FEN_BUFFER_LENGTH] = START_FEN;
+    int index = 2;
+
+    if (strcmp(params.tokens[1], "fen") == 0) {
+        // Rejoin the fields of the FEN string which the tokenizer split apart
+        size_t length = 0;
+        fen[0] = '\0';
+
+        for (; index < params.token_count && index < 2 + FEN_FIELD_COUNT && strcmp(params.tokens[index], "moves") != 0; index++) {
+            length += snprintf(fen + length, sizeof(fen) - length, "%s ", params.tokens[index]);
+            if (length >= sizeof(fen)) return;
+        }
+    } else if (strcmp(params.tokens[1], "startpos") != 0) {
+        return;
+    }
+
+    char **moves = params.tokens + params.token_count;
+    int move_count = 0;
+    if (index < params.token_count && strcmp(params.tokens[index], "moves") == 0) {
+        moves = params.tokens + index + 1;
+        move_count = params.token_count - index - 1;
+    }
+
+    game_history_t *history = params.engine_game_history;
+
+    if (!is_game_history_root(history, fen) || !move_list_extends_history(history, moves, move_count)) {
+        if (!load_fen_string(params.engine_game_state, fen)) {
+            printf("info string invalid fen %s\n", fen);
+            fflush(stdout);
+            return;
+        }
+
+        reset_game_history(history, fen, params.engine_game_state);
+    }
+
+    const int played = get_game_history_length(history);
+    play_move_list(params.engine_game_state, history, moves + played, move_count - played);
+}
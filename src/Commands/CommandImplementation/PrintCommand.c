@@ -1,6 +1,7 @@
 /* iMate -- Copyright (C) 2024 Martin Newbound */
 
 #include "../Commands.h"
+#include "../../Moves/MoveGeneration.h"
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
@@ -14,8 +15,10 @@
  */
 void print_board(const CommandParams params) {
     for (size_t i = 0; i < 64; i++) {
-        piece_t piece = get_piece_on_square(params.engine_game_state, 1 << i);
-        color_t color = get_color_of_piece_on_square(params.engine_game_state, 1 << i);
+        // Squares are printed from a8 to h1, while square indices run from a1 to h8
+        const uint64_t square = 1ULL << (i ^ 56);
+        piece_t piece = get_piece_on_square(params.engine_game_state, square);
+        color_t color = get_color_of_piece_on_square(params.engine_game_state, square);
 
         if (i % 8 == 0) printf("+---+---+---+---+---+---+---+---+\n");
 
@@ -57,11 +60,27 @@ void print_board(const CommandParams params) {
  * 
  * @param params The command parameters, including the current game state.
  * @param square The square from which to print all possible moves.
- *
- * @todo Implement the function to print all possible moves from a square.
  */
 void print_moves(const CommandParams params, const char *square) {
+    if (square[0] < 'a' || square[0] > 'h' || square[1] < '1' || square[1] > '8' || square[2] != '\0') return;
+
+    const uint64_t from_square = 1ULL << ((square[1] - '1') * 8 + (square[0] - 'a'));
+    move_collection_t *moves = get_legal_moves_of_state(params.engine_game_state);
+    char move_string[MOVE_STRING_LENGTH];
+
+    move_t *move = pop_collection_head(moves);
+    while (move != NULL) {
+        if (get_move_from_square(move) == from_square) {
+            move_to_string(move, move_string);
+            printf("%s ", move_string);
+        }
+
+        free_move(move);
+        move = pop_collection_head(moves);
+    }
 
+    free_move_collection(moves);
+    printf("\n");
 }
 
 /**
@@ -73,9 +92,9 @@ void print_moves(const CommandParams params, const char *square) {
  * @param params The command parameters, including the current game state and any additional parameters.
  */
 void print_command(const CommandParams params) {
-    if (params.matches[2] == NULL) {                // The command is "print board"
+    if (strcmp(params.tokens[1], "board") == 0) {                               // The command is "print board"
         print_board(params);
-    } else if (params.matches[3] != NULL) {         // The command is "print moves x"
-        print_moves(params, params.matches[3]);
+    } else if (strcmp(params.tokens[1], "moves") == 0 && params.token_count > 2) { // The command is "print moves x"
+        print_moves(params, params.tokens[2]);
     }
 }
\ No newline at end of file
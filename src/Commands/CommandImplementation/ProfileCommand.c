@@ -0,0 +1,37 @@
+/* iMate -- Copyright (C) 2024 Martin Newbound */
+
+#include "../Commands.h"
+#include "../../Utils/Profiler.h"
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * @brief Executes the 'profile' command.
+ *
+ * This function prints, for each profiled subsystem (move generation, move making, attack detection, evaluation,
+ * transposition table and move ordering), the number of calls and the total and average time spent in it since
+ * the counters were last cleared. A running search is waited for, unless it is infinite. "profile reset" clears
+ * the counters. The timers are only available in builds with ENGINE_PROFILE defined.
+ * 
+ * @param params The command parameters, including the tokens of the command.
+ */
+void profile_command(const CommandParams params) {
+#ifdef ENGINE_PROFILE
+    if (params.token_count > 1 && strcmp(params.tokens[1], "reset") == 0) {
+        reset_profile();
+        return;
+    }
+
+    // Threads only publish consistent totals once their search has ended, and an infinite search never ends on its own
+    if (is_search_thread_infinite(params.engine_search_thread)) {
+        printf("info string the search is infinite, send \"stop\" before \"profile\"\n");
+        return;
+    }
+
+    wait_search_thread(params.engine_search_thread);
+    print_profile_report();
+#else
+    (void)params;
+    printf("info string profiling timers are not compiled in, configure with -DIMATE_PROFILE=ON\n");
+#endif
+}
@@ -6,11 +6,13 @@
 /**
  * @brief Executes the 'quit' command.
  *
- * This function is responsible for stopping the engine. It sets the 'engine_is_running' flag to false.
+ * This function is responsible for stopping the engine. Any running search is stopped and
+ * the 'engine_is_running' flag is set to false.
  * 
  * @param params The command parameters, including the current game state and the 'engine_is_running' flag.
  */
 void quit_command(const CommandParams params) {
+    stop_search_thread(params.engine_search_thread);
     printf("Quitting...\n");
     *params.engine_is_running = false;
-}
\ No newline at end of file
+}
@@ -0,0 +1,66 @@
+/* iMate -- Copyright (C) 2024 Martin Newbound */
+
+#include "../Commands.h"
+#include "../Options.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define OPTION_TEXT_LENGTH 256
+
+/**
+ * @brief Joins a run of tokens with single spaces into a buffer.
+ *
+ * @param tokens The tokens to join.
+ * @param count The number of tokens.
+ * @param buffer The buffer to write to.
+ * @param buffer_size The size of the buffer, the result is truncated to fit.
+ */
+void join_tokens(char **tokens, int count, char *buffer, size_t buffer_size) {
+    size_t length = 0;
+    buffer[0] = '\0';
+
+    for (int i = 0; i < count && length < buffer_size; i++) {
+        length += snprintf(buffer + length, buffer_size - length, i == 0 ? "%s" : " %s", tokens[i]);
+    }
+}
+
+/**
+ * @brief Executes the 'setoption' command.
+ *
+ * This function changes the value of an engine option. The command has the form
+ * "setoption name <name> [value <value>]", where the name and value may contain spaces.
+ * 
+ * @param params The command parameters, including the tokens of the command.
+ */
+void setoption_command(const CommandParams params) {
+    if (strcmp(params.tokens[1], "name") != 0) return;
+
+    int value_index = 2;
+    while (value_index < params.token_count && strcmp(params.tokens[value_index], "value") != 0) value_index++;
+
+    char name[OPTION_TEXT_LENGTH], value[OPTION_TEXT_LENGTH];
+    join_tokens(params.tokens + 2, value_index - 2, name, sizeof(name));
+    join_tokens(params.tokens + value_index + 1, params.token_count - value_index - 1, value, sizeof(value));
+
+    const bool has_value = value_index < params.token_count;
+
+    const EngineOption *option = find_engine_option(name);
+    if (option == NULL) {
+        printf("info string unknown option %s\n", name);
+        fflush(stdout);
+        return;
+    }
+
+    if (option->type != OPTION_BUTTON && !has_value) return;
+
+    if (option->type == OPTION_SPIN) {
+        int number = atoi(value);
+        if (number < option->min) number = option->min;
+        if (number > option->max) number = option->max;
+
+        snprintf(value, sizeof(value), "%d", number);
+    }
+
+    option->func(params, option->type == OPTION_BUTTON ? NULL : value);
+}
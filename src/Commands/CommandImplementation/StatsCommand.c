@@ -0,0 +1,31 @@
+/* iMate -- Copyright (C) 2024 Martin Newbound */
+
+#include "../Commands.h"
+#include "../../Search/SearchStats.h"
+#include <stdio.h>
+
+/**
+ * @brief Executes the 'stats' command.
+ *
+ * This function prints the counters of the last search (or of every search of the last bench, epd or batch run):
+ * node counts, transposition table hit rate, cutoff rates, null move and late move reduction success rates and
+ * the effective branching factor of each depth. A running search is waited for, unless it is infinite. The counters
+ * are only available in builds with SEARCH_STATS defined.
+ * 
+ * @param params The command parameters, including the engine's search thread.
+ */
+void stats_command(const CommandParams params) {
+#ifdef SEARCH_STATS
+    // The counters of a running search are only published when it ends, and an infinite search never ends on its own
+    if (is_search_thread_infinite(params.engine_search_thread)) {
+        printf("info string the search is infinite, send \"stop\" before \"stats\"\n");
+        return;
+    }
+
+    wait_search_thread(params.engine_search_thread);
+    print_search_stats_report();
+#else
+    (void)params;
+    printf("info string search statistics are not compiled in, configure with -DIMATE_SEARCH_STATS=ON\n");
+#endif
+}
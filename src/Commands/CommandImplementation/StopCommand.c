@@ -0,0 +1,14 @@
+/* iMate -- Copyright (C) 2024 Martin Newbound */
+
+#include "../Commands.h"
+
+/**
+ * @brief Executes the 'stop' command.
+ *
+ * This function stops the running search, which then prints its best move.
+ * 
+ * @param params The command parameters, including the engine's search thread.
+ */
+void stop_command(const CommandParams params) {
+    stop_search_thread(params.engine_search_thread);
+}
@@ -0,0 +1,35 @@
+/* iMate -- Copyright (C) 2024 Martin Newbound */
+
+#include "../Commands.h"
+#include "../../Search/SearchTrace.h"
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * @brief Executes the 'trace' command.
+ *
+ * "trace" prints how many searches have a trace ring and how many events the rings hold. "trace dump <file>"
+ * writes the rings to a binary file, which the iMateTrace tool decodes. A dump can be taken while a search is
+ * running. The rings are only available in builds with SEARCH_TRACE defined.
+ * 
+ * @param params The command parameters, including the tokens of the command.
+ */
+void trace_command(const CommandParams params) {
+#ifdef SEARCH_TRACE
+    if (params.token_count > 2 && strcmp(params.tokens[1], "dump") == 0) {
+        if (dump_search_trace(params.tokens[2])) {
+            printf("info string search trace written to %s\n", params.tokens[2]);
+        } else {
+            printf("info string could not write %s\n", params.tokens[2]);
+        }
+        return;
+    }
+
+    uint64_t event_count;
+    int ring_count = get_search_trace_size(&event_count);
+    printf("info string %d trace rings holding %llu events\n", ring_count, (unsigned long long)event_count);
+#else
+    (void)params;
+    printf("info string search tracing is not compiled in, configure with -DIMATE_TRACE=ON\n");
+#endif
+}
@@ -0,0 +1,47 @@
+/* iMate -- Copyright (C) 2024 Martin Newbound */
+
+#include "../Commands.h"
+#include "../Options.h"
+#include <stdio.h>
+
+#define ENGINE_NAME "iMate 1.0.0"
+#define ENGINE_AUTHOR "Martin Newbound"
+
+/**
+ * @brief Prints the UCI declaration of an option.
+ *
+ * @param option The option to print.
+ */
+void print_option(const EngineOption *option) {
+    switch (option->type) {
+        case OPTION_SPIN:
+            printf("option name %s type spin default %s min %d max %d\n", option->name, option->default_value, option->min, option->max);
+            break;
+
+        case OPTION_CHECK:
+            printf("option name %s type check default %s\n", option->name, option->default_value);
+            break;
+
+        case OPTION_BUTTON:
+            printf("option name %s type button\n", option->name);
+            break;
+    }
+}
+
+/**
+ * @brief Executes the 'uci' command.
+ *
+ * This function identifies the engine, lists all the options it supports and acknowledges
+ * that the engine is ready to talk UCI.
+ * 
+ * @param params The command parameters. This parameter is not used in this function.
+ */
+void uci_command(const CommandParams params) {
+    printf("id name %s\n", ENGINE_NAME);
+    printf("id author %s\n", ENGINE_AUTHOR);
+
+    for (int i = 0; i < length_of_engine_options(); i++) print_option(&ENGINE_OPTIONS[i]);
+
+    printf("uciok\n");
+    fflush(stdout);
+}
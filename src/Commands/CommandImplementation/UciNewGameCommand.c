@@ -0,0 +1,20 @@
+/* iMate -- Copyright (C) 2024 Martin Newbound */
+
+#include "../Commands.h"
+#include "../../Search/Search.h"
+#include "../../Search/TranspositionTable.h"
+
+/**
+ * @brief Executes the 'ucinewgame' command.
+ *
+ * This function tells the engine the next search belongs to a different game, so the results
+ * cached in the transposition table and the move ordering heuristics are discarded.
+ * 
+ * @param params The command parameters, including the engine's search thread.
+ */
+void ucinewgame_command(const CommandParams params) {
+    stop_search_thread(params.engine_search_thread);
+
+    clear_transposition_table(get_search_thread_table(params.engine_search_thread));
+    clear_search_heuristics(get_search_thread_search(params.engine_search_thread));
+}
@@ -2,32 +2,70 @@
 
 #include "Commands.h"
 #include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+
+// Number of slots of the command lookup table, a power of two comfortably larger than the number of commands
+#define COMMAND_TABLE_SIZE 64
+
+#define IS_SEPARATOR(C) ((C) == ' ' || (C) == '\t' || (C) == '\n' || (C) == '\r' || (C) == '\v' || (C) == '\f')
 
 // Forward declare command functions
+void uci_command        (const CommandParams params);
+void isready_command    (const CommandParams params);
+void ucinewgame_command (const CommandParams params);
+void setoption_command  (const CommandParams params);
 void position_command   (const CommandParams params);
 void go_command         (const CommandParams params);
+void stop_command       (const CommandParams params);
 void print_command      (const CommandParams params);
 void quit_command       (const CommandParams params);
 void help_command       (const CommandParams params);
 void move_command       (const CommandParams params);
 void status_command     (const CommandParams params);
+void epd_command        (const CommandParams params);
+void batch_command      (const CommandParams params);
+void bench_command      (const CommandParams params);
+void stats_command      (const CommandParams params);
+void profile_command    (const CommandParams params);
+void trace_command      (const CommandParams params);
+void match_command      (const CommandParams params);
+void datagen_command    (const CommandParams params);
 
 /**
  * @brief Array of all engine commands.
  *
  * This array contains all the commands that the engine can handle. Each command is represented by a Command struct,
- * which contains a function pointer to the command's implementation and a regex string that matches the command's syntax.
+ * which contains a function pointer to the command's implementation, its name and its minimum number of arguments.
  */
 const Command ENGINE_COMMANDS[] = {
-    {help_command,          "^help$"},
-    {position_command,      "^position((startpos)|())$"},
-    {go_command,            "^go$"},
-    {print_command,         "^print((board)|(moves([a-f][1-8])))$"},
-    {quit_command,          "^quit$"},
-    {move_command,          "^move$"},
-    {status_command,        "^status$"}
+    {help_command,          "help",         0},
+    {uci_command,           "uci",          0},
+    {isready_command,       "isready",      0},
+    {ucinewgame_command,    "ucinewgame",   0},
+    {setoption_command,     "setoption",    2},
+    {position_command,      "position",     1},
+    {go_command,            "go",           0},
+    {stop_command,          "stop",         0},
+    {print_command,         "print",        1},
+    {quit_command,          "quit",         0},
+    {move_command,          "move",         1},
+    {status_command,        "status",       0},
+    {epd_command,           "epd",          1},
+    {batch_command,         "batch",        1},
+    {bench_command,         "bench",        0},
+    {stats_command,         "stats",        0},
+    {profile_command,       "profile",      0},
+    {trace_command,         "trace",        0},
+    {match_command,         "match",        1},
+    {datagen_command,       "datagen",      1}
 };
 
+/**
+ * @brief Open addressing hash table mapping command names to entries of ENGINE_COMMANDS.
+ */
+static const Command *COMMAND_TABLE[COMMAND_TABLE_SIZE];
+
 /**
  * @brief Returns the number of commands in the ENGINE_COMMANDS array.
  *
@@ -37,4 +75,54 @@ const Command ENGINE_COMMANDS[] = {
  */
 int length_of_engine_commands() {
     return sizeof(ENGINE_COMMANDS) / sizeof(ENGINE_COMMANDS[0]);
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Hashes a command name with the FNV-1a function.
+ *
+ * @param name The name to hash.
+ * @return The hash of the name.
+ */
+static uint32_t hash_command_name(const char *name) {
+    uint32_t hash = 2166136261u;
+    while (*name) {
+        hash ^= (unsigned char)*name++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+void init_command_table() {
+    memset(COMMAND_TABLE, 0, sizeof(COMMAND_TABLE));
+
+    for (int i = 0; i < length_of_engine_commands(); i++) {
+        uint32_t slot = hash_command_name(ENGINE_COMMANDS[i].name) & (COMMAND_TABLE_SIZE - 1);
+        while (COMMAND_TABLE[slot] != NULL) slot = (slot + 1) & (COMMAND_TABLE_SIZE - 1);
+        COMMAND_TABLE[slot] = &ENGINE_COMMANDS[i];
+    }
+}
+
+const Command *find_engine_command(const char *name) {
+    uint32_t slot = hash_command_name(name) & (COMMAND_TABLE_SIZE - 1);
+
+    while (COMMAND_TABLE[slot] != NULL) {
+        if (strcmp(COMMAND_TABLE[slot]->name, name) == 0) return COMMAND_TABLE[slot];
+        slot = (slot + 1) & (COMMAND_TABLE_SIZE - 1);
+    }
+
+    return NULL;
+}
+
+int tokenize_command_line(char *line, char **tokens, int max_tokens) {
+    int token_count = 0;
+
+    while (*line) {
+        while (IS_SEPARATOR(*line)) *line++ = '\0';
+        if (!*line || token_count == max_tokens) break;
+
+        tokens[token_count++] = line;
+        while (*line && !IS_SEPARATOR(*line)) line++;
+    }
+
+    return token_count;
+}
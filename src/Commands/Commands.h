@@ -6,6 +6,9 @@
  * The Command structure represents a command. The ENGINE_COMMANDS array contains all the commands that the engine can handle.
  * The length_of_engine_commands function returns the number of commands in the ENGINE_COMMANDS array.
  * 
+ * Input lines are split into whitespace separated tokens in place, and the first token is looked up in a
+ * hash table built from ENGINE_COMMANDS once at startup (see init_command_table).
+ * 
  * @version 1.0.0
  * @author Martin Newbound
  * @date 2024
@@ -26,23 +29,32 @@ extern "C" {
 #endif
 
 #include "../State/GameState.h"
-#include <regex.h>
+#include "../State/GameHistory.h"
+#include "../Search/SearchThread.h"
 #include <stdbool.h>
 
-#define MAX_MATCHES 10
+// Size of the line buffer, large enough for a "position ... moves ..." command of a very long game
+#define COMMAND_BUFFER_SIZE (1 << 16)
+
+// Maximum number of tokens in a line, every token is at least one character followed by a separator
+#define MAX_COMMAND_TOKENS (COMMAND_BUFFER_SIZE / 2)
 
 /**
  * @struct CommandParams
  * @brief A structure to hold the parameters for a command.
  *
- * This structure contains the user input, a pointer to the engine's running status, a pointer to the engine's game state,
- * and an array of matches for the command's regex.
+ * This structure contains the tokens of the input line (the first token being the command's name),
+ * a pointer to the engine's running status, a pointer to the engine's game state, the history of the moves which led to it
+ * and the engine's background search thread.
+ * The tokens point into the engine's line buffer and are only valid while the command runs.
  */
 typedef struct {
-    char *user_input;
+    char **tokens;
+    int token_count;
     bool *engine_is_running;
     state_t *engine_game_state;
-    char *matches[MAX_MATCHES];
+    game_history_t *engine_game_history;
+    search_thread_t *engine_search_thread;
 } CommandParams;
 
 /**
@@ -57,11 +69,13 @@ typedef void (*CommandFunc)(const CommandParams params);
  * @struct Command
  * @brief A structure to represent a command.
  *
- * This structure contains a function pointer to the command's implementation and a regex string that matches the command's syntax.
+ * This structure contains a function pointer to the command's implementation, the name the command is invoked by
+ * and the minimum number of arguments (tokens after the name) the command requires.
  */
 typedef struct {
     const CommandFunc func;
-    const char* regex;
+    const char* name;
+    const int min_arguments;
 } Command;
 
 extern const Command ENGINE_COMMANDS[];
@@ -75,6 +89,43 @@ extern const Command ENGINE_COMMANDS[];
  */
 int length_of_engine_commands();
 
+/**
+ * @brief Builds the command lookup table from the ENGINE_COMMANDS array.
+ *
+ * This function must be called once before find_engine_command, it is safe to call it more than once.
+ */
+void init_command_table();
+
+/**
+ * @brief Looks up a command by name.
+ *
+ * @param name The name of the command (the first token of the input line).
+ * @return The command, or NULL if no command has this name.
+ */
+const Command *find_engine_command(const char *name);
+
+/**
+ * @brief Splits a line into whitespace separated tokens, in place and without allocating.
+ *
+ * @param line The line to split, separators are overwritten with '\0'.
+ * @param tokens Receives pointers to the start of each token.
+ * @param max_tokens The capacity of the tokens array.
+ * @return The number of tokens found.
+ */
+int tokenize_command_line(char *line, char **tokens, int max_tokens);
+
+/**
+ * @brief Parses the arguments of the 'go' command into search limits.
+ *
+ * Unknown tokens are ignored. "ponder" is treated like "infinite", the GUI ends it with "stop".
+ * The commands which run searches of their own (epd, batch, match, datagen) read their limits with it too.
+ *
+ * @param tokens The tokens following "go".
+ * @param token_count The number of tokens.
+ * @param limits The limits to fill.
+ */
+void parse_go_arguments(char **tokens, int token_count, search_limits_t *limits);
+
 #ifdef __cplusplus
 }
 #endif
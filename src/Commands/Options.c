@@ -0,0 +1,50 @@
+/* iMate -- Copyright (C) 2024 Martin Newbound */
+
+#include "Options.h"
+#include "../Search/TranspositionTable.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <strings.h>
+
+#define STRINGIFY(X) #X
+#define TO_STRING(X) STRINGIFY(X)
+
+/**
+ * @brief Resizes the transposition table to the given number of megabytes.
+ */
+static void hash_option(const CommandParams params, const char *value) {
+    stop_search_thread(params.engine_search_thread);
+    transposition_table_t *table = get_search_thread_table(params.engine_search_thread);
+    resize_transposition_table(table, (size_t)atoi(value));
+    printf("info string hash table uses %s\n", get_transposition_table_pages(table));
+}
+
+/**
+ * @brief Removes all entries from the transposition table.
+ */
+static void clear_hash_option(const CommandParams params, const char *value) {
+    stop_search_thread(params.engine_search_thread);
+    clear_transposition_table(get_search_thread_table(params.engine_search_thread));
+}
+
+/**
+ * @brief Array of all engine options.
+ *
+ * This array contains all the options the engine advertises in response to "uci".
+ */
+const EngineOption ENGINE_OPTIONS[] = {
+    {hash_option,           "Hash",         OPTION_SPIN,    TO_STRING(DEFAULT_HASH_SIZE_MB), MIN_HASH_SIZE_MB, MAX_HASH_SIZE_MB},
+    {clear_hash_option,     "Clear Hash",   OPTION_BUTTON,  NULL,                            0,                0}
+};
+
+int length_of_engine_options() {
+    return sizeof(ENGINE_OPTIONS) / sizeof(ENGINE_OPTIONS[0]);
+}
+
+const EngineOption *find_engine_option(const char *name) {
+    for (int i = 0; i < length_of_engine_options(); i++) {
+        if (strcasecmp(ENGINE_OPTIONS[i].name, name) == 0) return &ENGINE_OPTIONS[i];
+    }
+    return NULL;
+}
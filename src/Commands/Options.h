@@ -0,0 +1,76 @@
+/**
+ * @file Options.h
+ * @brief This file contains the declarations of the structures and functions used for handling UCI engine options.
+ * 
+ * @details The EngineOption structure describes an option the engine advertises in response to "uci"
+ * and accepts through "setoption". The ENGINE_OPTIONS array contains all options of the engine.
+ * 
+ * @version 1.0.0
+ * @author Martin Newbound
+ * @date 2024
+ * 
+ * @note License:
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef OPTIONS_H
+#define OPTIONS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "Commands.h"
+
+typedef enum {
+    OPTION_SPIN,
+    OPTION_CHECK,
+    OPTION_BUTTON
+} option_type_t;
+
+/**
+ * @typedef OptionFunc
+ * @brief A function pointer type for applying an option.
+ *
+ * An option function receives the command parameters of the "setoption" command and the option's value
+ * (NULL for buttons). The value of spin options is clamped to the option's range before the call.
+ */
+typedef void (*OptionFunc)(const CommandParams params, const char *value);
+
+/**
+ * @struct EngineOption
+ * @brief A structure to represent a UCI option.
+ */
+typedef struct {
+    const OptionFunc func;
+    const char *name;
+    const option_type_t type;
+    const char *default_value;
+    const int min;
+    const int max;
+} EngineOption;
+
+extern const EngineOption ENGINE_OPTIONS[];
+
+/**
+ * @brief Returns the number of options in the ENGINE_OPTIONS array.
+ *
+ * @return The number of options in the ENGINE_OPTIONS array.
+ */
+int length_of_engine_options();
+
+/**
+ * @brief Finds an option by name, ignoring case as required by the UCI protocol.
+ *
+ * @param name The name of the option.
+ * @return The option, or NULL if the engine has no option with this name.
+ */
+const EngineOption *find_engine_option(const char *name);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // OPTIONS_H
@@ -0,0 +1,366 @@
+/* iMate -- Copyright (C) 2024 Martin Newbound */
+
+#include "BatchEvaluation.h"
+#include "Evaluation.h"
+#include "EvaluationData.h"
+#include "../Moves/PieceAttacks.h"
+#include <stdlib.h>
+#include <string.h>
+
+// On x86-64 the kernel is compiled twice, for AVX2 and for the baseline, and the loader picks the one the CPU runs
+#if defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__) && defined(__linux__)
+#define VECTOR_KERNEL __attribute__((target_clones("avx2", "default")))
+#else
+#define VECTOR_KERNEL
+#endif
+
+// The parts of the kernel are inlined into each of its versions, a call would leave them compiled for the baseline
+#if defined(__GNUC__)
+#define KERNEL_INLINE inline __attribute__((always_inline))
+#else
+#define KERNEL_INLINE inline
+#endif
+
+struct evaluation_batch {
+    size_t count;
+    size_t capacity;
+    uint64_t *bitboards[2][6];
+    uint8_t *to_move;
+};
+
+static void reserve_evaluation_batch(evaluation_batch_t *batch, size_t capacity) {
+    for (color_t color = WHITE; color <= BLACK; color++) {
+        for (piece_t piece = PIECE_PAWN; piece <= PIECE_KING; piece++) {
+            batch->bitboards[color][piece] = realloc(batch->bitboards[color][piece], capacity * sizeof(uint64_t));
+        }
+    }
+    batch->to_move = realloc(batch->to_move, capacity);
+    batch->capacity = capacity;
+}
+
+evaluation_batch_t *new_evaluation_batch(size_t capacity) {
+    evaluation_batch_t *batch = calloc(1, sizeof(evaluation_batch_t));
+    reserve_evaluation_batch(batch, capacity > 0 ? capacity : EVALUATION_BLOCK_SIZE);
+    return batch;
+}
+
+void free_evaluation_batch(evaluation_batch_t *batch) {
+    for (color_t color = WHITE; color <= BLACK; color++) {
+        for (piece_t piece = PIECE_PAWN; piece <= PIECE_KING; piece++) free(batch->bitboards[color][piece]);
+    }
+    free(batch->to_move);
+    free(batch);
+}
+
+void clear_evaluation_batch(evaluation_batch_t *batch) {
+    batch->count = 0;
+}
+
+size_t add_evaluation_batch_position(evaluation_batch_t *batch, const state_t *state) {
+    if (batch->count == batch->capacity) reserve_evaluation_batch(batch, batch->capacity * 2);
+
+    const size_t index = batch->count++;
+    for (color_t color = WHITE; color <= BLACK; color++) {
+        for (piece_t piece = PIECE_PAWN; piece <= PIECE_KING; piece++) {
+            batch->bitboards[color][piece][index] = get_state_peice_bitboard(state, piece, color);
+        }
+    }
+    batch->to_move[index] = (uint8_t)get_state_to_move_color(state);
+    return index;
+}
+
+size_t get_evaluation_batch_size(const evaluation_batch_t *batch) {
+    return batch->count;
+}
+
+void evaluate_batch(const evaluation_batch_t *batch, float *scores) {
+    evaluate_bitboard_batch((const uint64_t *const (*)[6])batch->bitboards, batch->to_move, batch->count, scores);
+}
+
+/*
++=============================================================================+
+|             Kernel                                                          |
++=============================================================================+
+*/
+
+/**
+ * @brief Counts the bits set in a bitboard for one lane.
+ *
+ * The bytes are summed with shifts rather than the multiplication of popcount_portable, which the compiler
+ * recognizes as a population count and then cannot vectorize without AVX-512.
+ *
+ * @param bitboard The bitboard.
+ * @return The number of bits set.
+ */
+static KERNEL_INLINE int32_t count_lane_bits(uint64_t bitboard) {
+    bitboard -= (bitboard >> 1) & 0x5555555555555555ULL;
+    bitboard = (bitboard & 0x3333333333333333ULL) + ((bitboard >> 2) & 0x3333333333333333ULL);
+    bitboard = (bitboard + (bitboard >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    bitboard += bitboard >> 8;
+    bitboard += bitboard >> 16;
+    bitboard += bitboard >> 32;
+    return (int32_t)(bitboard & 127);
+}
+
+/**
+ * @brief Returns the squares sliders attack in one direction, up to and including the first piece in their way.
+ *
+ * The rays of all the sliders are grown together by a Kogge-Stone fill, in three doubling steps and without a
+ * lookup, so the same instructions serve every lane.
+ *
+ * @param sliders The squares of the sliders.
+ * @param empty The empty squares.
+ * @param shift The step between two squares of the direction, positive towards h8 and negative towards a1.
+ * @param wrap The squares a step may land on without wrapping around the edge of the board.
+ * @return The squares attacked.
+ */
+static KERNEL_INLINE uint64_t fill_slider_attacks(uint64_t sliders, uint64_t empty, int shift, uint64_t wrap) {
+    empty &= wrap;
+
+    if (shift > 0) {
+        sliders |= empty & (sliders << shift);
+        empty &= empty << shift;
+        sliders |= empty & (sliders << 2 * shift);
+        empty &= empty << 2 * shift;
+        sliders |= empty & (sliders << 4 * shift);
+        return (sliders << shift) & wrap;
+    }
+
+    sliders |= empty & (sliders >> -shift);
+    empty &= empty >> -shift;
+    sliders |= empty & (sliders >> -2 * shift);
+    empty &= empty >> -2 * shift;
+    sliders |= empty & (sliders >> -4 * shift);
+    return (sliders >> -shift) & wrap;
+}
+
+static KERNEL_INLINE uint64_t fill_rook_attacks(uint64_t rooks, uint64_t empty) {
+    return fill_slider_attacks(rooks, empty, 8, ~0ULL) | fill_slider_attacks(rooks, empty, -8, ~0ULL)
+         | fill_slider_attacks(rooks, empty, 1, NOT_FILE_A_MASK) | fill_slider_attacks(rooks, empty, -1, NOT_FILE_H_MASK);
+}
+
+static KERNEL_INLINE uint64_t fill_bishop_attacks(uint64_t bishops, uint64_t empty) {
+    return fill_slider_attacks(bishops, empty, 9, NOT_FILE_A_MASK) | fill_slider_attacks(bishops, empty, 7, NOT_FILE_H_MASK)
+         | fill_slider_attacks(bishops, empty, -7, NOT_FILE_A_MASK) | fill_slider_attacks(bishops, empty, -9, NOT_FILE_H_MASK);
+}
+
+/**
+ * @brief The attack maps of a block and the sums of its attack terms, one lane per position.
+ */
+typedef struct {
+    uint64_t empty[EVALUATION_BLOCK_SIZE];
+    uint64_t attacked[2][EVALUATION_BLOCK_SIZE];
+    uint64_t attacked_twice[2][EVALUATION_BLOCK_SIZE];
+    uint64_t pawn_attacks[2][EVALUATION_BLOCK_SIZE];
+    uint64_t king_attacks[2][EVALUATION_BLOCK_SIZE];
+    uint64_t queen_attacks[2][EVALUATION_BLOCK_SIZE];
+    int32_t mobility[2][2][EVALUATION_BLOCK_SIZE];      // indexed by color, then game phase
+    int32_t attackers[2][EVALUATION_BLOCK_SIZE];
+    int32_t attack_units[2][EVALUATION_BLOCK_SIZE];
+} block_attacks_t;
+
+/**
+ * @brief Adds the attacks of the pieces of one type and color to the maps of a block, with their mobility and
+ * the attack units they put on the opposing king.
+ *
+ * Each piece needs its own attack set for its mobility, so every pass takes the lowest remaining piece of each
+ * position, and there are as many passes as the position of the block with the most such pieces requires.
+ * Positions out of pieces take part in a pass with an empty set, which attacks nothing and is masked out of the
+ * mobility.
+ *
+ * @param boards The bitboards of the block.
+ * @param color The color of the pieces.
+ * @param piece The type of the pieces, a knight or a slider (the argument is a constant once inlined).
+ * @param block The attack maps and sums to add to.
+ */
+static KERNEL_INLINE void add_block_piece_attacks(const uint64_t boards[2][6][EVALUATION_BLOCK_SIZE], color_t color, piece_t piece,
+                                                  block_attacks_t *block) {
+    const color_t opponent = color == WHITE ? BLACK : WHITE;
+    const int (*mobility_tables)[MAX_MOBILITY + 1] = MOBILITY_TABLES[piece - PIECE_ROOK];
+    const uint64_t queen_mask = piece == PIECE_QUEEN ? ~0ULL : 0;
+
+    uint64_t remaining[EVALUATION_BLOCK_SIZE];
+    uint64_t any = 0;
+    for (int i = 0; i < EVALUATION_BLOCK_SIZE; i++) {
+        remaining[i] = boards[color][piece][i];
+        any |= remaining[i];
+    }
+
+    while (any) {
+        any = 0;
+
+        for (int i = 0; i < EVALUATION_BLOCK_SIZE; i++) {
+            const uint64_t square = remaining[i] & (0 - remaining[i]);
+            remaining[i] ^= square;
+            any |= remaining[i];
+
+            uint64_t attacks;
+            if (piece == PIECE_KNIGHT) attacks = get_knight_attacks(square);
+            else if (piece == PIECE_BISHOP) attacks = fill_bishop_attacks(square, block->empty[i]);
+            else if (piece == PIECE_ROOK) attacks = fill_rook_attacks(square, block->empty[i]);
+            else attacks = fill_rook_attacks(square, block->empty[i]) | fill_bishop_attacks(square, block->empty[i]);
+
+            const uint64_t mobility_area = ~(boards[color][PIECE_PAWN][i] | boards[color][PIECE_KING][i] | block->pawn_attacks[opponent][i]);
+            const int mobility = count_lane_bits(attacks & mobility_area);
+            const int32_t present = -(int32_t)(square != 0);
+            block->mobility[color][0][i] += present & mobility_tables[0][mobility];
+            block->mobility[color][1][i] += present & mobility_tables[1][mobility];
+
+            const uint64_t zone_attacks = attacks & block->king_attacks[opponent][i];
+            block->attackers[color][i] += zone_attacks != 0;
+            block->attack_units[color][i] += KING_ATTACK_UNITS[piece] * count_lane_bits(zone_attacks);
+
+            block->attacked_twice[color][i] |= block->attacked[color][i] & attacks;
+            block->attacked[color][i] |= attacks;
+            block->queen_attacks[color][i] |= queen_mask & attacks;
+        }
+    }
+}
+
+/**
+ * @brief Adds the mobility and king danger terms of EVALUATION_BLOCK_SIZE positions to their early and late game
+ * sums, as get_attack_weights computes them with DEFAULT_EVALUATION_PARAMS.
+ *
+ * The attack maps are built for the whole block at once: pawns, knights and kings by shifting their bitboards and
+ * sliders by fills, so no lane needs a table lookup other than those of the mobility and danger weights.
+ */
+static KERNEL_INLINE void add_block_attack_weights(const uint64_t boards[2][6][EVALUATION_BLOCK_SIZE], int32_t early[EVALUATION_BLOCK_SIZE],
+                                                   int32_t late[EVALUATION_BLOCK_SIZE]) {
+    block_attacks_t block;
+
+    for (int i = 0; i < EVALUATION_BLOCK_SIZE; i++) {
+        uint64_t occupancy = 0;
+        for (color_t color = WHITE; color <= BLACK; color++) {
+            for (piece_t piece = PIECE_PAWN; piece <= PIECE_KING; piece++) occupancy |= boards[color][piece][i];
+        }
+        block.empty[i] = ~occupancy;
+    }
+
+    // Pawns and kings come first, the mobility area and the king zone of the other pieces are made of their attacks
+    for (color_t color = WHITE; color <= BLACK; color++) {
+        for (int i = 0; i < EVALUATION_BLOCK_SIZE; i++) {
+            const uint64_t west_attacks = get_pawn_west_attacks(boards[color][PIECE_PAWN][i], color);
+            const uint64_t east_attacks = get_pawn_east_attacks(boards[color][PIECE_PAWN][i], color);
+            const uint64_t king_attacks = get_king_attacks(boards[color][PIECE_KING][i]);
+
+            block.pawn_attacks[color][i] = west_attacks | east_attacks;
+            block.king_attacks[color][i] = king_attacks;
+            block.attacked[color][i] = west_attacks | east_attacks | king_attacks;
+            block.attacked_twice[color][i] = (west_attacks & east_attacks) | ((west_attacks | east_attacks) & king_attacks);
+            block.queen_attacks[color][i] = 0;
+            block.mobility[color][0][i] = block.mobility[color][1][i] = 0;
+            block.attackers[color][i] = block.attack_units[color][i] = 0;
+        }
+    }
+
+    for (color_t color = WHITE; color <= BLACK; color++) {
+        add_block_piece_attacks(boards, color, PIECE_ROOK, &block);
+        add_block_piece_attacks(boards, color, PIECE_KNIGHT, &block);
+        add_block_piece_attacks(boards, color, PIECE_BISHOP, &block);
+        add_block_piece_attacks(boards, color, PIECE_QUEEN, &block);
+    }
+
+    // Both colors are complete, so the squares attacked twice and defended by at most the king can be counted
+    for (color_t color = WHITE; color <= BLACK; color++) {
+        const color_t opponent = color == WHITE ? BLACK : WHITE;
+        const int32_t sign = color == WHITE ? 1 : -1;
+
+        for (int i = 0; i < EVALUATION_BLOCK_SIZE; i++) {
+            early[i] += sign * (block.mobility[color][0][i] * DEFAULT_EVALUATION_PARAMS.mobility_weight / 100);
+            late[i] += sign * (block.mobility[color][1][i] * DEFAULT_EVALUATION_PARAMS.mobility_weight / 100);
+
+            const uint64_t king_zone = block.king_attacks[opponent][i];
+            int32_t attack_units = block.attack_units[color][i]
+                                 + count_lane_bits(king_zone & block.attacked_twice[color][i] & ~block.attacked_twice[opponent][i]);
+            attack_units = attack_units > MAX_KING_ATTACK_UNITS ? MAX_KING_ATTACK_UNITS : attack_units;
+
+            const int32_t applies = -(int32_t)((block.attackers[color][i] >= 2) & ((block.queen_attacks[color][i] & king_zone) != 0));
+            early[i] += sign * (applies & (KING_DANGER[attack_units] * DEFAULT_EVALUATION_PARAMS.king_danger_weight / 100));
+        }
+    }
+}
+
+/**
+ * @brief Evaluates EVALUATION_BLOCK_SIZE positions. Every loop over the lanes has a fixed length and no branches,
+ * so it becomes straight vector code and the sums stay in registers.
+ */
+static KERNEL_INLINE void evaluate_block(const uint64_t boards[2][6][EVALUATION_BLOCK_SIZE], const uint8_t to_move[EVALUATION_BLOCK_SIZE],
+                                         float scores[EVALUATION_BLOCK_SIZE]) {
+    int32_t early[EVALUATION_BLOCK_SIZE] = {0};
+    int32_t late[EVALUATION_BLOCK_SIZE] = {0};
+    int32_t material[2][EVALUATION_BLOCK_SIZE] = {{0}};
+
+    for (color_t color = WHITE; color <= BLACK; color++) {
+        const int32_t sign = color == WHITE ? 1 : -1;
+
+        for (piece_t piece = PIECE_PAWN; piece <= PIECE_KING; piece++) {
+            const uint64_t *board = boards[color][piece];
+
+            if (piece != PIECE_KING) {
+                for (int i = 0; i < EVALUATION_BLOCK_SIZE; i++) {
+                    material[color][i] += PIECE_WEIGHT[piece] * __builtin_popcountll(board[i]);
+                }
+            }
+
+            // Each half of the board is scanned as 32 bit words, so a vector register holds twice as many lanes
+            for (int half = 0; half < 2; half++) {
+                uint32_t words[EVALUATION_BLOCK_SIZE];
+                uint32_t any = 0;
+                for (int i = 0; i < EVALUATION_BLOCK_SIZE; i++) {
+                    words[i] = (uint32_t)(board[i] >> (32 * half));
+                    any |= words[i];
+                }
+
+                // Only the squares occupied in some position of the block are visited
+                for (uint32_t squares = any; squares != 0; squares &= squares - 1) {
+                    const int bit = __builtin_ctz(squares);
+                    const int table_square = TABLE_SQUARE(32 * half + bit, color);
+                    const int32_t early_value = sign * PIECE_SQUARE_TABLES[piece][0][table_square];
+                    const int32_t late_value = sign * PIECE_SQUARE_TABLES[piece][1][table_square];
+
+                    for (int i = 0; i < EVALUATION_BLOCK_SIZE; i++) {
+                        const int32_t mask = -(int32_t)((words[i] >> bit) & 1);
+                        early[i] += mask & early_value;
+                        late[i] += mask & late_value;
+                    }
+                }
+            }
+        }
+    }
+
+    // The integer sums are the same in any order, the attack terms are added to those of the tables
+    add_block_attack_weights(boards, early, late);
+
+    // The floating point steps of evaluate_state, in the same order
+    for (int i = 0; i < EVALUATION_BLOCK_SIZE; i++) {
+        float phase_factor = (float)(material[WHITE][i] + material[BLACK][i]) / (2.0f * STARTING_PIECE_WEIGHT);
+        phase_factor = phase_factor > 1.0f ? 1.0f : phase_factor;
+
+        float evaluation = (1 - phase_factor) * (float)late[i] + phase_factor * (float)early[i];
+        evaluation += (float)(material[WHITE][i] - material[BLACK][i]);
+        scores[i] = to_move[i] == WHITE ? evaluation : -evaluation;
+    }
+}
+
+VECTOR_KERNEL
+void evaluate_bitboard_batch(const uint64_t *const bitboards[2][6], const uint8_t *to_move, size_t count, float *scores) {
+    for (size_t begin = 0; begin < count; begin += EVALUATION_BLOCK_SIZE) {
+        const size_t width = count - begin < EVALUATION_BLOCK_SIZE ? count - begin : EVALUATION_BLOCK_SIZE;
+
+        // The block is copied so the last one can be padded with empty boards
+        uint64_t boards[2][6][EVALUATION_BLOCK_SIZE];
+        uint8_t block_to_move[EVALUATION_BLOCK_SIZE] = {0};
+        float block_scores[EVALUATION_BLOCK_SIZE];
+
+        if (width < EVALUATION_BLOCK_SIZE) memset(boards, 0, sizeof(boards));
+        for (color_t color = WHITE; color <= BLACK; color++) {
+            for (piece_t piece = PIECE_PAWN; piece <= PIECE_KING; piece++) {
+                memcpy(boards[color][piece], bitboards[color][piece] + begin, width * sizeof(uint64_t));
+            }
+        }
+        memcpy(block_to_move, to_move + begin, width);
+
+        evaluate_block((const uint64_t (*)[6][EVALUATION_BLOCK_SIZE])boards, block_to_move, block_scores);
+        memcpy(scores + begin, block_scores, width * sizeof(float));
+    }
+}
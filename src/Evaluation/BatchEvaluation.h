@@ -0,0 +1,109 @@
+/* iMate -- Copyright (C) 2024 Martin Newbound */
+
+/**
+ * @file BatchEvaluation.h
+ * @brief This file contains the declarations of the evaluation of many positions at once.
+ *
+ * @details Positions are stored as arrays of bitboards, one array per piece type and color (structure of arrays),
+ * and are evaluated in blocks of EVALUATION_BLOCK_SIZE positions. Within a block every square of every bitboard is
+ * handled for all the positions together by loops of identical lanes, which the compiler turns into vector code
+ * (AVX2 on x86-64, where the kernel is also compiled for the baseline and picked when the program is loaded).
+ *
+ * The scores are those of evaluate_state, to the bit: the same integer sums are taken and the same floating point
+ * operations applied to them. The mobility and king danger terms are computed in the kernel too, from attack maps
+ * built for the whole block: pawns, knights and kings by shifting their bitboards, sliders by Kogge-Stone fills
+ * rather than the lookups of the move generator, and the pieces which need an attack set of their own one at a
+ * time from every position.
+ *
+ * @version 1.0.0
+ * @author Martin Newbound
+ * @date 2024
+ *
+ * @note License:
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef BATCH_EVALUATION_H
+#define BATCH_EVALUATION_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "../State/GameState.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// Positions evaluated together by the kernel (enough lanes for the compiler to vectorize rather than unroll)
+#define EVALUATION_BLOCK_SIZE 32
+
+// Positions stored as arrays of bitboards
+typedef struct evaluation_batch evaluation_batch_t;
+
+/**
+ * Creates an empty batch of positions.
+ *
+ * @param capacity The number of positions to reserve room for, the batch grows past it as needed.
+ * @return A pointer to the new batch.
+ *
+ * @warning The caller is responsible for freeing the batch with free_evaluation_batch.
+ */
+evaluation_batch_t *new_evaluation_batch(size_t capacity);
+
+/**
+ * Frees a batch of positions.
+ *
+ * @param batch The batch to free.
+ */
+void free_evaluation_batch(evaluation_batch_t *batch);
+
+/**
+ * Removes all the positions of a batch, keeping its memory.
+ *
+ * @param batch The batch.
+ */
+void clear_evaluation_batch(evaluation_batch_t *batch);
+
+/**
+ * Adds a position to a batch.
+ *
+ * @param batch The batch.
+ * @param state The position, copied into the batch.
+ * @return The index of the position in the batch, which is the index of its score.
+ */
+size_t add_evaluation_batch_position(evaluation_batch_t *batch, const state_t *state);
+
+/**
+ * Returns the number of positions of a batch.
+ *
+ * @param batch The batch.
+ * @return The number of positions.
+ */
+size_t get_evaluation_batch_size(const evaluation_batch_t *batch);
+
+/**
+ * Evaluates every position of a batch.
+ *
+ * @param batch The batch.
+ * @param[out] scores Receives one score per position, as evaluate_state would return it.
+ */
+void evaluate_batch(const evaluation_batch_t *batch, float *scores);
+
+/**
+ * Evaluates positions given as arrays of bitboards.
+ *
+ * @param bitboards bitboards[color][piece][i] holds the pieces of a type and color in position i.
+ * @param to_move to_move[i] holds the color to move in position i.
+ * @param count The number of positions.
+ * @param[out] scores Receives one score per position, as evaluate_state would return it.
+ */
+void evaluate_bitboard_batch(const uint64_t *const bitboards[2][6], const uint8_t *to_move, size_t count, float *scores);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BATCH_EVALUATION_H
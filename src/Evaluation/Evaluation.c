@@ -9,30 +9,126 @@
 
 #include "../Evaluation/Evaluation.h"
 #include "../Evaluation/EvaluationData.h"
+#include "../Utils/BitOperations.h"
+#include "../Utils/Profiler.h"
 #include "stdlib.h"
 
 #include <float.h>
 
+const evaluation_params_t DEFAULT_EVALUATION_PARAMS = {
+    .mobility_weight = 100,
+    .king_danger_weight = 100
+};
+
+const int KING_ATTACK_UNITS[6] = {0, 3, 2, 2, 5, 0};
+
+/**
+ * @brief Adds the material and piece-square weights of the pieces of one color.
+ *
+ * @param state The state to evaluate.
+ * @param color The color of the pieces.
+ * @param possesion_weights The material weights, indexed by color.
+ * @param positional_weights The piece-square weights, indexed by color and game phase.
+ */
+static void add_piece_weights(const state_t *state, color_t color, int possesion_weights[2], int positional_weights[2][2]) {
+    for (piece_t piece = PIECE_PAWN; piece <= PIECE_KING; piece++) {
+        const int *early_table = PIECE_SQUARE_TABLES[piece][EARLY_GAME_INDEX];
+        const int *late_table = PIECE_SQUARE_TABLES[piece][LATE_GAME_INDEX];
+        uint64_t pieces = get_state_peice_bitboard(state, piece, color);
+
+        if (piece != PIECE_KING) possesion_weights[color] += PIECE_WEIGHT[piece] * popcount(pieces);
+
+        while (pieces) {
+            const int table_square = TABLE_SQUARE(pop_lsb(&pieces), color);
+            positional_weights[color][EARLY_GAME_INDEX] += early_table[table_square];
+            positional_weights[color][LATE_GAME_INDEX] += late_table[table_square];
+        }
+    }
+}
+
+/**
+ * @brief Adds the mobility weights of the pieces of one color, and the danger they put the opposing king in.
+ *
+ * The mobility of a piece is the number of squares it attacks which hold neither a pawn nor the king of its
+ * color and are not attacked by an opposing pawn. The danger counts attack units for every square next to the
+ * opposing king a piece attacks, and for every such square attacked twice and defended by at most the king.
+ * It only applies once two pieces take part in the attack and one of them is the queen.
+ *
+ * @param state The state to evaluate.
+ * @param info The attack maps of the state.
+ * @param params The weights of the terms.
+ * @param color The color of the pieces.
+ * @param positional_weights The positional weights, indexed by color and game phase.
+ */
+static void add_attack_weights(const state_t *state, const attack_info_t *info, const evaluation_params_t *params,
+                               color_t color, int positional_weights[2][2]) {
+    const color_t opponent = color == WHITE ? BLACK : WHITE;
+    const uint64_t mobility_area = ~(get_state_peice_bitboard(state, PIECE_PAWN, color)
+                                   | get_state_peice_bitboard(state, PIECE_KING, color)
+                                   | info->attacks[opponent][PIECE_PAWN]);
+    const uint64_t king_zone = info->attacks[opponent][PIECE_KING];
+    int mobility_weights[2] = {0, 0};
+    int attackers = 0, attack_units = 0;
+
+    for (piece_t piece = PIECE_ROOK; piece <= PIECE_QUEEN; piece++) {
+        const int (*mobility_tables)[MAX_MOBILITY + 1] = MOBILITY_TABLES[piece - PIECE_ROOK];
+        uint64_t pieces = get_state_peice_bitboard(state, piece, color);
+
+        while (pieces) {
+            const uint64_t attacks = info->square_attacks[pop_lsb(&pieces)];
+            const int mobility = popcount(attacks & mobility_area);
+            mobility_weights[EARLY_GAME_INDEX] += mobility_tables[EARLY_GAME_INDEX][mobility];
+            mobility_weights[LATE_GAME_INDEX] += mobility_tables[LATE_GAME_INDEX][mobility];
+
+            if (attacks & king_zone) {
+                attackers++;
+                attack_units += KING_ATTACK_UNITS[piece] * popcount(attacks & king_zone);
+            }
+        }
+    }
+
+    positional_weights[color][EARLY_GAME_INDEX] += mobility_weights[EARLY_GAME_INDEX] * params->mobility_weight / 100;
+    positional_weights[color][LATE_GAME_INDEX] += mobility_weights[LATE_GAME_INDEX] * params->mobility_weight / 100;
+
+    if (attackers < 2 || !(info->attacks[color][PIECE_QUEEN] & king_zone)) return;
+
+    attack_units += popcount(king_zone & info->attacked_twice[color] & ~info->attacked_twice[opponent]);
+    if (attack_units > MAX_KING_ATTACK_UNITS) attack_units = MAX_KING_ATTACK_UNITS;
+    positional_weights[opponent][EARLY_GAME_INDEX] -= KING_DANGER[attack_units] * params->king_danger_weight / 100;
+}
+
+void get_attack_weights(const state_t *state, const attack_info_t *info, const evaluation_params_t *params, int weights[2]) {
+    int attack_weights[2][2] = {{0, 0}, {0, 0}};
+    add_attack_weights(state, info, params, WHITE, attack_weights);
+    add_attack_weights(state, info, params, BLACK, attack_weights);
+
+    weights[EARLY_GAME_INDEX] = attack_weights[WHITE][EARLY_GAME_INDEX] - attack_weights[BLACK][EARLY_GAME_INDEX];
+    weights[LATE_GAME_INDEX] = attack_weights[WHITE][LATE_GAME_INDEX] - attack_weights[BLACK][LATE_GAME_INDEX];
+}
+
 float evaluate_state(const state_t *curr_state) {
-    // Check game status
-    if (is_checkmate(curr_state, WHITE)) return FLT_MAX;
-    if (is_checkmate(curr_state, BLACK)) return FLT_MIN;
+    attack_info_t info;
+    compute_attack_info(curr_state, &info);
+    return evaluate_state_with_attack_info(curr_state, &info, &DEFAULT_EVALUATION_PARAMS);
+}
+
+float evaluate_state_with_attack_info(const state_t *curr_state, const attack_info_t *info, const evaluation_params_t *params) {
+    PROFILE_SCOPE(PROFILE_EVALUATION);
 
     // Initialize weights
     int positional_weights[2][2] = {{0, 0}, {0, 0}};
     int possesion_weights[2] = {0, 0};
     
-    // Calculate weights for each square
-    for (size_t square = 0; square < 64; ++square) {
-        piece_t piece = get_piece_on_square(curr_state, square);
-        color_t color = get_color_of_piece_on_square(curr_state, square);
-
-        if (piece == NULL_PIECE) continue;
-        if (piece != PIECE_KING) possesion_weights[color] += PIECE_WEIGHT[piece];
-        positional_weights[color][EARLY_GAME_INDEX] += PIECE_SQUARE_TABLES[piece][EARLY_GAME_INDEX][square];
-        positional_weights[color][LATE_GAME_INDEX] += PIECE_SQUARE_TABLES[piece][LATE_GAME_INDEX][square];
+    // Calculate weights for each piece, then add the attack terms (as differences, on white's side)
+    for (color_t color = WHITE; color <= BLACK; color++) {
+        add_piece_weights(curr_state, color, possesion_weights, positional_weights);
     }
 
+    int attack_weights[2];
+    get_attack_weights(curr_state, info, params, attack_weights);
+    positional_weights[WHITE][EARLY_GAME_INDEX] += attack_weights[EARLY_GAME_INDEX];
+    positional_weights[WHITE][LATE_GAME_INDEX] += attack_weights[LATE_GAME_INDEX];
+
     // Calculate scores
     float possesion_score = POSSESION_SCORE();
     float early_positional_score = POSITIONAL_SCORE(EARLY_GAME_INDEX);
@@ -40,10 +136,12 @@ float evaluate_state(const state_t *curr_state) {
 
     // Calculate phase factor
     float phase_factor = (float) (possesion_weights[WHITE] + possesion_weights[BLACK]) / (2.0f * STARTING_PIECE_WEIGHT);
+    if (phase_factor > 1.0f) phase_factor = 1.0f;
 
     // Interpolate positional score and add possesion score
     float evaluation = INTERPOLATE(early_positional_score, late_positional_score, phase_factor);
     evaluation += possesion_score;
 
-    return evaluation;
-}
\ No newline at end of file
+    // Scores are reported from the perspective of the player to move
+    return get_state_to_move_color(curr_state) == WHITE ? evaluation : -evaluation;
+}
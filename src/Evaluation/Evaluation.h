@@ -37,6 +37,23 @@ extern "C" {
 #endif
 
 #include "../State/GameState.h"
+#include "../Moves/AttackInfo.h"
+
+/**
+ * @brief The weights of the evaluation terms computed from the attack maps, in percent of their table values.
+ *
+ * A search holds its own weights (see search_params_t), so the players of a match can evaluate differently.
+ */
+typedef struct {
+    int mobility_weight;
+    int king_danger_weight;
+} evaluation_params_t;
+
+// The weights evaluate_state uses
+extern const evaluation_params_t DEFAULT_EVALUATION_PARAMS;
+
+// Attack units a piece adds for each square next to the opposing king it attacks (indexed by piece_t)
+extern const int KING_ATTACK_UNITS[6];
 
 /**
  * @brief Evaluates a game state and returns an appropriate score.
@@ -49,9 +66,8 @@ extern "C" {
  * However, the score is totally orderable such that a state with higher score is
  * better for the current player than a lower scored state.
  * 
- * @note The returned score can be any value in the domain of floating point numbers. 
- * @note A score which is the maximum or minimum possible value represents a checkmate.
- * @note Stalemates are handled on a context-specific basis and are not necessarily good or bad.
+ * @note The returned score is measured in centipawns and can be any value in the domain of floating point numbers. 
+ * @note Checkmates and stalemates are not detected here, they are handled by the search.
  * @note This function is deterministic.
  * 
  * @warning this function can only provide approximations of the true value of a game state. 
@@ -61,6 +77,36 @@ extern "C" {
  */
 float evaluate_state(const state_t *state);
 
+/**
+ * @brief Evaluates a game state whose attack maps are already known.
+ *
+ * @details
+ * Returns the same score as evaluate_state, which computes the maps itself, when given DEFAULT_EVALUATION_PARAMS.
+ * The search passes the maps it keeps for the node, so they are computed once for both its legality checks and
+ * the evaluation, and the weights of its parameters.
+ *
+ * @param state Pointer to the game state to evaluate.
+ * @param info The attack maps of the state (see get_attack_info).
+ * @param params The weights of the attack terms.
+ * @return Score of the given game state.
+ */
+float evaluate_state_with_attack_info(const state_t *state, const attack_info_t *info, const evaluation_params_t *params);
+
+/**
+ * @brief Computes the terms of the evaluation which need the attack maps: mobility and king danger.
+ *
+ * @details
+ * They are the part of the score the piece weights and piece-square tables do not give. Their early and late game
+ * weights are added to those of the tables before the game phase interpolates between them, so the batch
+ * evaluation and the tuner, which only handle the tables, add these to match evaluate_state.
+ *
+ * @param state Pointer to the game state.
+ * @param info The attack maps of the state.
+ * @param params The weights of the terms.
+ * @param[out] weights Receives the early and late game weights, white's minus black's.
+ */
+void get_attack_weights(const state_t *state, const attack_info_t *info, const evaluation_params_t *params, int weights[2]);
+
 #ifdef __cplusplus
 }
 #endif
@@ -4,9 +4,9 @@
 
 const int PIECE_WEIGHT[5] = {
     100,    // PAWN
+    500,    // ROOK
     320,    // KNIGHT
     330,    // BISHOP
-    500,    // ROOK
     900,    // QUEEN
 };
 
@@ -163,3 +163,55 @@ const int PIECE_SQUARE_TABLES[6][2][64] = {
         }
     }
 };
+
+const int MOBILITY_TABLES[4][2][MAX_MOBILITY + 1] = {
+    { // Rook Mobility
+        { // Mid Game Rook Mobility
+             -29,  -14,   -8,   -5,   -2,   -1,    4,    8,   15,   14,   16,   19,   23,   24,
+              29,
+        },
+        { // End Game Rook Mobility
+             -38,   -9,   14,   28,   34,   41,   56,   59,   66,   71,   78,   82,   83,   84,
+              86,
+        }
+    },
+    { // Knight Mobility
+        { // Mid Game Knight Mobility
+             -31,  -26,   -6,   -2,    2,    6,   11,   14,   16,
+        },
+        { // End Game Knight Mobility
+             -40,  -28,  -15,   -7,    4,    8,   12,   14,   16,
+        }
+    },
+    { // Bishop Mobility
+        { // Mid Game Bishop Mobility
+             -24,  -10,    8,   13,   19,   26,   28,   32,   32,   34,   40,   40,   46,   49,
+        },
+        { // End Game Bishop Mobility
+             -30,  -12,   -2,    6,   12,   21,   27,   28,   32,   36,   39,   43,   44,   48,
+        }
+    },
+    { // Queen Mobility
+        { // Mid Game Queen Mobility
+             -20,  -10,    2,    2,    7,   11,   14,   20,   22,   24,   28,   30,   30,   33,
+              34,   35,   36,   36,   40,   44,   44,   50,   51,   51,   53,   54,   56,   58,
+        },
+        { // End Game Queen Mobility
+             -18,   -8,    4,    9,   17,   27,   30,   36,   40,   46,   47,   52,   56,   60,
+              62,   63,   66,   68,   70,   72,   74,   83,   85,   88,   92,   96,  103,  106,
+        }
+    }
+};
+
+const int KING_DANGER[MAX_KING_ATTACK_UNITS + 1] = {
+      0,   0,   1,   2,   3,   5,   7,   9,  12,  15,
+     18,  22,  26,  30,  35,  39,  44,  50,  56,  62,
+     68,  75,  82,  85,  89,  97, 105, 113, 122, 131,
+    140, 150, 169, 180, 191, 202, 213, 225, 237, 248,
+    260, 272, 283, 295, 307, 319, 330, 342, 354, 366,
+    377, 389, 401, 412, 424, 436, 448, 459, 471, 483,
+    494, 500, 500, 500, 500, 500, 500, 500, 500, 500,
+    500, 500, 500, 500, 500, 500, 500, 500, 500, 500,
+    500, 500, 500, 500, 500, 500, 500, 500, 500, 500,
+    500, 500, 500, 500, 500, 500, 500, 500, 500, 500,
+};
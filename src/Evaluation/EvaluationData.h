@@ -4,6 +4,7 @@
  * 
  * @details The PIECE_WEIGHT array holds the weights for each piece type. The STARTING_PIECE_WEIGHT constant represents the total weight of all pieces at the start of the game.
  * The PIECE_SQUARE_TABLES array contains piece-square tables for each piece type and game phase. These data are used in the evaluation of the game state.
+ * The MOBILITY_TABLES and KING_DANGER arrays score the squares the pieces attack, they are not tuned.
  * 
  * @version 1.0.0
  * @author Martin Newbound
@@ -29,7 +30,7 @@ extern "C" {
  * @brief Array of weights for each piece type.
  *
  * This array contains the weights for each piece type, used in the evaluation of the game state.
- * The indices correspond to the piece types (e.g., pawn, knight, bishop, rook, queen).
+ * The indices correspond one to one with piece_t (pawn, rook, knight, bishop, queen).
  */
 extern const int PIECE_WEIGHT[5];
 
@@ -47,9 +48,38 @@ extern const int STARTING_PIECE_WEIGHT;
  * The piece-square table is used in the evaluation of the game state to determine the value of a piece based on its position on the board.
  * The first index corresponds to the piece type, the second index corresponds to the game phase (0 for early game, 1 for late game),
  * and the third index corresponds to the square on the board.
+ * Tables are laid out from white's point of view with a8 first, so white pieces are looked up with the square mirrored vertically.
  */
 extern const int PIECE_SQUARE_TABLES[6][2][64];
 
+/**
+ * @brief The index into a piece-square table of a square for a color: the rank is mirrored for white.
+ */
+#define TABLE_SQUARE(SQUARE, COLOR) ((COLOR) == WHITE ? (SQUARE) ^ 56 : (SQUARE))
+
+/**
+ * @brief The largest number of squares a piece can attack (a queen in the centre of an empty board).
+ */
+#define MAX_MOBILITY 27
+
+/**
+ * @brief Array of mobility tables for each piece type other than pawns and kings, and game phase.
+ *
+ * The first index is the piece type less PIECE_ROOK (rook, knight, bishop, queen), the second index is the game phase
+ * (0 for early game, 1 for late game), and the third index is the number of safe squares the piece attacks:
+ * squares which hold neither a pawn nor the king of its own color and are not attacked by an opposing pawn.
+ */
+extern const int MOBILITY_TABLES[4][2][MAX_MOBILITY + 1];
+
+/**
+ * @brief The penalty of a king by the attack units counted around it.
+ *
+ * Every opposing piece which attacks the squares next to the king adds units for each such square (see
+ * Evaluation.c), the units grow the penalty slowly at first and then quickly, up to a ceiling.
+ */
+#define MAX_KING_ATTACK_UNITS 99
+extern const int KING_DANGER[MAX_KING_ATTACK_UNITS + 1];
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,452 @@
+/* iMate -- Copyright (C) 2024 Martin Newbound */
+
+#include "Tuning.h"
+#include "Evaluation.h"
+#include "EvaluationData.h"
+#include "../State/PackedPosition.h"
+#include "../Utils/BitOperations.h"
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// A feature is a piece of the position: its table square in bits 0-5, its type in bits 6-8 and bit 9 set for black
+#define FEATURE(PIECE, TABLE_SQUARE, COLOR) (uint16_t)((TABLE_SQUARE) | ((PIECE) << 6) | ((COLOR) << 9))
+#define FEATURE_SQUARE(FEATURE) ((FEATURE) & 63)
+#define FEATURE_PIECE(FEATURE) (((FEATURE) >> 6) & 7)
+#define FEATURE_SIGN(FEATURE) ((FEATURE) & (1 << 9) ? -1.0f : 1.0f)
+
+// Positions evaluated at a time by a worker, so the sigmoid runs over contiguous arrays
+#define TUNING_BLOCK_SIZE 256
+
+// Interval searched for the scale of the sigmoid, and the number of golden section steps
+#define MIN_TUNING_SCALE 0.05
+#define MAX_TUNING_SCALE 4.0
+#define TUNING_SCALE_STEPS 32
+
+// Adam optimizer
+#define ADAM_BETA1 0.9
+#define ADAM_BETA2 0.999
+#define ADAM_EPSILON 1e-8
+
+#define TUNING_PARAMETER_COUNT (sizeof(evaluation_parameters_t) / sizeof(float))
+
+/**
+ * @brief Positions stored as arrays: the features of position i are features[offsets[i]] to features[offsets[i + 1]].
+ */
+struct tuning_set {
+    size_t count;
+    size_t capacity;
+    float *phases;
+    float *results;
+    float *attack_scores;       // the untuned attack terms of each position, from white's point of view
+    uint32_t *offsets;
+
+    uint16_t *features;
+    size_t feature_capacity;
+};
+
+/**
+ * @brief The gradient of the error, laid out as evaluation_parameters_t.
+ */
+typedef struct {
+    double piece_weight[6];
+    double piece_square[6][2][64];
+} parameter_gradient_t;
+
+/**
+ * @brief The share of a pass over the positions done by one worker.
+ */
+typedef struct {
+    const tuning_set_t *set;
+    const evaluation_parameters_t *parameters;
+    double scale;                       // k scaled to the natural exponent of the sigmoid
+    size_t begin;
+    size_t end;
+
+    double error;                       // sum of the squared errors
+    parameter_gradient_t *gradient;     // receives the sums of the error terms per parameter, NULL if not needed
+} tuning_pass_t;
+
+static const char *PIECE_NAMES[6] = {"Pawn", "Rook", "Knight", "Bishop", "Queen", "King"};
+static const char *WEIGHT_NAMES[5] = {"PAWN", "ROOK", "KNIGHT", "BISHOP", "QUEEN"};
+
+tuning_set_t *new_tuning_set(void) {
+    tuning_set_t *set = calloc(1, sizeof(tuning_set_t));
+    set->offsets = calloc(1, sizeof(uint32_t));
+    return set;
+}
+
+void free_tuning_set(tuning_set_t *set) {
+    free(set->phases);
+    free(set->results);
+    free(set->attack_scores);
+    free(set->offsets);
+    free(set->features);
+    free(set);
+}
+
+size_t get_tuning_set_size(const tuning_set_t *set) {
+    return set->count;
+}
+
+void add_tuning_position(tuning_set_t *set, const state_t *state, float result) {
+    if (set->count == set->capacity) {
+        set->capacity = set->capacity ? set->capacity * 2 : 4096;
+        set->phases = realloc(set->phases, sizeof(float) * set->capacity);
+        set->results = realloc(set->results, sizeof(float) * set->capacity);
+        set->attack_scores = realloc(set->attack_scores, sizeof(float) * set->capacity);
+        set->offsets = realloc(set->offsets, sizeof(uint32_t) * (set->capacity + 1));
+    }
+
+    size_t feature_count = set->offsets[set->count];
+    if (feature_count + 64 > set->feature_capacity) {
+        set->feature_capacity = set->feature_capacity ? set->feature_capacity * 2 : 4096 * 32;
+        set->features = realloc(set->features, sizeof(uint16_t) * set->feature_capacity);
+    }
+
+    int piece_weight = 0;
+    for (color_t color = WHITE; color <= BLACK; color++) {
+        for (piece_t piece = PIECE_PAWN; piece <= PIECE_KING; piece++) {
+            uint64_t bitboard = get_state_peice_bitboard(state, piece, color);
+
+            while (bitboard) {
+                const int square = lsb_index(bitboard);
+                bitboard &= bitboard - 1;
+
+                if (piece != PIECE_KING) piece_weight += PIECE_WEIGHT[piece];
+                set->features[feature_count++] = FEATURE(piece, TABLE_SQUARE(square, color), color);
+            }
+        }
+    }
+
+    float phase = (float)piece_weight / (2.0f * STARTING_PIECE_WEIGHT);
+    if (phase > 1.0f) phase = 1.0f;
+
+    // The mobility and king danger terms are not tuned, so their share of the score is fixed with the phase
+    attack_info_t info;
+    int attack_weights[2];
+    compute_attack_info(state, &info);
+    get_attack_weights(state, &info, &DEFAULT_EVALUATION_PARAMS, attack_weights);
+
+    set->phases[set->count] = phase;
+    set->results[set->count] = result;
+    set->attack_scores[set->count] = phase * (float)attack_weights[0] + (1.0f - phase) * (float)attack_weights[1];
+    set->offsets[++set->count] = (uint32_t)feature_count;
+}
+
+/**
+ * @brief Adds the positions of a file of packed positions to a set.
+ */
+static long load_packed_tuning_positions(tuning_set_t *set, const char *path, long *skipped) {
+    packed_position_file_t *file = open_packed_positions(path);
+    if (file == NULL) return -1;
+
+    size_t count;
+    const packed_position_t *positions = get_packed_positions(file, &count);
+    state_t *state = new_state();
+    long added = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        if (!unpack_position(&positions[i], state)) continue;
+
+        add_tuning_position(set, state, positions[i].result / 2.0f);
+        added++;
+    }
+
+    free_state(state);
+    close_packed_positions(file);
+
+    if (skipped != NULL) *skipped = (long)count - added;
+    return added;
+}
+
+long load_tuning_positions(tuning_set_t *set, const char *path, long *skipped) {
+    const size_t length = strlen(path), extension_length = strlen(PACKED_POSITIONS_EXTENSION);
+    if (length > extension_length && strcmp(path + length - extension_length, PACKED_POSITIONS_EXTENSION) == 0) {
+        return load_packed_tuning_positions(set, path, skipped);
+    }
+
+    FILE *file = fopen(path, "r");
+    if (file == NULL) return -1;
+
+    state_t *state = new_state();
+    char *line = NULL;
+    size_t line_capacity = 0;
+    long added = 0;
+    long rejected = 0;
+
+    while (getline(&line, &line_capacity, file) != -1) {
+        int result;
+        if (!parse_labeled_position(line, state, &result)) {
+            rejected++;
+            continue;
+        }
+
+        add_tuning_position(set, state, result / 2.0f);
+        added++;
+    }
+
+    free(line);
+    free_state(state);
+    fclose(file);
+
+    if (skipped != NULL) *skipped = rejected;
+    return added;
+}
+
+void get_evaluation_parameters(evaluation_parameters_t *parameters) {
+    memset(parameters, 0, sizeof(evaluation_parameters_t));
+
+    for (piece_t piece = PIECE_PAWN; piece <= PIECE_KING; piece++) {
+        if (piece != PIECE_KING) parameters->piece_weight[piece] = (float)PIECE_WEIGHT[piece];
+
+        for (int phase = 0; phase < 2; phase++) {
+            for (int square = 0; square < 64; square++) {
+                parameters->piece_square[piece][phase][square] = (float)PIECE_SQUARE_TABLES[piece][phase][square];
+            }
+        }
+    }
+}
+
+/**
+ * @brief Evaluates the positions of a share of a pass, summing their squared errors and their gradient.
+ *
+ * @param argument The share of the pass.
+ * @param worker_index Unused.
+ */
+static void run_tuning_pass(void *argument, int worker_index) {
+    (void)worker_index;
+    tuning_pass_t *pass = argument;
+    const tuning_set_t *set = pass->set;
+    const evaluation_parameters_t *parameters = pass->parameters;
+    const float scale = (float)pass->scale;
+
+    float evaluations[TUNING_BLOCK_SIZE];
+    float terms[TUNING_BLOCK_SIZE];
+    double error = 0.0;
+
+    for (size_t block = pass->begin; block < pass->end; block += TUNING_BLOCK_SIZE) {
+        const size_t count = pass->end - block < TUNING_BLOCK_SIZE ? pass->end - block : TUNING_BLOCK_SIZE;
+
+        // Evaluations from white's point of view, as in evaluate_state: the tuned terms plus the fixed attack terms
+        for (size_t i = 0; i < count; i++) {
+            const float phase = set->phases[block + i];
+            float evaluation = set->attack_scores[block + i];
+
+            for (uint32_t f = set->offsets[block + i]; f < set->offsets[block + i + 1]; f++) {
+                const uint16_t feature = set->features[f];
+                const int piece = FEATURE_PIECE(feature);
+                const int square = FEATURE_SQUARE(feature);
+
+                evaluation += FEATURE_SIGN(feature) * (parameters->piece_weight[piece]
+                    + phase * parameters->piece_square[piece][0][square]
+                    + (1.0f - phase) * parameters->piece_square[piece][1][square]);
+            }
+
+            evaluations[i] = evaluation;
+        }
+
+        // Error of each position and the derivative of its squared error with respect to its evaluation (up to a factor)
+        const float *results = set->results + block;
+        for (size_t i = 0; i < count; i++) {
+            const float sigmoid = 1.0f / (1.0f + expf(-scale * evaluations[i]));
+            const float difference = results[i] - sigmoid;
+            error += difference * difference;
+            terms[i] = difference * sigmoid * (1.0f - sigmoid);
+        }
+
+        if (pass->gradient == NULL) continue;
+
+        parameter_gradient_t *gradient = pass->gradient;
+        for (size_t i = 0; i < count; i++) {
+            const float phase = set->phases[block + i];
+
+            for (uint32_t f = set->offsets[block + i]; f < set->offsets[block + i + 1]; f++) {
+                const uint16_t feature = set->features[f];
+                const int piece = FEATURE_PIECE(feature);
+                const int square = FEATURE_SQUARE(feature);
+                const double term = FEATURE_SIGN(feature) * terms[i];
+
+                if (piece != PIECE_KING) gradient->piece_weight[piece] += term;
+                gradient->piece_square[piece][0][square] += term * phase;
+                gradient->piece_square[piece][1][square] += term * (1.0f - phase);
+            }
+        }
+    }
+
+    pass->error = error;
+}
+
+/**
+ * @brief Runs a pass over all the positions, split among the workers.
+ *
+ * @param gradient Receives the gradient of the mean squared error, may be NULL.
+ * @return The mean squared error.
+ */
+static double run_tuning_passes(const tuning_set_t *set, const evaluation_parameters_t *parameters, double k,
+                                thread_pool_t *pool, parameter_gradient_t *gradient) {
+    if (set->count == 0) return 0.0;
+
+    const int worker_count = get_thread_pool_size(pool);
+    tuning_pass_t *passes = calloc((size_t)worker_count, sizeof(tuning_pass_t));
+    const double scale = k * log(10.0) / 400.0;
+
+    for (int i = 0; i < worker_count; i++) {
+        passes[i] = (tuning_pass_t){
+            .set = set,
+            .parameters = parameters,
+            .scale = scale,
+            .begin = set->count * (size_t)i / (size_t)worker_count,
+            .end = set->count * (size_t)(i + 1) / (size_t)worker_count,
+            .gradient = gradient != NULL ? calloc(1, sizeof(parameter_gradient_t)) : NULL
+        };
+        submit_thread_pool_task(pool, run_tuning_pass, &passes[i]);
+    }
+
+    wait_thread_pool(pool);
+
+    double error = 0.0;
+    if (gradient != NULL) memset(gradient, 0, sizeof(parameter_gradient_t));
+
+    for (int i = 0; i < worker_count; i++) {
+        error += passes[i].error;
+        if (gradient == NULL) continue;
+
+        // d(error)/d(evaluation) = -2 * scale * (result - sigmoid) * sigmoid * (1 - sigmoid), averaged over the positions
+        const double *sums = (const double *)passes[i].gradient;
+        double *total = (double *)gradient;
+        for (size_t p = 0; p < TUNING_PARAMETER_COUNT; p++) total[p] -= 2.0 * scale * sums[p] / (double)set->count;
+        free(passes[i].gradient);
+    }
+
+    free(passes);
+    return error / (double)set->count;
+}
+
+double compute_tuning_error(const tuning_set_t *set, const evaluation_parameters_t *parameters, double k, thread_pool_t *pool) {
+    return run_tuning_passes(set, parameters, k, pool, NULL);
+}
+
+double find_tuning_scale(const tuning_set_t *set, const evaluation_parameters_t *parameters, thread_pool_t *pool) {
+    // Golden section search, the error is unimodal in k
+    const double ratio = (sqrt(5.0) - 1.0) / 2.0;
+    double low = MIN_TUNING_SCALE, high = MAX_TUNING_SCALE;
+    double left = high - ratio * (high - low), right = low + ratio * (high - low);
+    double left_error = compute_tuning_error(set, parameters, left, pool);
+    double right_error = compute_tuning_error(set, parameters, right, pool);
+
+    for (int step = 0; step < TUNING_SCALE_STEPS; step++) {
+        if (left_error < right_error) {
+            high = right;
+            right = left;
+            right_error = left_error;
+            left = high - ratio * (high - low);
+            left_error = compute_tuning_error(set, parameters, left, pool);
+        } else {
+            low = left;
+            left = right;
+            left_error = right_error;
+            right = low + ratio * (high - low);
+            right_error = compute_tuning_error(set, parameters, right, pool);
+        }
+    }
+
+    return (low + high) / 2.0;
+}
+
+double tune_evaluation(const tuning_set_t *set, evaluation_parameters_t *parameters, double k, int epochs,
+                       double learning_rate, thread_pool_t *pool, tuning_progress_t progress, void *context) {
+    parameter_gradient_t *gradient = malloc(sizeof(parameter_gradient_t));
+    double *moments = calloc(2 * TUNING_PARAMETER_COUNT, sizeof(double));
+    double *velocities = moments + TUNING_PARAMETER_COUNT;
+    float *values = (float *)parameters;
+    const double *gradients = (const double *)gradient;
+
+    for (int epoch = 1; epoch <= epochs; epoch++) {
+        const double error = run_tuning_passes(set, parameters, k, pool, gradient);
+
+        const double moment_correction = 1.0 - pow(ADAM_BETA1, epoch);
+        const double velocity_correction = 1.0 - pow(ADAM_BETA2, epoch);
+
+        for (size_t p = 0; p < TUNING_PARAMETER_COUNT; p++) {
+            moments[p] = ADAM_BETA1 * moments[p] + (1.0 - ADAM_BETA1) * gradients[p];
+            velocities[p] = ADAM_BETA2 * velocities[p] + (1.0 - ADAM_BETA2) * gradients[p] * gradients[p];
+
+            const double moment = moments[p] / moment_correction;
+            const double velocity = velocities[p] / velocity_correction;
+            values[p] -= (float)(learning_rate * moment / (sqrt(velocity) + ADAM_EPSILON));
+        }
+
+        if (progress != NULL) progress(context, epoch, error);
+    }
+
+    free(moments);
+    free(gradient);
+    return compute_tuning_error(set, parameters, k, pool);
+}
+
+bool write_evaluation_data(const char *path, const evaluation_parameters_t *parameters) {
+    FILE *file = fopen(path, "w");
+    if (file == NULL) return false;
+
+    int weights[5];
+    for (int piece = 0; piece < 5; piece++) weights[piece] = (int)lroundf(parameters->piece_weight[piece]);
+
+    fprintf(file, "/* iMate -- Copyright (C) 2024 Martin Newbound */\n\n");
+    fprintf(file, "#include \"EvaluationData.h\"\n\n");
+    fprintf(file, "const int PIECE_WEIGHT[5] = {\n");
+    for (int piece = 0; piece < 5; piece++) fprintf(file, "    %d,    // %s\n", weights[piece], WEIGHT_NAMES[piece]);
+    fprintf(file, "};\n\n");
+
+    fprintf(file, "const int STARTING_PIECE_WEIGHT = \n");
+    fprintf(file, "    %d * 8 +\n    %d * 2 +\n    %d * 2 +\n    %d * 2 +\n    %d * 1;\n\n",
+            weights[PIECE_PAWN], weights[PIECE_KNIGHT], weights[PIECE_BISHOP], weights[PIECE_ROOK], weights[PIECE_QUEEN]);
+
+    fprintf(file, "const int PIECE_SQUARE_TABLES[6][2][64] = {\n");
+    for (int piece = 0; piece < 6; piece++) {
+        fprintf(file, "    { // %s Tables\n", PIECE_NAMES[piece]);
+
+        for (int phase = 0; phase < 2; phase++) {
+            fprintf(file, "        { // %s Game %s Table\n", phase == 0 ? "Mid" : "End", PIECE_NAMES[piece]);
+            for (int rank = 0; rank < 8; rank++) {
+                fprintf(file, "           ");
+                for (int file_index = 0; file_index < 8; file_index++) {
+                    fprintf(file, " %4ld,", lroundf(parameters->piece_square[piece][phase][rank * 8 + file_index]));
+                }
+                fprintf(file, "\n");
+            }
+            fprintf(file, "        }%s\n", phase == 0 ? "," : "");
+        }
+
+        fprintf(file, "    }%s\n", piece < 5 ? ",\n" : "");
+    }
+    fprintf(file, "};\n");
+
+    // The attack tables are not tuned, they are written as they are
+    fprintf(file, "\nconst int MOBILITY_TABLES[4][2][MAX_MOBILITY + 1] = {\n");
+    for (int table = 0; table < 4; table++) {
+        fprintf(file, "    { // %s Mobility\n", PIECE_NAMES[PIECE_ROOK + table]);
+
+        for (int phase = 0; phase < 2; phase++) {
+            fprintf(file, "        { // %s Game %s Mobility\n", phase == 0 ? "Mid" : "End", PIECE_NAMES[PIECE_ROOK + table]);
+            for (int count = 0; count <= MAX_MOBILITY; count++) {
+                fprintf(file, "%s %4d,%s", count % 14 == 0 ? "           " : "", MOBILITY_TABLES[table][phase][count],
+                        count % 14 == 13 ? "\n" : "");
+            }
+            fprintf(file, "        }%s\n", phase == 0 ? "," : "");
+        }
+
+        fprintf(file, "    }%s\n", table < 3 ? "," : "");
+    }
+    fprintf(file, "};\n\n");
+
+    fprintf(file, "const int KING_DANGER[MAX_KING_ATTACK_UNITS + 1] = {\n");
+    for (int units = 0; units <= MAX_KING_ATTACK_UNITS; units++) {
+        fprintf(file, "%s %3d,%s", units % 10 == 0 ? "   " : "", KING_DANGER[units], units % 10 == 9 ? "\n" : "");
+    }
+    fprintf(file, "};\n");
+
+    return fclose(file) == 0;
+}
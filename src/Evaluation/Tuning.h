@@ -0,0 +1,166 @@
+/* iMate -- Copyright (C) 2024 Martin Newbound */
+
+/**
+ * @file Tuning.h
+ * @brief This file contains the declarations of the Texel tuner of the evaluation data.
+ *
+ * @details The evaluation is linear in PIECE_WEIGHT and PIECE_SQUARE_TABLES once the game phase of a position is
+ * fixed, so each position is reduced once to its phase, its result and one 16 bit feature per piece (piece type,
+ * table square and color). The tuner then minimizes the mean squared error between the game results and
+ * sigmoid(k * evaluation) by full batch gradient descent (Adam), every pass over the positions being split among
+ * the workers of a thread pool and processed in blocks whose sigmoid step runs over contiguous arrays.
+ *
+ * The phase is computed with the current weights and kept while tuning: it is the only non linear part of the
+ * evaluation and moves little with the weights. The mobility and king danger tables are not tuned: their share of
+ * the score of each position is computed once when the position is added and included in every evaluation, so the
+ * tuned terms are fitted next to them, and the output keeps them as they are.
+ *
+ * @version 1.0.0
+ * @author Martin Newbound
+ * @date 2024
+ *
+ * @note License:
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef TUNING_H
+#define TUNING_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "../State/GameState.h"
+#include "../Threads/ThreadPool.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @brief The tunable evaluation data, laid out as PIECE_WEIGHT and PIECE_SQUARE_TABLES.
+ *
+ * The king has no weight, piece_weight[PIECE_KING] is always 0.
+ */
+typedef struct {
+    float piece_weight[6];
+    float piece_square[6][2][64];
+} evaluation_parameters_t;
+
+// Labeled positions reduced to their evaluation features
+typedef struct tuning_set tuning_set_t;
+
+/**
+ * Creates an empty set of positions.
+ *
+ * @return A pointer to the new set.
+ *
+ * @warning The caller is responsible for freeing the set with free_tuning_set.
+ */
+tuning_set_t *new_tuning_set(void);
+
+/**
+ * Frees a set of positions.
+ *
+ * @param set The set to free.
+ */
+void free_tuning_set(tuning_set_t *set);
+
+/**
+ * Adds a position to a set, computing its game phase and the score of its untuned attack terms.
+ *
+ * @param set The set.
+ * @param state The position, best quiet so the evaluation describes it.
+ * @param result The result of the game the position comes from, from white's point of view (1, 0.5 or 0).
+ */
+void add_tuning_position(tuning_set_t *set, const state_t *state, float result);
+
+/**
+ * Adds the positions of a file to a set.
+ *
+ * Files named with PACKED_POSITIONS_EXTENSION hold packed positions. Other files hold one labeled position per
+ * line, in the text format read by parse_labeled_position, and lines which are not are skipped.
+ *
+ * @param set The set.
+ * @param path The file to read.
+ * @param[out] skipped Receives the number of lines skipped, may be NULL.
+ * @return The number of positions added, or -1 if the file cannot be read.
+ */
+long load_tuning_positions(tuning_set_t *set, const char *path, long *skipped);
+
+/**
+ * Returns the number of positions of a set.
+ *
+ * @param set The set.
+ * @return The number of positions.
+ */
+size_t get_tuning_set_size(const tuning_set_t *set);
+
+/**
+ * Copies the engine's evaluation data.
+ *
+ * @param[out] parameters Receives PIECE_WEIGHT and PIECE_SQUARE_TABLES.
+ */
+void get_evaluation_parameters(evaluation_parameters_t *parameters);
+
+/**
+ * Computes the mean squared error of the evaluation on a set.
+ *
+ * @param set The positions.
+ * @param parameters The evaluation data.
+ * @param k The scale of the sigmoid: the expected score of an evaluation e is 1 / (1 + 10^(-k * e / 400)).
+ * @param pool The workers sharing the positions.
+ * @return The mean squared error.
+ */
+double compute_tuning_error(const tuning_set_t *set, const evaluation_parameters_t *parameters, double k, thread_pool_t *pool);
+
+/**
+ * Finds the scale of the sigmoid which fits the evaluation best, so tuning does not change the scale of the scores.
+ *
+ * @param set The positions.
+ * @param parameters The evaluation data.
+ * @param pool The workers sharing the positions.
+ * @return The scale with the lowest error.
+ */
+double find_tuning_scale(const tuning_set_t *set, const evaluation_parameters_t *parameters, thread_pool_t *pool);
+
+/**
+ * Called after every epoch of tuning.
+ *
+ * @param context The context given to tune_evaluation.
+ * @param epoch The number of epochs done.
+ * @param error The mean squared error before the epoch's step.
+ */
+typedef void (*tuning_progress_t)(void *context, int epoch, double error);
+
+/**
+ * Tunes the evaluation data by gradient descent.
+ *
+ * @param set The positions.
+ * @param[in,out] parameters The evaluation data to start from, receives the tuned data.
+ * @param k The scale of the sigmoid.
+ * @param epochs The number of passes over the positions.
+ * @param learning_rate The step of the optimizer, in centipawns.
+ * @param pool The workers sharing the positions.
+ * @param progress Called after every epoch, may be NULL.
+ * @param context Passed to progress.
+ * @return The final mean squared error.
+ */
+double tune_evaluation(const tuning_set_t *set, evaluation_parameters_t *parameters, double k, int epochs,
+                       double learning_rate, thread_pool_t *pool, tuning_progress_t progress, void *context);
+
+/**
+ * Writes evaluation data as a replacement for EvaluationData.c, the values rounded to integers.
+ *
+ * @param path The file to write.
+ * @param parameters The evaluation data.
+ * @return true if the file was written.
+ */
+bool write_evaluation_data(const char *path, const evaluation_parameters_t *parameters);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TUNING_H
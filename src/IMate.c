@@ -1,79 +1,138 @@
 #include "IMate.h"
 #include "State/GameState.h"
+#include "State/GameHistory.h"
+#include "State/Zobrist.h"
+#include "Moves/SliderAttacks.h"
+#include "Search/SearchThread.h"
+#include "Search/TranspositionTable.h"
+#include "Search/SearchTrace.h"
 #include "Commands/Commands.h"
-#include <regex.h>
 #include <stdio.h>
 #include <string.h>
-#include <ctype.h>
 #include <stdbool.h>
 #include <stdlib.h>
 
-#define INPUT_BUFFER 100
-
 typedef struct {
     state_t* game_state;
+    game_history_t* game_history;
+    search_thread_t* search_thread;
     bool is_running;
 } EngineState;
 
-
-void remove_whitespace(char* input) {
-    char const* read_ptr = input;
-    char* write_ptr = input;
-    while (*read_ptr) {
-        if (!isspace(*read_ptr))
-            *write_ptr++ = *read_ptr;
-        read_ptr++;
+// The line buffer and token array are reused for every command, so reading a command never allocates
+static char user_input[COMMAND_BUFFER_SIZE];
+static char *tokens[MAX_COMMAND_TOKENS];
+
+
+/**
+ * @brief Reads one line of input into the line buffer.
+ *
+ * A line longer than the buffer is discarded (with a warning) rather than split into several commands.
+ *
+ * @return false once the input is exhausted.
+ */
+bool read_command_line() {
+    while (fgets(user_input, sizeof(user_input), stdin) != NULL) {
+        size_t length = strlen(user_input);
+        if (length < sizeof(user_input) - 1 || user_input[length - 1] == '\n') return true;
+
+        int c;
+        while ((c = getchar()) != EOF && c != '\n');
+        printf("info string command longer than %d characters ignored\n", COMMAND_BUFFER_SIZE - 1);
     }
 
-    *write_ptr = '\0';
+    return false;
 }
 
 
-void engine_loop() {
-    regex_t regex;
-    char user_input[INPUT_BUFFER];
-    regmatch_t matches[MAX_MATCHES];
-
-    printf("Tip: Type \"help\" to see a list of commands \n");
+/**
+ * @brief Creates the engine's state, set up on the starting position.
+ *
+ * @return The engine state, free it with free_engine_state.
+ */
+static EngineState new_engine_state() {
+    init_zobrist_keys();
+    init_slider_attacks();
+    init_command_table();
+#ifdef SEARCH_TRACE
+    init_search_trace();
+#endif
 
     EngineState engine_state = {
         .game_state = new_state(),
+        .game_history = new_game_history(),
+        .search_thread = new_search_thread(DEFAULT_HASH_SIZE_MB),
         .is_running = true
     };
 
-    while (engine_state.is_running) {
-        fgets(user_input, sizeof(user_input), stdin);
-        remove_whitespace(user_input);
-
-        for (size_t i = 0; i < length_of_engine_commands(); i++) {
-            regcomp(&regex, ENGINE_COMMANDS[i].regex, REG_EXTENDED);
-
-            if (!regexec(&regex, user_input, 1, matches, 0)) {
-                CommandParams cmd_params = {
-                    .engine_is_running = &engine_state.is_running,
-                    .engine_game_state = engine_state.game_state,
-                    .user_input = user_input,
-                    .matches = matches,
-                };
-
-                for (int j = 0; j < MAX_MATCHES && matches[j].rm_so != -1; j++) {
-                    int start = matches[j].rm_so;
-                    int end = matches[j].rm_eo;
-                    cmd_params.matches[j] = strndup(user_input + start, end - start);
-                }
-
-                ENGINE_COMMANDS[i].func(cmd_params);
-                printf("\n");
-                regfree(&regex);
-
-                for (int j = 0; j < MAX_MATCHES && cmd_params.matches[j]; j++) free(cmd_params.matches[j]);
-                
-                break;
-            }
-
-            regfree(&regex);
-        }
+    load_fen_string(engine_state.game_state, START_FEN);
+    reset_game_history(engine_state.game_history, START_FEN, engine_state.game_state);
+    return engine_state;
+}
+
+
+/**
+ * @brief Frees everything owned by the engine state, stopping a running search first.
+ *
+ * @param engine_state The engine state to free.
+ */
+static void free_engine_state(EngineState *engine_state) {
+    free_search_thread(engine_state->search_thread);
+    free_game_history(engine_state->game_history);
+    free_state(engine_state->game_state);
+}
+
+
+/**
+ * @brief Looks up and runs the command held in a list of tokens.
+ *
+ * @param engine_state The engine state the command acts on.
+ * @param command_tokens The tokens of the command, the first one being its name.
+ * @param token_count The number of tokens.
+ */
+static void execute_command(EngineState *engine_state, char **command_tokens, int token_count) {
+    const Command *command = find_engine_command(command_tokens[0]);
+    if (command == NULL || token_count - 1 < command->min_arguments) return;
+
+    CommandParams cmd_params = {
+        .tokens = command_tokens,
+        .token_count = token_count,
+        .engine_is_running = &engine_state->is_running,
+        .engine_game_state = engine_state->game_state,
+        .engine_game_history = engine_state->game_history,
+        .engine_search_thread = engine_state->search_thread,
+    };
+
+    command->func(cmd_params);
+}
+
+
+void engine_loop() {
+    setvbuf(stdout, NULL, _IOLBF, 0);
+
+    printf("Tip: Type \"help\" to see a list of commands \n");
+
+    EngineState engine_state = new_engine_state();
+
+    while (engine_state.is_running && read_command_line()) {
+        int token_count = tokenize_command_line(user_input, tokens, MAX_COMMAND_TOKENS);
+        if (token_count == 0) continue;
+
+        execute_command(&engine_state, tokens, token_count);
+        printf("\n");
     }   // while engine_state.is_running
 
-    free_state(engine_state.game_state);
-}
\ No newline at end of file
+    free_engine_state(&engine_state);
+}
+
+
+void engine_run_arguments(int argc, char **argv) {
+    setvbuf(stdout, NULL, _IOLBF, 0);
+
+    EngineState engine_state = new_engine_state();
+
+    execute_command(&engine_state, argv, argc);
+    wait_search_thread(engine_state.search_thread);
+
+    free_engine_state(&engine_state);
+}
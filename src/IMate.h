@@ -46,6 +46,18 @@ extern "C" {
  */
 void engine_loop(void);
 
+/**
+ * @brief Runs a single engine command given on the command line, e.g. "iMateC epd wac.epd nodes 100000".
+ * 
+ * @details
+ * The arguments are handled exactly like a line typed into engine_loop. The function returns once the command,
+ * including a search it started, has finished.
+ * 
+ * @param argc The number of arguments, the first one being the command's name.
+ * @param argv The arguments.
+ */
+void engine_run_arguments(int argc, char **argv);
+
 #ifdef __cplusplus
 }
 #endif
@@ -21,7 +21,13 @@
 #include "IMate.h"
 #include <stdio.h>
 
-int main() {
+int main(int argc, char **argv) {
+    // A command given on the command line runs without the banner, so its output can be processed by scripts
+    if (argc > 1) {
+        engine_run_arguments(argc - 1, argv + 1);
+        return 0;
+    }
+
     printf( 
         "______________________________________________________________________\n"
         "                                                                      \n"
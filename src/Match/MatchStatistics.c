@@ -0,0 +1,99 @@
+/* iMate -- Copyright (C) 2024 Martin Newbound */
+
+#include "MatchStatistics.h"
+#include <math.h>
+#include <stdbool.h>
+
+// Quantile of the normal distribution for a two sided 95% confidence interval
+#define NORMAL_QUANTILE_95 1.959964
+
+// Pseudo games added to each outcome the test has not seen yet, without which its variance would vanish
+#define SPRT_PSEUDO_GAMES 0.5
+
+/**
+ * @brief Converts an expected score to an Elo difference.
+ */
+static double score_to_elo(double score) {
+    return -400.0 * log10(1.0 / score - 1.0);
+}
+
+/**
+ * @brief Converts an Elo difference to an expected score.
+ */
+static double elo_to_score(double elo) {
+    return 1.0 / (1.0 + pow(10.0, -elo / 400.0));
+}
+
+/**
+ * @brief Computes the mean score per game and the variance of a single game's score.
+ *
+ * @param pseudo_games Added to each of the wins, draws and losses when one of them is missing, so a one sided
+ *                     score keeps a variance.
+ * @return false if no game has been played.
+ */
+static bool get_score_moments(const match_score_t *score, double pseudo_games, double *mean, double *variance) {
+    if (score->wins + score->draws + score->losses == 0) return false;
+    if (score->wins && score->draws && score->losses) pseudo_games = 0.0;
+
+    const double wins = score->wins + pseudo_games;
+    const double draws = score->draws + pseudo_games;
+    const double losses = score->losses + pseudo_games;
+    const double games = wins + draws + losses;
+
+    *mean = (wins + draws / 2.0) / games;
+    *variance = (wins * pow(1.0 - *mean, 2.0) + draws * pow(0.5 - *mean, 2.0) + losses * pow(*mean, 2.0)) / games;
+    return true;
+}
+
+/**
+ * @brief Clamps a score away from 0 and 1, whose Elo differences are infinite.
+ */
+static double clamp_score(double score) {
+    return fmin(fmax(score, 1e-6), 1.0 - 1e-6);
+}
+
+double compute_match_elo(const match_score_t *score, double *error) {
+    double mean, variance;
+    *error = 0.0;
+    if (!get_score_moments(score, 0.0, &mean, &variance)) return 0.0;
+
+    // The interval is computed on the score and converted to Elo
+    const double games = score->wins + score->draws + score->losses;
+    const double margin = NORMAL_QUANTILE_95 * sqrt(variance / games);
+
+    *error = (score_to_elo(clamp_score(mean + margin)) - score_to_elo(clamp_score(mean - margin))) / 2.0;
+    return score_to_elo(clamp_score(mean));
+}
+
+double compute_match_los(const match_score_t *score) {
+    const double decisive = score->wins + score->losses;
+    if (decisive == 0) return 0.5;
+
+    return 0.5 * (1.0 + erf((score->wins - score->losses) / sqrt(2.0 * decisive)));
+}
+
+double compute_sprt_llr(const match_score_t *score, const sprt_t *sprt) {
+    double mean, variance;
+    if (!get_score_moments(score, SPRT_PSEUDO_GAMES, &mean, &variance)) return 0.0;
+
+    const double games = score->wins + score->draws + score->losses;
+    const double score0 = elo_to_score(sprt->elo0);
+    const double score1 = elo_to_score(sprt->elo1);
+
+    return games * (score1 - score0) * (2.0 * mean - score0 - score1) / (2.0 * variance);
+}
+
+void get_sprt_bounds(const sprt_t *sprt, double *lower, double *upper) {
+    *lower = log(sprt->beta / (1.0 - sprt->alpha));
+    *upper = log((1.0 - sprt->beta) / sprt->alpha);
+}
+
+sprt_verdict_t get_sprt_verdict(const match_score_t *score, const sprt_t *sprt) {
+    double lower, upper;
+    get_sprt_bounds(sprt, &lower, &upper);
+
+    const double llr = compute_sprt_llr(score, sprt);
+    if (llr >= upper) return SPRT_ACCEPT_H1;
+    if (llr <= lower) return SPRT_ACCEPT_H0;
+    return SPRT_CONTINUE;
+}
@@ -0,0 +1,104 @@
+/* iMate -- Copyright (C) 2024 Martin Newbound */
+
+/**
+ * @file MatchStatistics.h
+ * @brief This file contains the declarations of the statistics computed from the results of a match.
+ *
+ * @details The Elo difference is derived from the score with the logistic model, and its 95% error bar from the
+ * variance of the game results. The sequential probability ratio test (SPRT) decides between the hypotheses
+ * "the first player is elo0 stronger" (H0) and "the first player is elo1 stronger" (H1) with the
+ * generalized SPRT approximation of the log likelihood ratio, which lets a match stop as soon as the games
+ * played are conclusive.
+ *
+ * @version 1.0.0
+ * @author Martin Newbound
+ * @date 2024
+ *
+ * @note License:
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef MATCH_STATISTICS_H
+#define MATCH_STATISTICS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief The results of a match, from the point of view of the first player.
+ */
+typedef struct {
+    int wins;
+    int draws;
+    int losses;
+} match_score_t;
+
+/**
+ * @brief The parameters of a sequential probability ratio test.
+ */
+typedef struct {
+    double elo0;
+    double elo1;
+    double alpha;   // probability of accepting H1 when H0 holds
+    double beta;    // probability of accepting H0 when H1 holds
+} sprt_t;
+
+typedef enum {
+    SPRT_CONTINUE,
+    SPRT_ACCEPT_H0,
+    SPRT_ACCEPT_H1
+} sprt_verdict_t;
+
+/**
+ * Computes the Elo difference of the first player and its 95% error bar.
+ *
+ * @param score The results of the match.
+ * @param[out] error Receives the half width of the 95% confidence interval, in Elo.
+ * @return The Elo difference, 0 when no game has been played.
+ */
+double compute_match_elo(const match_score_t *score, double *error);
+
+/**
+ * Computes the likelihood of superiority: the probability that the first player is the stronger one.
+ *
+ * @param score The results of the match.
+ * @return The probability, between 0 and 1.
+ */
+double compute_match_los(const match_score_t *score);
+
+/**
+ * Computes the log likelihood ratio of H1 against H0.
+ *
+ * @param score The results of the match.
+ * @param sprt The parameters of the test.
+ * @return The log likelihood ratio, 0 while the results carry no information.
+ */
+double compute_sprt_llr(const match_score_t *score, const sprt_t *sprt);
+
+/**
+ * Returns the log likelihood ratios at which the test accepts H0 and H1.
+ *
+ * @param sprt The parameters of the test.
+ * @param[out] lower The ratio below which H0 is accepted.
+ * @param[out] upper The ratio above which H1 is accepted.
+ */
+void get_sprt_bounds(const sprt_t *sprt, double *lower, double *upper);
+
+/**
+ * Decides the test from the results of a match.
+ *
+ * @param score The results of the match.
+ * @param sprt The parameters of the test.
+ * @return The verdict.
+ */
+sprt_verdict_t get_sprt_verdict(const match_score_t *score, const sprt_t *sprt);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MATCH_STATISTICS_H
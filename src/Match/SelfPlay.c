@@ -0,0 +1,195 @@
+/* iMate -- Copyright (C) 2024 Martin Newbound */
+
+#include "SelfPlay.h"
+#include "../Moves/MoveGeneration.h"
+#include "../Utils/BitOperations.h"
+#include <stdlib.h>
+
+// A game is won once both players have scored it beyond this margin for ADJUDICATION_WIN_PLIES half moves in a row
+#define ADJUDICATION_WIN_SCORE 1000
+#define ADJUDICATION_WIN_PLIES 8
+
+// After ADJUDICATION_DRAW_START half moves, a game both players score within this margin for long enough is drawn
+#define ADJUDICATION_DRAW_SCORE 10
+#define ADJUDICATION_DRAW_PLIES 12
+#define ADJUDICATION_DRAW_START 80
+
+static const char *GAME_END_NAMES[] = {
+    "checkmate",
+    "stalemate",
+    "fifty moves",
+    "repetition",
+    "insufficient material",
+    "time forfeit",
+    "adjudication",
+    "maximum length"
+};
+
+const char *get_game_end_name(game_end_t end) {
+    return GAME_END_NAMES[end];
+}
+
+/**
+ * @brief Checks whether neither side has the material to ever deliver checkmate.
+ *
+ * Only bare kings and a king with a single minor piece against a bare king are recognised.
+ *
+ * @param state The game state.
+ * @return true if the position is a dead draw.
+ */
+static bool is_insufficient_material(const state_t *state) {
+    int minor_pieces = 0;
+
+    for (color_t color = WHITE; color <= BLACK; color++) {
+        if (get_state_peice_bitboard(state, PIECE_PAWN, color) | get_state_peice_bitboard(state, PIECE_ROOK, color)
+            | get_state_peice_bitboard(state, PIECE_QUEEN, color)) return false;
+
+        minor_pieces += popcount(get_state_peice_bitboard(state, PIECE_KNIGHT, color)
+                                           | get_state_peice_bitboard(state, PIECE_BISHOP, color));
+    }
+
+    return minor_pieces <= 1;
+}
+
+/**
+ * @brief Checks whether the current position of the game occurs for the third time.
+ *
+ * @param state The current position.
+ * @param keys The keys of the positions of the game, the last one being the current position.
+ * @param key_count The number of keys.
+ * @return true if the position occurred twice before.
+ */
+static bool is_threefold_repetition(const state_t *state, const uint64_t *keys, int key_count) {
+    const int current = key_count - 1;
+    const int half_moves = get_state_half_move_count(state);
+    const int oldest = half_moves < current ? current - half_moves : 0;
+    int repetitions = 0;
+
+    for (int i = current - 4; i >= oldest; i -= 2) {
+        if (keys[i] == keys[current] && ++repetitions == 2) return true;
+    }
+
+    return false;
+}
+
+/**
+ * @brief Checks whether the game has ended by the rules.
+ *
+ * @param state The current position.
+ * @param keys The keys of the positions of the game, the last one being the current position.
+ * @param key_count The number of keys.
+ * @param[out] result Receives the result when the game has ended.
+ * @param[out] end Receives how the game ended.
+ * @return true if the game has ended.
+ */
+static bool is_game_over(const state_t *state, const uint64_t *keys, int key_count, game_result_t *result, game_end_t *end) {
+    move_collection_t *moves = get_legal_moves_of_state(state);
+    move_t *move = pop_collection_head(moves);
+    const bool has_legal_move = move != NULL;
+    if (move != NULL) free_move(move);
+    free_move_collection(moves);
+
+    const color_t color = get_state_to_move_color(state);
+    if (!has_legal_move) {
+        const bool in_check = is_check(state, color);
+        *result = !in_check ? GAME_DRAW : (color == WHITE ? GAME_BLACK_WINS : GAME_WHITE_WINS);
+        *end = in_check ? GAME_END_CHECKMATE : GAME_END_STALEMATE;
+        return true;
+    }
+
+    *result = GAME_DRAW;
+    if (get_state_half_move_count(state) >= FIFTY_MOVE_RULE_PLIES) *end = GAME_END_FIFTY_MOVES;
+    else if (is_threefold_repetition(state, keys, key_count)) *end = GAME_END_REPETITION;
+    else if (is_insufficient_material(state)) *end = GAME_END_INSUFFICIENT_MATERIAL;
+    else return false;
+
+    return true;
+}
+
+/**
+ * @brief Prepares a player for a new game.
+ */
+static void start_player_game(selfplay_player_t *player) {
+    clear_transposition_table(player->table);
+    clear_search_heuristics(player->search);
+    reset_search_stop(player->search);
+    set_search_params(player->search, &player->params);
+}
+
+game_result_t play_selfplay_game(const state_t *opening, selfplay_player_t *white, selfplay_player_t *black,
+                                 selfplay_move_callback_t on_move, void *context, game_end_t *end) {
+    selfplay_player_t *players[2] = {white, black};
+    start_player_game(white);
+    if (black != white) start_player_game(black);
+
+    state_t *state = new_state();
+    copy_state(opening, state);
+
+    uint64_t keys[MAX_GAME_PLIES + 1];
+    int key_count = 0;
+    keys[key_count++] = get_state_hash_key(state);
+
+    // Remaining clock time of each color, used when the player of that color has a clock
+    int64_t clocks[2] = {white->limits.time[WHITE], black->limits.time[WHITE]};
+
+    game_result_t result = GAME_DRAW;
+    game_end_t game_end = GAME_END_MAX_LENGTH;
+    int win_plies = 0;
+    int draw_plies = 0;
+    int last_score = 0;
+
+    for (int ply = 0; ply < MAX_GAME_PLIES; ply++) {
+        if (is_game_over(state, keys, key_count, &result, &game_end)) break;
+
+        const color_t color = get_state_to_move_color(state);
+        selfplay_player_t *player = players[color];
+
+        search_limits_t limits = player->limits;
+        if (clocks[color]) {
+            limits.time[WHITE] = limits.time[BLACK] = 0;
+            limits.increment[WHITE] = limits.increment[BLACK] = 0;
+            limits.time[color] = clocks[color];
+            limits.increment[color] = player->limits.increment[WHITE];
+        }
+
+        age_transposition_table(player->table);
+        set_search_game_history(player->search, keys, key_count);
+        const search_result_t search_result = do_move_search(player->search, state, &limits);
+
+        if (clocks[color]) {
+            clocks[color] -= search_result.time_ms;
+            if (clocks[color] <= 0) {
+                result = color == WHITE ? GAME_BLACK_WINS : GAME_WHITE_WINS;
+                game_end = GAME_END_TIME_FORFEIT;
+                break;
+            }
+            clocks[color] += player->limits.increment[WHITE];
+        }
+
+        if (on_move != NULL) on_move(context, state, &search_result);
+
+        // Adjudicate on the scores of both players, from white's point of view
+        const int score = color == WHITE ? search_result.score : -search_result.score;
+        const bool is_winning = abs(score) >= ADJUDICATION_WIN_SCORE;
+        win_plies = is_winning && (win_plies == 0 || (score > 0) == (last_score > 0)) ? win_plies + 1 : is_winning;
+        draw_plies = ply >= ADJUDICATION_DRAW_START && abs(score) <= ADJUDICATION_DRAW_SCORE ? draw_plies + 1 : 0;
+        last_score = score;
+
+        if (win_plies >= ADJUDICATION_WIN_PLIES || draw_plies >= ADJUDICATION_DRAW_PLIES) {
+            result = win_plies >= ADJUDICATION_WIN_PLIES ? (score > 0 ? GAME_WHITE_WINS : GAME_BLACK_WINS) : GAME_DRAW;
+            game_end = GAME_END_ADJUDICATION;
+            break;
+        }
+
+        move_t *move = find_legal_move(state, search_result.best_move);
+        if (move == NULL) break;
+
+        play_move(state, move);
+        free_move(move);
+        keys[key_count++] = get_state_hash_key(state);
+    }
+
+    free_state(state);
+    if (end != NULL) *end = game_end;
+    return result;
+}
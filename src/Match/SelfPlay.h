@@ -0,0 +1,109 @@
+/* iMate -- Copyright (C) 2024 Martin Newbound */
+
+/**
+ * @file SelfPlay.h
+ * @brief This file contains the declarations of the functions used to play games between two search contexts.
+ *
+ * @details A game is played entirely inside the engine: each player is a search context with its own
+ * transposition table and limits, and moves are passed as states rather than as text. Games end by the rules
+ * (checkmate, stalemate, fifty moves, threefold repetition, insufficient material), on time when the players
+ * have a clock, or by adjudication once both players have agreed on a decisive or dead drawn score for a while.
+ *
+ * Games on different threads are independent as long as each thread uses its own players.
+ *
+ * @version 1.0.0
+ * @author Martin Newbound
+ * @date 2024
+ *
+ * @note License:
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef SELF_PLAY_H
+#define SELF_PLAY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "../State/GameState.h"
+#include "../Search/Search.h"
+#include "../Search/TranspositionTable.h"
+
+// Games still running after this many half moves are drawn
+#define MAX_GAME_PLIES 512
+
+typedef enum {
+    GAME_WHITE_WINS,
+    GAME_DRAW,
+    GAME_BLACK_WINS
+} game_result_t;
+
+typedef enum {
+    GAME_END_CHECKMATE,
+    GAME_END_STALEMATE,
+    GAME_END_FIFTY_MOVES,
+    GAME_END_REPETITION,
+    GAME_END_INSUFFICIENT_MATERIAL,
+    GAME_END_TIME_FORFEIT,
+    GAME_END_ADJUDICATION,
+    GAME_END_MAX_LENGTH
+} game_end_t;
+
+/**
+ * @brief A player: a search context, the parameters it searches with and the limits of each of its moves.
+ *
+ * When limits.time[WHITE] is set the player has a clock for the whole game, starting with that many
+ * milliseconds and gaining limits.increment[WHITE] per move, whichever color it plays. The parameters are
+ * given to the search when a game starts, so two players sharing the engine's code can still search and
+ * evaluate differently.
+ */
+typedef struct {
+    search_t *search;
+    transposition_table_t *table;
+    search_params_t params;
+    search_limits_t limits;
+} selfplay_player_t;
+
+/**
+ * @brief Called after every move of a game.
+ *
+ * @param context The context given to play_selfplay_game.
+ * @param state The position the move was searched from.
+ * @param result The result of the search, its score is from the point of view of the side to move in state.
+ */
+typedef void (*selfplay_move_callback_t)(void *context, const state_t *state, const search_result_t *result);
+
+/**
+ * Plays a game from a position to its end.
+ *
+ * The transposition tables and search heuristics of both players are cleared first, and their searches
+ * given their parameters.
+ *
+ * @param opening The starting position.
+ * @param white The player of the white pieces.
+ * @param black The player of the black pieces.
+ * @param on_move Called after every move, may be NULL.
+ * @param context Passed to on_move.
+ * @param[out] end Receives how the game ended, may be NULL.
+ * @return The result of the game.
+ */
+game_result_t play_selfplay_game(const state_t *opening, selfplay_player_t *white, selfplay_player_t *black,
+                                 selfplay_move_callback_t on_move, void *context, game_end_t *end);
+
+/**
+ * Returns a short description of how a game ended, such as "repetition".
+ *
+ * @param end How the game ended.
+ * @return The description.
+ */
+const char *get_game_end_name(game_end_t end);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SELF_PLAY_H
@@ -0,0 +1,221 @@
+/* iMate -- Copyright (C) 2024 Martin Newbound */
+
+#include "AttackInfo.h"
+#include "PieceAttacks.h"
+#include "SliderAttacks.h"
+#include "../Utils/BitOperations.h"
+#include "../Utils/Profiler.h"
+
+
+/*
++=============================================================================+
+|             Lines                                                           |
++=============================================================================+
+*/
+
+/**
+ * @brief Returns the squares strictly between two squares on a rank, file or diagonal.
+ *
+ * @param from The index of the first square.
+ * @param to The index of the second square.
+ * @return The squares between them, 0 if they are adjacent or not aligned.
+ */
+static uint64_t squares_between(int from, int to) {
+    const uint64_t from_key = 1ULL << from, to_key = 1ULL << to;
+
+    // Each square stops the rays of the other, so the rays only overlap between them
+    if (get_rook_attacks(from, 0) & to_key) return get_rook_attacks(from, to_key) & get_rook_attacks(to, from_key);
+    if (get_bishop_attacks(from, 0) & to_key) return get_bishop_attacks(from, to_key) & get_bishop_attacks(to, from_key);
+    return 0;
+}
+
+/**
+ * @brief Returns the whole rank, file or diagonal through two squares.
+ *
+ * @param from The index of the first square.
+ * @param to The index of the second square.
+ * @return The squares of the line, 0 if the squares are not aligned.
+ */
+static uint64_t line_through(int from, int to) {
+    const uint64_t ends = (1ULL << from) | (1ULL << to);
+
+    if (get_rook_attacks(from, 0) & ends) return (get_rook_attacks(from, 0) & get_rook_attacks(to, 0)) | ends;
+    if (get_bishop_attacks(from, 0) & ends) return (get_bishop_attacks(from, 0) & get_bishop_attacks(to, 0)) | ends;
+    return 0;
+}
+
+
+/*
++=============================================================================+
+|             Attack Maps                                                     |
++=============================================================================+
+*/
+
+/**
+ * @brief Adds the attacks of one piece to the maps of its color.
+ */
+static inline void add_piece_attacks(attack_info_t *info, color_t color, piece_t piece, int square, uint64_t attacks) {
+    info->square_attacks[square] = attacks;
+    info->attacked_twice[color] |= info->attacked[color] & attacks;
+    info->attacked[color] |= attacks;
+    info->attacks[color][piece] |= attacks;
+}
+
+/**
+ * @brief Computes the attack maps of one color.
+ *
+ * @param state The game state.
+ * @param info The attack maps to fill.
+ * @param color The color.
+ */
+static void compute_color_attacks(const state_t *state, attack_info_t *info, color_t color) {
+    const uint64_t occupancy = get_state_occupancy(state);
+    const uint64_t pawns = get_state_peice_bitboard(state, PIECE_PAWN, color);
+    const uint64_t west_attacks = get_pawn_west_attacks(pawns, color);
+    const uint64_t east_attacks = get_pawn_east_attacks(pawns, color);
+
+    info->attacks[color][PIECE_PAWN] = info->attacked[color] = west_attacks | east_attacks;
+    info->attacked_twice[color] = west_attacks & east_attacks;
+
+    for (piece_t piece = PIECE_ROOK; piece <= PIECE_KING; piece++) info->attacks[color][piece] = 0;
+
+    for (uint64_t knights = get_state_peice_bitboard(state, PIECE_KNIGHT, color); knights; ) {
+        const int square = pop_lsb(&knights);
+        add_piece_attacks(info, color, PIECE_KNIGHT, square, get_knight_attacks(1ULL << square));
+    }
+
+    for (uint64_t bishops = get_state_peice_bitboard(state, PIECE_BISHOP, color); bishops; ) {
+        const int square = pop_lsb(&bishops);
+        add_piece_attacks(info, color, PIECE_BISHOP, square, get_bishop_attacks(square, occupancy));
+    }
+
+    for (uint64_t rooks = get_state_peice_bitboard(state, PIECE_ROOK, color); rooks; ) {
+        const int square = pop_lsb(&rooks);
+        add_piece_attacks(info, color, PIECE_ROOK, square, get_rook_attacks(square, occupancy));
+    }
+
+    for (uint64_t queens = get_state_peice_bitboard(state, PIECE_QUEEN, color); queens; ) {
+        const int square = pop_lsb(&queens);
+        add_piece_attacks(info, color, PIECE_QUEEN, square, get_queen_attacks(square, occupancy));
+    }
+
+    const uint64_t king = get_state_peice_bitboard(state, PIECE_KING, color);
+    if (king) add_piece_attacks(info, color, PIECE_KING, lsb_index(king), get_king_attacks(king));
+}
+
+/**
+ * @brief Finds the pieces of a color which stand alone between their king and an opposing slider.
+ *
+ * @param state The game state.
+ * @param color The color of the king.
+ * @return The pinned pieces.
+ */
+static uint64_t find_pinned_pieces(const state_t *state, color_t color) {
+    const uint64_t king = get_state_peice_bitboard(state, PIECE_KING, color);
+    if (!king) return 0;
+
+    const color_t opponent = color == WHITE ? BLACK : WHITE;
+    const uint64_t opponent_bitboard = states_color_bitboard(state, opponent);
+    const uint64_t occupancy = get_state_occupancy(state);
+    const uint64_t queens = get_state_peice_bitboard(state, PIECE_QUEEN, opponent);
+    const int king_square = lsb_index(king);
+
+    // Sliders which would attack the king if the pieces of its own color were removed
+    uint64_t snipers = (get_rook_attacks(king_square, opponent_bitboard) & (get_state_peice_bitboard(state, PIECE_ROOK, opponent) | queens))
+                     | (get_bishop_attacks(king_square, opponent_bitboard) & (get_state_peice_bitboard(state, PIECE_BISHOP, opponent) | queens));
+
+    uint64_t pinned = 0;
+    while (snipers) {
+        const uint64_t blockers = squares_between(king_square, pop_lsb(&snipers)) & occupancy;
+        if (blockers && !(blockers & (blockers - 1))) pinned |= blockers;
+    }
+
+    return pinned & states_color_bitboard(state, color);
+}
+
+void compute_attack_info(const state_t *state, attack_info_t *info) {
+    PROFILE_SCOPE(PROFILE_ATTACK_DETECTION);
+    const color_t color = get_state_to_move_color(state);
+
+    compute_color_attacks(state, info, WHITE);
+    compute_color_attacks(state, info, BLACK);
+
+    info->pinned[WHITE] = find_pinned_pieces(state, WHITE);
+    info->pinned[BLACK] = find_pinned_pieces(state, BLACK);
+
+    // The checkers are the pieces a piece of their kind on the king's square would attack
+    const uint64_t king = get_state_peice_bitboard(state, PIECE_KING, color);
+    info->checkers = 0;
+    if (king) {
+        const color_t opponent = color == WHITE ? BLACK : WHITE;
+        const uint64_t occupancy = get_state_occupancy(state);
+        const uint64_t queens = get_state_peice_bitboard(state, PIECE_QUEEN, opponent);
+        const int king_square = lsb_index(king);
+
+        info->checkers = (get_pawn_attacks(king, color) & get_state_peice_bitboard(state, PIECE_PAWN, opponent))
+                       | (get_knight_attacks(king) & get_state_peice_bitboard(state, PIECE_KNIGHT, opponent))
+                       | (get_rook_attacks(king_square, occupancy) & (get_state_peice_bitboard(state, PIECE_ROOK, opponent) | queens))
+                       | (get_bishop_attacks(king_square, occupancy) & (get_state_peice_bitboard(state, PIECE_BISHOP, opponent) | queens));
+    }
+
+    info->hash_key = get_state_hash_key(state);
+    info->is_computed = true;
+}
+
+const attack_info_t *get_attack_info(const state_t *state, attack_info_t *info) {
+    if (!info->is_computed || info->hash_key != get_state_hash_key(state)) compute_attack_info(state, info);
+    return info;
+}
+
+
+/*
++=============================================================================+
+|             Legality                                                        |
++=============================================================================+
+*/
+
+uint64_t get_check_evasion_targets(const state_t *state, const attack_info_t *info) {
+    if (!info->checkers) return ~0ULL;
+    if (info->checkers & (info->checkers - 1)) return 0;
+
+    const uint64_t king = get_state_peice_bitboard(state, PIECE_KING, get_state_to_move_color(state));
+    return info->checkers | squares_between(lsb_index(king), lsb_index(info->checkers));
+}
+
+move_legality_t get_move_legality(const state_t *state, const attack_info_t *info, const move_t *move) {
+    const color_t color = get_state_to_move_color(state);
+    const color_t opponent = color == WHITE ? BLACK : WHITE;
+    const uint64_t king = get_state_peice_bitboard(state, PIECE_KING, color);
+    const uint64_t from_square = get_move_from_square(move);
+    const uint64_t to_square = get_move_to_square(move);
+
+    if (!king) return MOVE_LEGALITY_UNKNOWN;
+
+    // The king may not step onto an attacked square. When it is in check, the squares behind it on the
+    // checking ray are not in the maps, which the king hides from the slider
+    if (from_square == king) {
+        if (to_square & info->attacked[opponent]) return MOVE_ILLEGAL;
+        if (info->checkers) return MOVE_LEGALITY_UNKNOWN;
+        return MOVE_LEGAL;
+    }
+
+    // An en passant capture removes two pieces from the rank of the king, which may uncover it
+    if ((from_square & get_state_peice_bitboard(state, PIECE_PAWN, color)) && to_square == get_en_passant_target(state)) {
+        return MOVE_LEGALITY_UNKNOWN;
+    }
+
+    const int king_square = lsb_index(king);
+
+    // Only the king can answer a double check, and a pinned piece can never answer a check
+    if (info->checkers) {
+        if (from_square & info->pinned[color]) return MOVE_ILLEGAL;
+        return (to_square & get_check_evasion_targets(state, info)) ? MOVE_LEGAL : MOVE_ILLEGAL;
+    }
+
+    // A pinned piece may only move along the line of the pin
+    if (from_square & info->pinned[color]) {
+        return (to_square & line_through(king_square, lsb_index(from_square))) ? MOVE_LEGAL : MOVE_ILLEGAL;
+    }
+
+    return MOVE_LEGAL;
+}
@@ -0,0 +1,99 @@
+/* iMate -- Copyright (C) 2024 Martin Newbound */
+
+/**
+ * @file AttackInfo.h
+ * @brief This file contains the attack maps of a position, computed once and shared by legality checks,
+ * move generation and evaluation.
+ *
+ * @details The maps hold the squares each piece type of each color attacks, the squares each color attacks
+ * at least once and at least twice, the pieces giving check to the player to move, the pieces of each color
+ * pinned to their king, and the attacks of every piece other than a pawn by its square, which the evaluation
+ * counts per piece. They are computed set-wise from the piece bitboards.
+ *
+ * A search keeps one attack_info_t per ply and fills it through get_attack_info only when a node needs it,
+ * so a node cut off by the transposition table never pays for it, and the entry is reused when the same
+ * position is asked for again at that ply.
+ *
+ * @version 1.0.0
+ * @author Martin Newbound
+ * @date 2024
+ *
+ * @note License:
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef ATTACK_INFO_H
+#define ATTACK_INFO_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "../State/GameState.h"
+#include "Move.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct {
+    uint64_t attacks[2][6];         // indexed by color_t, then piece_t
+    uint64_t attacked[2];           // the squares each color attacks
+    uint64_t attacked_twice[2];     // the squares each color attacks with at least two pieces
+    uint64_t checkers;              // the pieces giving check to the player to move
+    uint64_t pinned[2];             // the pieces of each color which shield their king from a slider
+    uint64_t square_attacks[64];    // the attacks of the piece on each square, only set for pieces other than pawns
+    uint64_t hash_key;              // the key of the position the maps were computed for
+    bool is_computed;
+} attack_info_t;
+
+typedef enum {
+    MOVE_ILLEGAL,
+    MOVE_LEGAL,
+    MOVE_LEGALITY_UNKNOWN           // the move must be played to find out (king moves in check, en passant)
+} move_legality_t;
+
+/**
+ * Computes the attack maps of a state.
+ *
+ * @param state The game state.
+ * @param[out] info Receives the attack maps.
+ */
+void compute_attack_info(const state_t *state, attack_info_t *info);
+
+/**
+ * Returns the attack maps of a state, computing them unless they already hold the maps of the same position.
+ *
+ * @param state The game state.
+ * @param info The cached attack maps, is_computed must be false before the first use.
+ * @return info, holding the maps of the state.
+ */
+const attack_info_t *get_attack_info(const state_t *state, attack_info_t *info);
+
+/**
+ * Returns the squares a piece other than the king may move to, given the checks on the king of the player to move.
+ *
+ * @param state The game state.
+ * @param info The attack maps of the state.
+ * @return Every square when the king is not in check, the checking piece and the squares between it and the king
+ * in a single check, and no square in a double check. An en passant capture of a checking pawn lands elsewhere.
+ */
+uint64_t get_check_evasion_targets(const state_t *state, const attack_info_t *info);
+
+/**
+ * Decides from the attack maps whether a pseudo legal move leaves the moving player's king in check.
+ *
+ * @param state The game state the move was generated for.
+ * @param info The attack maps of the state.
+ * @param move The pseudo legal move.
+ * @return MOVE_LEGAL or MOVE_ILLEGAL, or MOVE_LEGALITY_UNKNOWN when only playing the move can tell.
+ */
+move_legality_t get_move_legality(const state_t *state, const attack_info_t *info, const move_t *move);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ATTACK_INFO_H
@@ -5,6 +5,11 @@
 #include "../State/GameState.h"
 #include "../Moves/MoveGeneration.h"
 #include "../Moves/MoveCollection.h"
+#include "../Utils/BitOperations.h"
+
+#define MOVE_KEY_FROM(KEY) ((KEY) & 0x3F)
+#define MOVE_KEY_TO(KEY) (((KEY) >> 6) & 0x3F)
+#define MOVE_KEY_PROMOTION(KEY) ((piece_t)(((KEY) >> 12) & 0x7) - 1)
 
 struct move {
     uint64_t from_square;
@@ -21,26 +26,75 @@ move_t *new_move(uint64_t from_square, uint64_t to_square, flags_t flags) {
     return move;
 }
 
+move_t *new_arena_move(arena_t *arena, uint64_t from_square, uint64_t to_square, flags_t flags) {
+    move_t *move = arena_alloc(arena, sizeof(move_t));
+    move->from_square = from_square;
+    move->to_square = to_square;
+
+    move->flags = flags;
+    return move;
+}
+
 void free_move(move_t *move)
 {
     free(move);
     move = NULL;
 }
 
-bool is_legal_move(const state_t *state, const move_t *move) {
-    state_t *temporary_state = new_state();
-    copy_state(state, temporary_state);
-    apply_move(move, temporary_state);
+void apply_move(const move_t *move, state_t *state) {
+    play_move(state, move);
+}
 
-    game_status_t status = get_state_status(temporary_state);
+const flags_t *get_move_flags(const move_t *move) {
+    return &move->flags;
+}
 
-    bool is_legal = true;
-    if (get_state_to_move_color(state) == WHITE && (status == WHITE_CHECK || status == WHITE_CHECKMATE)) is_legal = false;
-    if (get_state_to_move_color(state) == BLACK && (status == BLACK_CHECK || status == BLACK_CHECKMATE)) is_legal = false;
+uint64_t get_move_from_square(const move_t *move) {
+    return move->from_square;
+}
 
-    free_state(temporary_state);
-    return is_legal;
+uint64_t get_move_to_square(const move_t *move) {
+    return move->to_square;
 }
 
+uint16_t get_move_key(const move_t *move) {
+    return (uint16_t)(lsb_index(move->from_square)
+        | (lsb_index(move->to_square) << 6)
+        | ((move->flags.promotion_piece + 1) << 12));
+}
+
+void move_key_to_string(uint16_t key, char *buffer) {
+    static const char PROMOTION_SYMBOLS[] = {'p', 'r', 'n', 'b', 'q', 'k'};
+
+    buffer[0] = 'a' + MOVE_KEY_FROM(key) % 8;
+    buffer[1] = '1' + MOVE_KEY_FROM(key) / 8;
+    buffer[2] = 'a' + MOVE_KEY_TO(key) % 8;
+    buffer[3] = '1' + MOVE_KEY_TO(key) / 8;
+
+    piece_t promotion_piece = MOVE_KEY_PROMOTION(key);
+    buffer[4] = promotion_piece == NULL_PIECE ? '\0' : PROMOTION_SYMBOLS[promotion_piece];
+    buffer[5] = '\0';
+}
 
+void move_to_string(const move_t *move, char *buffer) {
+    move_key_to_string(get_move_key(move), buffer);
+}
+
+uint16_t move_string_to_key(const char *string) {
+    if (string[0] < 'a' || string[0] > 'h' || string[1] < '1' || string[1] > '8') return NULL_MOVE_KEY;
+    if (string[2] < 'a' || string[2] > 'h' || string[3] < '1' || string[3] > '8') return NULL_MOVE_KEY;
+
+    int from_index = (string[1] - '1') * 8 + (string[0] - 'a');
+    int to_index = (string[3] - '1') * 8 + (string[2] - 'a');
 
+    piece_t promotion_piece = NULL_PIECE;
+    switch (string[4]) {
+        case 'r': promotion_piece = PIECE_ROOK;   break;
+        case 'n': promotion_piece = PIECE_KNIGHT; break;
+        case 'b': promotion_piece = PIECE_BISHOP; break;
+        case 'q': promotion_piece = PIECE_QUEEN;  break;
+        default: break;
+    }
+
+    return (uint16_t)(from_index | (to_index << 6) | ((promotion_piece + 1) << 12));
+}
@@ -25,10 +25,17 @@ extern "C" {
 
 #include <stdint.h>
 #include "../State/GameState.h"
+#include "../Utils/Arena.h"
 
 // Represents a chess move
 typedef struct move move_t;
 
+// Length of the buffer needed to hold a move in long algebraic notation (e.g. "e7e8q")
+#define MOVE_STRING_LENGTH 6
+
+// A move key of zero never describes a real move
+#define NULL_MOVE_KEY 0
+
 // Contains flags for special move types
 typedef struct flags {
     piece_t promotion_piece;
@@ -50,6 +57,17 @@ typedef struct flags {
  */
 move_t *new_move(uint64_t from_square, uint64_t to_square, flags_t flags);
 
+/**
+ * Creates a new move in an arena. The move is freed with the arena, never with free_move.
+ * 
+ * @param arena The arena to allocate the move from.
+ * @param from_square The square the piece is moving from.
+ * @param to_square The square the piece is moving to.
+ * @param flags The flags for the move.
+ * @return A pointer to the new move.
+ */
+move_t *new_arena_move(arena_t *arena, uint64_t from_square, uint64_t to_square, flags_t flags);
+
 /**
  * Frees a move.
  * 
@@ -98,6 +116,45 @@ uint64_t get_move_from_square(const move_t *move);
  */
 uint64_t get_move_to_square(const move_t *move);
 
+/**
+ * Packs a move into a 16 bit key.
+ * 
+ * The key holds the from square index (bits 0-5), the to square index (bits 6-11)
+ * and the promotion piece plus one (bits 12-14). Keys are compact enough to be stored
+ * in the transposition table and in principal variations.
+ * 
+ * @param move The move to pack.
+ * @return The key of the move.
+ */
+uint16_t get_move_key(const move_t *move);
+
+/**
+ * Writes a move key in long algebraic notation (e.g. "e2e4", "e7e8q").
+ * 
+ * @param key The move key to convert.
+ * @param buffer A buffer of at least MOVE_STRING_LENGTH characters.
+ */
+void move_key_to_string(uint16_t key, char *buffer);
+
+/**
+ * Writes a move in long algebraic notation (e.g. "e2e4", "e7e8q").
+ * 
+ * @param move The move to convert.
+ * @param buffer A buffer of at least MOVE_STRING_LENGTH characters.
+ */
+void move_to_string(const move_t *move, char *buffer);
+
+/**
+ * Parses a move in long algebraic notation (e.g. "e2e4", "e7e8q") into a move key.
+ * 
+ * Only the syntax of the string is checked, use find_legal_move to check the move
+ * is playable in a given state.
+ * 
+ * @param string The string to parse, trailing characters after the move are ignored.
+ * @return The key of the move, or NULL_MOVE_KEY if the string is not a move.
+ */
+uint16_t move_string_to_key(const char *string);
+
 
 #ifdef __cplusplus
 }
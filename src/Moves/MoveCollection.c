@@ -1,6 +1,7 @@
 /* iMate -- Copyright (C) 2024 Martin Newbound */
 
 #include "MoveCollection.h"
+#include "../Utils/BitOperations.h"
 #include <stdlib.h>
 
 
@@ -12,42 +13,68 @@ struct move_collection_node {
 
 struct move_collection {
     struct move_collection_node *head;
+    arena_t *arena;     // NULL for a heap collection
 };
 
 move_collection_t *new_move_collection() {
     move_collection_t *collection = malloc(sizeof(move_collection_t));
     collection->head = NULL;
+    collection->arena = NULL;
+    return collection;
+}
+
+move_collection_t *new_arena_move_collection(arena_t *arena) {
+    move_collection_t *collection = arena_alloc(arena, sizeof(move_collection_t));
+    collection->head = NULL;
+    collection->arena = arena;
     return collection;
 }
 
 void free_move_collection(move_collection_t *collection) {
+    if (collection->arena != NULL) return;
+
     struct move_collection_node *current = collection->head;
     while (current != NULL) {
         struct move_collection_node *next = current->next;
-        free_move(current->move);
+        free_move((move_t *)current->move);
         free(current);
         current = next;
     }
 
-    collection->head = NULL;
+    free(collection);
 }
 
 
 void push_move_to_collection(const move_t *move, move_collection_t *collection) {
-    struct move_collection_node *new_node = malloc(sizeof(struct move_collection_node));
+    struct move_collection_node *new_node = collection->arena != NULL
+        ? arena_alloc(collection->arena, sizeof(struct move_collection_node))
+        : malloc(sizeof(struct move_collection_node));
     new_node->move = move;
     new_node->next = collection->head;
     collection->head = new_node;
 }
 
+void push_new_move_to_collection(uint64_t from_square, uint64_t to_square, flags_t flags, move_collection_t *collection) {
+    const move_t *move = collection->arena != NULL
+        ? new_arena_move(collection->arena, from_square, to_square, flags)
+        : new_move(from_square, to_square, flags);
+    push_move_to_collection(move, collection);
+}
+
+void push_new_moves_to_collection(uint64_t from_square, uint64_t to_squares, flags_t flags, move_collection_t *collection) {
+    while (to_squares) {
+        push_new_move_to_collection(from_square, 1ULL << pop_lsb(&to_squares), flags, collection);
+    }
+}
+
 move_t *pop_collection_head(move_collection_t *collection) {
     struct move_collection_node *head = collection->head;
     if (head == NULL) return NULL;
 
-    move_t *move = head->move;
+    move_t *move = (move_t *)head->move;
     struct move_collection_node *next = head->next;
 
-    free(head);
+    if (collection->arena == NULL) free(head);
     collection->head = next;
     return move;
 }
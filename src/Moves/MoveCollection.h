@@ -4,6 +4,9 @@
  * 
  * @details The move_collection_t structure represents a collection of chess moves.
  * 
+ * A collection is either allocated on the heap, owning its moves which are freed with free_move, or allocated
+ * in an arena along with its moves, which are then freed with the arena and must not be passed to free_move.
+ * 
  * @version 1.0.0
  * @author Martin Newbound
  * @date 2024
@@ -24,6 +27,7 @@ extern "C" {
 
 #include <stdint.h>
 #include "Move.h"
+#include "../Utils/Arena.h"
 
 
 // Represents a collection of chess moves
@@ -37,7 +41,15 @@ typedef struct move_collection move_collection_t;
 move_collection_t *new_move_collection();
 
 /**
- * Frees a move collection.
+ * Creates a new move collection in an arena. The moves later added to it are allocated in the same arena.
+ * 
+ * @param arena The arena to allocate the collection and its moves from.
+ * @return A pointer to the new move collection, which does not need to be freed.
+ */
+move_collection_t *new_arena_move_collection(arena_t *arena);
+
+/**
+ * Frees a move collection along with the moves it still holds. Does nothing for an arena collection.
  * 
  * @param collection The move collection to free.
  */
@@ -51,6 +63,26 @@ void free_move_collection(move_collection_t *collection);
  */
 void push_move_to_collection(const move_t *move, move_collection_t *collection);
 
+/**
+ * Creates a move and pushes it to a move collection, allocating it where the collection allocates its moves.
+ * 
+ * @param from_square The square the piece is moving from.
+ * @param to_square The square the piece is moving to.
+ * @param flags The flags for the move.
+ * @param collection The move collection to push the move to.
+ */
+void push_new_move_to_collection(uint64_t from_square, uint64_t to_square, flags_t flags, move_collection_t *collection);
+
+/**
+ * Creates a move to each of a set of squares and pushes them to a move collection, lowest square first.
+ * 
+ * @param from_square The square the piece is moving from.
+ * @param to_squares The bitboard of the squares the piece is moving to.
+ * @param flags The flags for the moves.
+ * @param collection The move collection to push the moves to.
+ */
+void push_new_moves_to_collection(uint64_t from_square, uint64_t to_squares, flags_t flags, move_collection_t *collection);
+
 /**
  * Pops the head move from a move collection.
  * 
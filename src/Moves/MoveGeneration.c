@@ -1,19 +1,17 @@
 /* iMate -- Copyright (C) 2024 Martin Newbound */
 
 #include "MoveGeneration.h"
+#include "AttackInfo.h"
+#include "../Utils/Profiler.h"
 #include <stdlib.h>
 
-void gen_pawn_moves_on_square(const state_t *state, move_collection_t *collection, uint64_t square_key);
-
-void gen_rook_moves_on_square(const state_t *state, move_collection_t *collection, uint64_t square_key);
-
-void gen_knight_moves_on_square(const state_t *state, move_collection_t *collection, uint64_t square_key);
-
-void gen_bishop_moves_on_square(const state_t *state, move_collection_t *collection, uint64_t square_key);
-
-void gen_queen_moves_on_square(const state_t *state, move_collection_t *collection, uint64_t square_key);
-
-void gen_king_moves_on_square(const state_t *state, move_collection_t *collection, uint64_t square_key);
+// Defined in the PieceMoveGeneration files, each generates the moves of every piece of its type (to the targets)
+void gen_pawn_moves(const state_t *state, move_collection_t *collection, uint64_t targets);
+void gen_knight_moves(const state_t *state, move_collection_t *collection, uint64_t targets);
+void gen_bishop_moves(const state_t *state, move_collection_t *collection, uint64_t targets);
+void gen_rook_moves(const state_t *state, move_collection_t *collection, uint64_t targets);
+void gen_queen_moves(const state_t *state, move_collection_t *collection, uint64_t targets);
+void gen_king_moves(const state_t *state, move_collection_t *collection, uint64_t targets, uint64_t attacked);
 
 bool is_legal_move(const state_t *state, const move_t *move) {
     color_t orig_color = get_state_to_move_color(state);
@@ -21,80 +19,121 @@ bool is_legal_move(const state_t *state, const move_t *move) {
     copy_state(state, temporary_state);
     apply_move(move, temporary_state);
 
-    bool is_legal = !is_check(state, orig_color);
+    bool is_legal = !is_check(temporary_state, orig_color);
 
     free_state(temporary_state);
     return is_legal;
 }
 
-void prune_illegal_moves(const state_t *state, move_collection_t *collection) {
-    const move_t* head_move = pop_collection_head(collection);
+/**
+ * @brief Removes the illegal moves from a collection, keeping the order of the others.
+ *
+ * @param state The game state the moves were generated for.
+ * @param info The attack maps of the state.
+ * @param collection The collection of pseudo legal moves to prune.
+ */
+static void prune_moves_with_attack_info(const state_t *state, const attack_info_t *info, move_collection_t *collection) {
+    move_t *head_move = pop_collection_head(collection);
     if (head_move == NULL) return;
-    
-    prune_illegal_moves(state, collection);
-    if (is_legal_move(state, head_move)) push_move_to_collection(head_move, collection);
-    else free_move(head_move);
+
+    prune_moves_with_attack_info(state, info, collection);
+
+    const move_legality_t legality = get_move_legality(state, info, head_move);
+    if (legality == MOVE_LEGAL || (legality == MOVE_LEGALITY_UNKNOWN && is_legal_move(state, head_move))) {
+        push_move_to_collection(head_move, collection);
+    } else {
+        free_move(head_move);
+    }
 }
 
-move_collection_t *generate_psudo_legal_moves(const state_t *state, color_t target_color) {
-    move_collection_t *collection = new_move_collection();
+void prune_illegal_moves(const state_t *state, move_collection_t *collection) {
+    attack_info_t info;
+    compute_attack_info(state, &info);
+    prune_moves_with_attack_info(state, &info, collection);
+}
+
+/**
+ * @brief Adds the pseudo legal moves of the player to move to a collection.
+ *
+ * The pieces of each type are visited by scanning their bitboard, and the moves of a piece are its attacks
+ * masked by the squares not holding an own piece, so empty squares are never looked at. With the attack maps,
+ * the king does not step onto an attacked square and, in check, the other pieces only move to the squares
+ * which answer it (none in a double check).
+ *
+ * @param state The game state to generate the moves for.
+ * @param info The attack maps of the state, or NULL.
+ * @param collection The collection to add the moves to.
+ */
+static void add_psudo_legal_moves(const state_t *state, const attack_info_t *info, move_collection_t *collection) {
+    PROFILE_SCOPE(PROFILE_MOVE_GENERATION);
+    const color_t color = get_state_to_move_color(state);
+    const uint64_t own_squares = states_color_bitboard(state, color);
+    uint64_t attacked, targets, king_targets;
+
+    if (info != NULL) {
+        attacked = info->attacked[color == WHITE ? BLACK : WHITE];
+        targets = ~own_squares & get_check_evasion_targets(state, info);
+        king_targets = ~own_squares & ~attacked;
+    } else {
+        // The attacked squares are only needed to castle
+        const bool may_castle = color == WHITE
+            ? state_can_castle(state, CASTLE_KINGSIDE_WHITE) || state_can_castle(state, CASTLE_QUEENSIDE_WHITE)
+            : state_can_castle(state, CASTLE_KINGSIDE_BLACK) || state_can_castle(state, CASTLE_QUEENSIDE_BLACK);
+        attacked = may_castle ? get_attacked_squares_bitboard(state) : 0;
+        targets = king_targets = ~own_squares;
+    }
 
-    for (size_t i = 0; i < 64; ++i) {
-        const uint64_t square_key = 1 << i;
-
-        switch(piece_on_square(state, square_key)) {
-            case PIECE_PAWN:
-                gen_pawn_moves_on_square(state, collection, square_key);
-                break;
-
-            case PIECE_ROOK:
-                gen_rook_moves_on_square(state, collection, square_key);
-                break;
-            
-            case PIECE_KNIGHT:
-                gen_knight_moves_on_square(state, collection, square_key);
-                break;
-
-            case PIECE_BISHOP:
-                gen_bishop_moves_on_square(state, collection, square_key);
-                break;
-
-            case PIECE_QUEEN:
-                gen_queen_moves_on_square(state, collection, square_key);
-                break;
-
-            case PIECE_KING:
-                gen_king_moves_on_square(state, collection, square_key);
-                break;
-            
-            default:
-                break;
-        }
+    if (targets) {
+        gen_pawn_moves(state, collection, targets);
+        gen_knight_moves(state, collection, targets);
+        gen_bishop_moves(state, collection, targets);
+        gen_rook_moves(state, collection, targets);
+        gen_queen_moves(state, collection, targets);
     }
+    gen_king_moves(state, collection, king_targets, attacked);
+}
 
+move_collection_t *generate_psudo_legal_moves(const state_t *state) {
+    move_collection_t *collection = new_move_collection();
+    add_psudo_legal_moves(state, NULL, collection);
+    return collection;
+}
+
+move_collection_t *generate_arena_psudo_legal_moves(const state_t *state, const attack_info_t *info, arena_t *arena) {
+    move_collection_t *collection = new_arena_move_collection(arena);
+    add_psudo_legal_moves(state, info, collection);
     return collection;
 }
 
 
 move_collection_t *get_legal_moves_of_state(const state_t *state) {
-    move_collection_t *collection = generate_psudo_legal_moves(state, get_state_to_move_color(state));
-    prune_illegal_moves(state, collection);
+    attack_info_t info;
+    compute_attack_info(state, &info);
+
+    move_collection_t *collection = new_move_collection();
+    add_psudo_legal_moves(state, &info, collection);
+    prune_moves_with_attack_info(state, &info, collection);
 
     return collection;
 }
 
 uint64_t get_attacked_squares_bitboard(const state_t *state) {
-    color_t target_color = get_state_to_move_color(state) == WHITE ? BLACK : WHITE;
-    move_collection_t *collection = generate_psudo_legal_moves(state, target_color);
+    attack_info_t info;
+    compute_attack_info(state, &info);
+    return info.attacked[get_state_to_move_color(state) == WHITE ? BLACK : WHITE];
+}
 
-    uint64_t attacked_squares = 0;
+move_t *find_legal_move(const state_t *state, uint16_t key) {
+    move_collection_t *collection = get_legal_moves_of_state(state);
+    move_t *found_move = NULL;
 
     move_t *move = pop_collection_head(collection);
     while (move != NULL) {
-        attacked_squares |= get_move_to_square(move);
-        free_move(move);
+        if (found_move == NULL && get_move_key(move) == key) found_move = move;
+        else free_move(move);
         move = pop_collection_head(collection);
     }
 
     free_move_collection(collection);
+    return found_move;
 }
@@ -24,6 +24,40 @@
 #include "../State/GameState.h"
 #include "Move.h"
 #include "MoveCollection.h"
+#include "AttackInfo.h"
+
+/**
+ * Generates a collection of all pseudo legal moves for the player to move.
+ * 
+ * Pseudo legal moves follow the movement rules of each piece but may leave
+ * the moving player's king in check.
+ * 
+ * @param state The game state to generate the moves for.
+ * @return A pointer to the collection of pseudo legal moves.
+ */
+move_collection_t *generate_psudo_legal_moves(const state_t *state);
+
+/**
+ * Generates all pseudo legal moves for the player to move into a collection allocated in an arena.
+ * 
+ * The collection and its moves are freed with the arena, see new_arena_move_collection. When the attack maps
+ * of the state are given, the moves they show to be illegal are left out: king moves onto attacked squares and,
+ * when the king is in check, moves of other pieces which neither capture the checking piece nor block it.
+ * 
+ * @param state The game state to generate the moves for.
+ * @param info The attack maps of the state, or NULL to generate every pseudo legal move.
+ * @param arena The arena to allocate the collection and the moves from.
+ * @return A pointer to the collection of pseudo legal moves.
+ */
+move_collection_t *generate_arena_psudo_legal_moves(const state_t *state, const attack_info_t *info, arena_t *arena);
+
+/**
+ * Removes all moves from a collection which would leave the moving player's king in check.
+ * 
+ * @param state The game state the moves were generated for.
+ * @param collection The collection of pseudo legal moves to prune.
+ */
+void prune_illegal_moves(const state_t *state, move_collection_t *collection);
 
 /**
  * Generates a collection of all legal moves for a given game state.
@@ -41,4 +75,15 @@ move_collection_t *get_legal_moves_of_state(const state_t *state);
  */
 uint64_t get_attacked_squares_bitboard(const state_t *state);
 
+/**
+ * Finds the legal move matching a move key.
+ * 
+ * @param state The game state to search the legal moves of.
+ * @param key The key of the move to find (see get_move_key).
+ * @return A newly allocated copy of the matching move, or NULL if the move is not legal.
+ * 
+ * @warning The caller is responsible for freeing the returned move.
+ */
+move_t *find_legal_move(const state_t *state, uint16_t key);
+
 #endif // MOVE_GEN_H
\ No newline at end of file
@@ -0,0 +1,290 @@
+/* iMate -- Copyright (C) 2024 Martin Newbound */
+
+#include "PgnReader.h"
+#include "SanNotation.h"
+#include "../Utils/Arena.h"
+#include <ctype.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Arena of the move decoder, released after every move
+#define PGN_ARENA_BLOCK_SIZE 16384
+
+// Longest tag value and move token kept, longer ones are cut (values) or rejected (moves)
+#define PGN_TAG_VALUE_LENGTH 256
+#define PGN_TOKEN_LENGTH 16
+
+#define IS_PGN_SPACE(C) ((C) == ' ' || (C) == '\t' || (C) == '\n' || (C) == '\r')
+
+// Characters which end a move token
+#define IS_PGN_DELIMITER(C) (IS_PGN_SPACE(C) || strchr("{}()[];$", (C)) != NULL)
+
+/**
+ * @brief A PGN file mapped into memory, and the state of the game being read.
+ */
+struct pgn_reader {
+    const char *data;
+    size_t size;
+    size_t offset;
+
+    state_t *state;
+    arena_t *arena;
+};
+
+pgn_reader_t *open_pgn_file(const char *path) {
+    const int descriptor = open(path, O_RDONLY);
+    if (descriptor < 0) return NULL;
+
+    struct stat status;
+    if (fstat(descriptor, &status) != 0) {
+        close(descriptor);
+        return NULL;
+    }
+
+    pgn_reader_t *reader = calloc(1, sizeof(pgn_reader_t));
+    reader->size = (size_t)status.st_size;
+
+    if (reader->size > 0) {
+        void *mapping = mmap(NULL, reader->size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+        if (mapping == MAP_FAILED) {
+            close(descriptor);
+            free(reader);
+            return NULL;
+        }
+
+        // The file is read front to back, the kernel can read ahead and drop the pages behind
+        posix_madvise(mapping, reader->size, POSIX_MADV_SEQUENTIAL);
+        reader->data = mapping;
+    }
+
+    close(descriptor);
+    reader->state = new_state();
+    reader->arena = new_arena(PGN_ARENA_BLOCK_SIZE);
+    return reader;
+}
+
+void close_pgn_file(pgn_reader_t *reader) {
+    if (reader->size > 0) munmap((void *)reader->data, reader->size);
+    free_state(reader->state);
+    free_arena(reader->arena);
+    free(reader);
+}
+
+size_t get_pgn_file_offset(const pgn_reader_t *reader, size_t *size) {
+    if (size != NULL) *size = reader->size;
+    return reader->offset;
+}
+
+/*
++=============================================================================+
+|             Scanning                                                        |
++=============================================================================+
+*/
+
+static bool is_at_end(const pgn_reader_t *reader) {
+    return reader->offset >= reader->size;
+}
+
+static bool is_at_line_start(const pgn_reader_t *reader) {
+    return reader->offset == 0 || reader->data[reader->offset - 1] == '\n';
+}
+
+static void skip_spaces(pgn_reader_t *reader) {
+    while (!is_at_end(reader) && IS_PGN_SPACE(reader->data[reader->offset])) reader->offset++;
+}
+
+/**
+ * @brief Moves past the next occurrence of a character, or to the end of the file.
+ */
+static void skip_past(pgn_reader_t *reader, char c) {
+    const char *found = memchr(reader->data + reader->offset, c, reader->size - reader->offset);
+    reader->offset = found != NULL ? (size_t)(found - reader->data) + 1 : reader->size;
+}
+
+/**
+ * @brief Skips a variation, the reader being past its opening parenthesis. Variations nest and hold comments.
+ */
+static void skip_variation(pgn_reader_t *reader) {
+    int depth = 1;
+
+    while (depth > 0 && !is_at_end(reader)) {
+        switch (reader->data[reader->offset++]) {
+            case '(': depth++; break;
+            case ')': depth--; break;
+            case '{': skip_past(reader, '}'); break;
+            case ';': skip_past(reader, '\n'); break;
+            default: break;
+        }
+    }
+}
+
+/**
+ * @brief Returns the length of the token at the reader's offset.
+ */
+static size_t get_token_length(const pgn_reader_t *reader) {
+    size_t end = reader->offset;
+    while (end < reader->size && !IS_PGN_DELIMITER(reader->data[end])) end++;
+    return end - reader->offset;
+}
+
+/**
+ * @brief Reads a game termination marker.
+ *
+ * @return false if the token is not a termination marker.
+ */
+static bool parse_result_token(const char *token, size_t length, pgn_result_t *result) {
+    if (length == 3 && memcmp(token, "1-0", 3) == 0) *result = PGN_WHITE_WINS;
+    else if (length == 3 && memcmp(token, "0-1", 3) == 0) *result = PGN_BLACK_WINS;
+    else if (length == 7 && memcmp(token, "1/2-1/2", 7) == 0) *result = PGN_DRAW;
+    else if (length == 1 && token[0] == '*') *result = PGN_UNFINISHED;
+    else return false;
+
+    return true;
+}
+
+/*
++=============================================================================+
+|             Games                                                           |
++=============================================================================+
+*/
+
+/**
+ * @brief Reads a tag pair, the reader being at its opening bracket, and applies the "FEN" and "Result" tags.
+ *
+ * @param[out] tag_result Receives the value of the "Result" tag.
+ */
+static void parse_tag(pgn_reader_t *reader, pgn_game_t *game, pgn_result_t *tag_result) {
+    reader->offset++;
+    const char *name = reader->data + reader->offset;
+    const size_t name_length = get_token_length(reader);
+    reader->offset += name_length;
+
+    skip_spaces(reader);
+    if (is_at_end(reader) || reader->data[reader->offset] != '"') {
+        skip_past(reader, ']');
+        return;
+    }
+    reader->offset++;
+
+    char value[PGN_TAG_VALUE_LENGTH];
+    size_t value_length = 0;
+    while (!is_at_end(reader) && reader->data[reader->offset] != '"') {
+        if (reader->data[reader->offset] == '\\' && reader->offset + 1 < reader->size) reader->offset++;
+        if (value_length + 1 < sizeof(value)) value[value_length++] = reader->data[reader->offset];
+        reader->offset++;
+    }
+    value[value_length] = '\0';
+    skip_past(reader, ']');
+
+    if (name_length == 3 && memcmp(name, "FEN", 3) == 0) {
+        if (!load_fen_string(reader->state, value)) game->has_error = true;
+    } else if (name_length == 6 && memcmp(name, "Result", 6) == 0) {
+        if (!parse_result_token(value, value_length, tag_result)) *tag_result = PGN_UNFINISHED;
+    }
+}
+
+/**
+ * @brief Decodes a move and plays it, unless the game has already failed to decode.
+ */
+static void play_pgn_move(pgn_reader_t *reader, pgn_game_t *game, const char *token, size_t length,
+                          pgn_position_callback_t on_position, void *context) {
+    if (game->has_error) return;
+
+    char san[PGN_TOKEN_LENGTH];
+    if (length >= sizeof(san)) {
+        game->has_error = true;
+        return;
+    }
+    memcpy(san, token, length);
+    san[length] = '\0';
+
+    const arena_mark_t mark = get_arena_mark(reader->arena);
+    const move_t *move = find_arena_san_move(reader->state, san, reader->arena);
+
+    if (move == NULL) {
+        game->has_error = true;
+    } else {
+        if (on_position != NULL) on_position(context, reader->state, move);
+        play_move(reader->state, move);
+        game->ply_count++;
+    }
+
+    release_arena_to_mark(reader->arena, mark);
+}
+
+bool read_pgn_game(pgn_reader_t *reader, pgn_game_t *game, pgn_position_callback_t on_position, void *context) {
+    *game = (pgn_game_t){.result = PGN_UNFINISHED};
+    pgn_result_t tag_result = PGN_UNFINISHED;
+    bool has_content = false;
+    load_fen_string(reader->state, START_FEN);
+
+    // Tag pairs, and escaped lines starting with '%'
+    for (skip_spaces(reader); !is_at_end(reader); skip_spaces(reader)) {
+        const char c = reader->data[reader->offset];
+
+        if (c == '%' && is_at_line_start(reader)) {
+            skip_past(reader, '\n');
+        } else if (c == '[') {
+            has_content = true;
+            parse_tag(reader, game, &tag_result);
+        } else {
+            break;
+        }
+    }
+
+    // Movetext, up to the termination marker or the tags of the next game
+    bool is_terminated = false;
+    for (skip_spaces(reader); !is_at_end(reader) && !is_terminated; skip_spaces(reader)) {
+        const char c = reader->data[reader->offset];
+
+        if (c == '[') break;
+        if (c == '{') {
+            skip_past(reader, '}');
+            continue;
+        }
+        if (c == ';' || (c == '%' && is_at_line_start(reader))) {
+            skip_past(reader, '\n');
+            continue;
+        }
+        if (c == '(') {
+            reader->offset++;
+            skip_variation(reader);
+            continue;
+        }
+        if (c == '$') {
+            for (reader->offset++; !is_at_end(reader) && isdigit((unsigned char)reader->data[reader->offset]); reader->offset++) {}
+            continue;
+        }
+
+        const char *token = reader->data + reader->offset;
+        const size_t length = get_token_length(reader);
+        if (length == 0) {
+            // A stray closing bracket, parenthesis or brace
+            reader->offset++;
+            continue;
+        }
+
+        reader->offset += length;
+        has_content = true;
+
+        if (parse_result_token(token, length, &game->result)) {
+            is_terminated = true;
+            continue;
+        }
+
+        // A move number ("12", "12." or "12..."), which may be glued to its move; "0-0" is castling
+        size_t start = 0;
+        while (start < length && isdigit((unsigned char)token[start])) start++;
+        if (start < length && token[start] != '.') start = 0;
+        while (start < length && token[start] == '.') start++;
+
+        if (start < length) play_pgn_move(reader, game, token + start, length - start, on_position, context);
+    }
+
+    if (!is_terminated) game->result = tag_result;
+    return has_content;
+}
@@ -0,0 +1,107 @@
+/* iMate -- Copyright (C) 2024 Martin Newbound */
+
+/**
+ * @file PgnReader.h
+ * @brief This file contains the declarations of the streaming reader of PGN (Portable Game Notation) files.
+ *
+ * @details The file is mapped into memory and read front to back, one game at a time, so files of any size are
+ * read without loading them. The "FEN" and "Result" tags are interpreted and the other tags skipped. The moves
+ * are decoded from standard algebraic notation with find_arena_san_move and played on the reader's own state,
+ * and the caller sees every position with the move played from it. Comments, variations, numeric annotation
+ * glyphs and move numbers are skipped.
+ *
+ * A move which cannot be decoded ends the decoding of its game: the rest of the game is skipped and the game is
+ * flagged, and reading carries on with the next game.
+ *
+ * @version 1.0.0
+ * @author Martin Newbound
+ * @date 2024
+ *
+ * @note License:
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef PGN_READER_H
+#define PGN_READER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "../State/GameState.h"
+#include "Move.h"
+#include <stdbool.h>
+
+typedef enum {
+    PGN_WHITE_WINS,
+    PGN_DRAW,
+    PGN_BLACK_WINS,
+    PGN_UNFINISHED          // "*", or no result given
+} pgn_result_t;
+
+/**
+ * @brief What is known of a game once it has been read.
+ */
+typedef struct {
+    pgn_result_t result;    // the game termination marker, or the "Result" tag when the marker is missing
+    int ply_count;          // the number of moves decoded
+    bool has_error;         // the starting position or a move could not be decoded
+} pgn_game_t;
+
+// A PGN file mapped into memory, and the state of the game being read
+typedef struct pgn_reader pgn_reader_t;
+
+/**
+ * @brief Called for every position of a game, before its move is played.
+ *
+ * @param context The context given to read_pgn_game.
+ * @param state The position.
+ * @param move The move played from the position, valid for the duration of the call.
+ */
+typedef void (*pgn_position_callback_t)(void *context, const state_t *state, const move_t *move);
+
+/**
+ * Opens a PGN file.
+ *
+ * @param path The file.
+ * @return The reader, or NULL if the file cannot be mapped.
+ *
+ * @warning The caller is responsible for closing the reader with close_pgn_file.
+ */
+pgn_reader_t *open_pgn_file(const char *path);
+
+/**
+ * Closes a PGN file.
+ *
+ * @param reader The reader.
+ */
+void close_pgn_file(pgn_reader_t *reader);
+
+/**
+ * Reads the next game of a PGN file.
+ *
+ * @param reader The reader.
+ * @param[out] game Receives the result and the number of moves of the game.
+ * @param on_position Called for every position of the game, may be NULL.
+ * @param context Passed to on_position.
+ * @return false once there are no more games.
+ */
+bool read_pgn_game(pgn_reader_t *reader, pgn_game_t *game, pgn_position_callback_t on_position, void *context);
+
+/**
+ * Returns how far a reader has read through its file.
+ *
+ * @param reader The reader.
+ * @param[out] size Receives the size of the file in bytes, may be NULL.
+ * @return The number of bytes read.
+ */
+size_t get_pgn_file_offset(const pgn_reader_t *reader, size_t *size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PGN_READER_H
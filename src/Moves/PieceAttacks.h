@@ -0,0 +1,99 @@
+/* iMate -- Copyright (C) 2024 Martin Newbound */
+
+/**
+ * @file PieceAttacks.h
+ * @brief This file contains the attack sets of the pieces which do not slide (pawns, knights and kings).
+ *
+ * @details The attacks are computed set-wise with shifts: every function takes a bitboard of any number of
+ * pieces and returns the union of the squares they attack, masking the files a shift would wrap around. A
+ * single piece is passed as a single-bit bitboard. The sliders have their lookups in SliderAttacks.h.
+ *
+ * @version 1.0.0
+ * @author Martin Newbound
+ * @date 2024
+ *
+ * @note License:
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef PIECE_ATTACKS_H
+#define PIECE_ATTACKS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "../State/GameState.h"
+#include <stdint.h>
+
+#define NOT_FILE_A_MASK  0xFEFEFEFEFEFEFEFEULL
+#define NOT_FILE_AB_MASK 0xFCFCFCFCFCFCFCFCULL
+#define NOT_FILE_H_MASK  0x7F7F7F7F7F7F7F7FULL
+#define NOT_FILE_GH_MASK 0x3F3F3F3F3F3F3F3FULL
+
+/**
+ * Computes the squares attacked by a set of knights.
+ *
+ * @param knights The squares of the knights.
+ * @return The squares attacked, own pieces included.
+ */
+static inline uint64_t get_knight_attacks(uint64_t knights) {
+    return ((knights << 17 | knights >> 15) & NOT_FILE_A_MASK)
+         | ((knights << 15 | knights >> 17) & NOT_FILE_H_MASK)
+         | ((knights << 10 | knights >> 6) & NOT_FILE_AB_MASK)
+         | ((knights << 6 | knights >> 10) & NOT_FILE_GH_MASK);
+}
+
+/**
+ * Computes the squares attacked by a set of kings.
+ *
+ * @param kings The squares of the kings.
+ * @return The squares attacked, own pieces included.
+ */
+static inline uint64_t get_king_attacks(uint64_t kings) {
+    const uint64_t sideways = ((kings << 1) & NOT_FILE_A_MASK) | ((kings >> 1) & NOT_FILE_H_MASK);
+    const uint64_t rank = kings | sideways;
+    return sideways | rank << 8 | rank >> 8;
+}
+
+/**
+ * Computes the squares a set of pawns attacks towards the a file (from the point of view of white).
+ *
+ * @param pawns The squares of the pawns.
+ * @param color The color of the pawns.
+ * @return The squares attacked.
+ */
+static inline uint64_t get_pawn_west_attacks(uint64_t pawns, color_t color) {
+    return (color == WHITE ? pawns << 7 : pawns >> 9) & NOT_FILE_H_MASK;
+}
+
+/**
+ * Computes the squares a set of pawns attacks towards the h file (from the point of view of white).
+ *
+ * @param pawns The squares of the pawns.
+ * @param color The color of the pawns.
+ * @return The squares attacked.
+ */
+static inline uint64_t get_pawn_east_attacks(uint64_t pawns, color_t color) {
+    return (color == WHITE ? pawns << 9 : pawns >> 7) & NOT_FILE_A_MASK;
+}
+
+/**
+ * Computes the squares attacked by a set of pawns.
+ *
+ * @param pawns The squares of the pawns.
+ * @param color The color of the pawns.
+ * @return The squares attacked.
+ */
+static inline uint64_t get_pawn_attacks(uint64_t pawns, color_t color) {
+    return get_pawn_west_attacks(pawns, color) | get_pawn_east_attacks(pawns, color);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PIECE_ATTACKS_H
@@ -2,22 +2,82 @@
 
 
 #include "../MoveGeneration.h"
-#include <stdlib.h>
+#include "../PieceAttacks.h"
+
+// Squares which must be empty for each castle (indexed by castle_t)
+static const uint64_t CASTLING_EMPTY_MASKS[4] = {
+    0x0000000000000060ULL,  // f1 g1
+    0x000000000000000EULL,  // b1 c1 d1
+    0x6000000000000000ULL,  // f8 g8
+    0x0E00000000000000ULL   // b8 c8 d8
+};
+
+// Squares the king passes over (and lands on) for each castle, none of which may be attacked
+static const uint64_t CASTLING_PASSING_SQUARES[4][2] = {
+    {0x0000000000000020ULL, 0x0000000000000040ULL},  // f1 g1
+    {0x0000000000000008ULL, 0x0000000000000004ULL},  // d1 c1
+    {0x2000000000000000ULL, 0x4000000000000000ULL},  // f8 g8
+    {0x0800000000000000ULL, 0x0400000000000000ULL}   // d8 c8
+};
+
+// Squares the rook starts on for each castle
+static const uint64_t CASTLING_ROOK_SQUARES[4] = {
+    0x0000000000000080ULL,  // h1
+    0x0000000000000001ULL,  // a1
+    0x8000000000000000ULL,  // h8
+    0x0100000000000000ULL   // a8
+};
 
 /**
  * @brief Handles the generation of castling moves.
  *
  * This function generates all possible castling moves for a given color, and adds them to a move collection.
+ * A castle is only generated when the right is held, the rook is in place, the squares between king and rook
+ * are empty, and the king is not in check and does not pass over or land on an attacked square.
  *
+ * @param state The current game state.
  * @param collection The move collection to add the moves to.
+ * @param square_key The key of the square the king is on.
  * @param color_to_move The color of the player to move.
- * 
- * @todo Implement this function.
+ * @param attacked The squares the opponent attacks.
  */
-void handle_castling(move_collection_t *collection, color_t color_to_move) {
-    // Implementation goes here
+static void handle_castling(const state_t *state, move_collection_t *collection, uint64_t square_key, color_t color_to_move,
+                            uint64_t attacked) {
+    const uint64_t occupancy = get_state_occupancy(state);
+    const uint64_t rook_bitboard = get_state_peice_bitboard(state, PIECE_ROOK, color_to_move);
+    const int color_offset = (color_to_move == WHITE) ? 0 : 2;
+
+    if (attacked & square_key) return;
+
+    for (castle_t castle = CASTLE_KINGSIDE_WHITE + color_offset; castle <= CASTLE_QUEENSIDE_WHITE + color_offset; castle++) {
+        if (!state_can_castle(state, castle)) continue;
+        if (!(rook_bitboard & CASTLING_ROOK_SQUARES[castle])) continue;
+        if (occupancy & CASTLING_EMPTY_MASKS[castle]) continue;
+        if (attacked & (CASTLING_PASSING_SQUARES[castle][0] | CASTLING_PASSING_SQUARES[castle][1])) continue;
+
+        flags_t flags = {
+            .castle = castle,
+            .double_pawn_push = false,
+            .promotion_piece = NULL_PIECE,
+            .king_moved = true,
+            .kingside_rook_moved = false,
+            .queenside_rook_moved = false
+        };
+
+        push_new_move_to_collection(square_key, CASTLING_PASSING_SQUARES[castle][1], flags, collection);
+    }
 }
 
+// King moves revoke both castling rights
+static const flags_t KING_FLAGS = {
+    .castle = NULL_CASTLE,
+    .double_pawn_push = false,
+    .promotion_piece = NULL_PIECE,
+    .king_moved = true,
+    .kingside_rook_moved = false,
+    .queenside_rook_moved = false
+};
+
 /**
  * @brief Generates all possible king moves on a given square.
  *
@@ -30,29 +90,25 @@ void handle_castling(move_collection_t *collection, color_t color_to_move) {
  */
 void gen_king_moves_on_square(const state_t *state, move_collection_t *collection, uint64_t square_key) {
     const color_t color_to_move = get_state_to_move_color(state);
+    const uint64_t targets = get_king_attacks(square_key) & ~states_color_bitboard(state, color_to_move);
 
-    flags_t flags = {
-        .castle = NULL_CASTLE,
-        .double_pawn_push = false,
-        .promotion_piece = false,
-        .king_moved = true,
-        .kingside_rook_moved = false,
-        .queenside_rook_moved = false
-    };
-
-    // King move offsets (in terms of squares)
-    int offsets[] = {-9, -8, -7, -1, 1, 7, 8, 9};
-    int num_offsets = sizeof(offsets) / sizeof(offsets[0]);
-
-    for (int i = 0; i < num_offsets; i++) {
-        int64_t to_square = square_key + offsets[i];
-
-        // Check if the move is within the board and doesn't wrap around
-        if (to_square >= 0 && to_square < 64 && abs((to_square % 8) - (square_key % 8)) <= 1) {
-            move_t const *move = new_move(square_key, to_square, flags);
-            push_move_to_collection(move, collection);
-        }
-    }
+    push_new_moves_to_collection(square_key, targets, KING_FLAGS, collection);
+    handle_castling(state, collection, square_key, color_to_move, get_attacked_squares_bitboard(state));
+}
+
+/**
+ * @brief Generates the moves of the king of the player to move, castling included.
+ *
+ * @param state The current game state.
+ * @param collection The move collection to add the moves to.
+ * @param targets The squares the king may move to (castling is not limited by them).
+ * @param attacked The squares the opponent attacks, which decide whether the king may castle.
+ */
+void gen_king_moves(const state_t *state, move_collection_t *collection, uint64_t targets, uint64_t attacked) {
+    const color_t color_to_move = get_state_to_move_color(state);
+    const uint64_t square_key = get_state_peice_bitboard(state, PIECE_KING, color_to_move);
+    if (!square_key) return;
 
-    handle_castling(collection, color_to_move);
-}
\ No newline at end of file
+    push_new_moves_to_collection(square_key, get_king_attacks(square_key) & targets, KING_FLAGS, collection);
+    handle_castling(state, collection, square_key, color_to_move, attacked);
+}
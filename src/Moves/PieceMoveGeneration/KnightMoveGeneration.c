@@ -2,7 +2,18 @@
 
 
 #include "../MoveGeneration.h"
-#include <stdlib.h>
+#include "../PieceAttacks.h"
+#include "../../Utils/BitOperations.h"
+
+// Knight moves carry no flags
+static const flags_t KNIGHT_FLAGS = {
+    .castle = NULL_CASTLE,
+    .double_pawn_push = false,
+    .promotion_piece = NULL_PIECE,
+    .king_moved = false,
+    .kingside_rook_moved = false,
+    .queenside_rook_moved = false
+};
 
 /**
  * @brief Generates all possible knight moves on a given square.
@@ -14,28 +25,22 @@
  * @param square_key The key of the square the knight is on.
  */
 void gen_knight_moves_on_square(const state_t *state, move_collection_t *collection, uint64_t square_key) {
-    const color_t color_to_move = get_state_to_move_color(state);
-
-    flags_t flags = {
-        .castle = NULL_CASTLE,
-        .double_pawn_push = false,
-        .promotion_piece = false,
-        .king_moved = false,
-        .kingside_rook_moved = false,
-        .queenside_rook_moved = false
-    };
+    const uint64_t targets = get_knight_attacks(square_key) & ~states_color_bitboard(state, get_state_to_move_color(state));
+    push_new_moves_to_collection(square_key, targets, KNIGHT_FLAGS, collection);
+}
 
-    // Knight move offsets (in terms of squares)
-    int offsets[] = {-17, -15, -10, -6, 6, 10, 15, 17};
-    int num_offsets = sizeof(offsets) / sizeof(offsets[0]);
-
-    for (int i = 0; i < num_offsets; i++) {
-        int64_t to_square = square_key + offsets[i];
+/**
+ * @brief Generates the moves of every knight of the player to move.
+ *
+ * @param state The current game state.
+ * @param collection The move collection to add the moves to.
+ * @param targets The squares the knights may move to.
+ */
+void gen_knight_moves(const state_t *state, move_collection_t *collection, uint64_t targets) {
+    uint64_t knights = get_state_peice_bitboard(state, PIECE_KNIGHT, get_state_to_move_color(state));
 
-        // Check if the move is within the board and doesn't wrap around
-        if (to_square >= 0 && to_square < 64 && abs((to_square % 8) - (square_key % 8)) <= 2) {
-            move_t const *move = new_move(square_key, to_square, flags);
-            push_move_to_collection(move, collection);
-        }
+    while (knights) {
+        const uint64_t square_key = 1ULL << pop_lsb(&knights);
+        push_new_moves_to_collection(square_key, get_knight_attacks(square_key) & targets, KNIGHT_FLAGS, collection);
     }
-}
\ No newline at end of file
+}
@@ -1,32 +1,25 @@
 /* iMate -- Copyright (C) 2024 Martin Newbound */
 
 #include "../MoveGeneration.h"
+#include "../PieceAttacks.h"
+#include "../../Utils/BitOperations.h"
 
 
 // Masks for identifying promotion rows for white and black pawns
-#define WHITE_PROMOTION_MASK 0xFF00000000000000
-#define BLACK_PROMOTION_MASK 0x00000000000000FF
+#define WHITE_PROMOTION_MASK 0xFF00000000000000ULL
+#define BLACK_PROMOTION_MASK 0x00000000000000FFULL
 
-// Masks for identifying starting rows for white and black pawns
-#define WHITE_STARTING_ROW_MASK 0x000000000000FF00
-#define BLACK_STARTING_ROW_MASK 0x00FF000000000000
+// Masks for identifying the rows white and black pawns land on after a double push
+#define WHITE_DOUBLE_PUSH_ROW_MASK 0x00000000FF000000ULL
+#define BLACK_DOUBLE_PUSH_ROW_MASK 0x000000FF00000000ULL
 
-// Macros for identifying left and right side of the board depending on the color
-#define LHS_RANK_MASK(COLOR) ((COLOR == WHITE) ? 0x00000000000000FF : 0xFF00000000000000)
-#define RHS_RANK_MASK(COLOR) ((COLOR == WHITE) ? 0x000000000000FF00 : 0x00FF000000000000)
+// Macro for moving pawns forward depending on the color
+#define MOVE_FORWARD(BITBOARD, COLOR) ((COLOR == WHITE) ? (BITBOARD) << 8 : (BITBOARD) >> 8)
 
-// Macros for moving a pawn forward and capturing to the left or right depending on the color
-#define MOVE_FORWARD(BITBOARD, COLOR) ((COLOR == WHITE) ? BITBOARD << 8 : BITBOARD >> 8)
-#define CAPTURE_LEFT(BITBOARD, COLOR) ((COLOR == WHITE) ? BITBOARD << 7 : BITBOARD >> 9)
-#define CAPTURE_RIGHT(BITBOARD, COLOR) ((COLOR == WHITE) ? BITBOARD << 9 : BITBOARD >> 7)
-
-// Macros for moving a pawn to the left or right on the same rank depending on the color
-#define LEFT_ON_RANK(BITBOARD, COLOR) ((COLOR == WHITE) ? BITBOARD << 1 : BITBOARD >> 1)
-#define RIGHT_ON_RANK(BITBOARD, COLOR) ((COLOR == WHITE) ? BITBOARD >> 1 : BITBOARD << 1)
-
-// Macros for checking if a pawn is on its starting or promotion row depending on the color
-#define IS_ON_STARTING_ROW(BITBOARD, COLOR) ((COLOR == WHITE) ? (BITBOARD & WHITE_STARTING_ROW_MASK) : (BITBOARD & BLACK_STARTING_ROW_MASK))
-#define IS_ON_PROMOTION_ROW(BITBOARD, COLOR) ((COLOR == WHITE) ? (BITBOARD & WHITE_PROMOTION_MASK) : (BITBOARD & BLACK_PROMOTION_MASK))
+// Square offsets of a pawn move forward and of its captures to the left (a file) and right (h file)
+#define FORWARD_OFFSET(COLOR) ((COLOR == WHITE) ? 8 : -8)
+#define CAPTURE_LEFT_OFFSET(COLOR) ((COLOR == WHITE) ? 7 : -9)
+#define CAPTURE_RIGHT_OFFSET(COLOR) ((COLOR == WHITE) ? 9 : -7)
 
 /**
  * Creates a flags_t struct with the given parameters.
@@ -37,6 +30,7 @@
 flags_t create_pawn_flags(bool double_pawn_push, piece_t promotion_piece) {
     flags_t flags = {
         .castle = NULL_CASTLE,
+        .en_passant_square = 0,
         .double_pawn_push = double_pawn_push,
         .promotion_piece = promotion_piece,
         .king_moved = false,
@@ -47,111 +41,70 @@ flags_t create_pawn_flags(bool double_pawn_push, piece_t promotion_piece) {
 }
 
 /**
- * Handles the case where a pawn reaches the promotion row.
+ * Adds a move for every destination square of a set, each from the square a fixed offset behind it.
+ * Destinations on the promotion row are added once per promotion piece.
  * @param collection The collection of moves.
- * @param square_key The key of the square where the pawn is located.
- * @param to_square The square where the pawn is moving to.
- * @param color_to_move The color of the pawn.
- * @return A boolean indicating if the pawn reached the promotion row.
+ * @param to_squares The squares the pawns move to.
+ * @param offset The offset from the square of a pawn to its destination.
+ * @param promotion_row The promotion row of the pawns.
  */
-bool handle_promotion_case(move_collection_t *collection, uint64_t square_key, uint64_t to_square, color_t color_to_move) {
-    if(!IS_ON_PROMOTION_ROW(to_square, color_to_move)) return false;
+static void push_pawn_moves(move_collection_t *collection, uint64_t to_squares, int offset, uint64_t promotion_row) {
+    const flags_t flags = create_pawn_flags(false, NULL_PIECE);
 
-    for (piece_t piece = PIECE_ROOK; piece <= PIECE_QUEEN; ++piece) {
-        flags_t flags = create_pawn_flags(false, piece);
-        move_t const *move = new_move(square_key, to_square, flags);
-        push_move_to_collection(move, collection);
+    for (uint64_t moves = to_squares & ~promotion_row; moves; ) {
+        const int to_index = pop_lsb(&moves);
+        push_new_move_to_collection(1ULL << (to_index - offset), 1ULL << to_index, flags, collection);
     }
 
-    return true;
-}
-
-/**
- * Handles the case where a pawn moves forward by one square.
- * @param collection The collection of moves.
- * @param square_key The key of the square where the pawn is located.
- * @param color_to_move The color of the pawn.
- * @param opponent_bitboard The bitboard of the opponent.
- */
-void handle_single_move_forward(move_collection_t *collection, uint64_t square_key, color_t color_to_move, uint64_t opponent_bitboard) {
-    uint64_t forward_one = MOVE_FORWARD(square_key, color_to_move);
-    forward_one &= ~opponent_bitboard;  // make sure it is not blocked
-
-    if (forward_one == 0) return;
-    if (handle_promotion_case(collection, square_key, forward_one, color_to_move)) return;
-
-    flags_t flags = create_pawn_flags(false, NULL_PIECE);
-    move_t const *move = new_move(square_key, forward_one, flags);
-    push_move_to_collection(move, collection);
-}
-
-/**
- * Handles the case where a pawn moves forward by two squares.
- * @param collection The collection of moves.
- * @param square_key The key of the square where the pawn is located.
- * @param color_to_move The color of the pawn.
- * @param opponent_bitboard The bitboard of the opponent.
- */
-void handle_double_move_forward(move_collection_t *collection, uint64_t square_key, color_t color_to_move, uint64_t opponent_bitboard) {
-    if (!IS_ON_STARTING_ROW(square_key, color_to_move)) return;
-    
-    uint64_t forward_one = MOVE_FORWARD(square_key, color_to_move);
-    forward_one &= ~opponent_bitboard;  // make sure it is not blocked
-
-    uint64_t forward_two = MOVE_FORWARD(forward_one, color_to_move);
-    forward_two &= ~opponent_bitboard;  // make sure it is not blocked
-
-    if (forward_two == 0) return;
-
-    flags_t flags = create_pawn_flags(true, NULL_PIECE);
-    move_t const *move = new_move(square_key, forward_two, flags);
-    push_move_to_collection(move, collection);
-}
-
-/**
- * Handles the case where a pawn captures an opponent's piece.
- * @param collection The collection of moves.
- * @param square_key The key of the square where the pawn is located.
- * @param color_to_move The color of the pawn.
- * @param opponent_bitboard The bitboard of the opponent.
- */
-void handle_capturing(move_collection_t *collection, uint64_t square_key, color_t color_to_move, uint64_t opponent_bitboard) {
-    flags_t flags = create_pawn_flags(false, NULL_PIECE);
-
-    uint64_t capture_moves[] = {CAPTURE_LEFT(square_key, color_to_move), CAPTURE_RIGHT(square_key, color_to_move)};
-    uint64_t rank_masks[] = {LHS_RANK_MASK(color_to_move), RHS_RANK_MASK(color_to_move)};
-
-    for (int i = 0; i < 2; ++i) {
-        if ((square_key & rank_masks[i]) == 0 && (capture_moves[i] & opponent_bitboard)) {
-            move_t const *move = new_move(square_key, capture_moves[i], flags);
-            push_move_to_collection(move, collection);
+    for (uint64_t promotions = to_squares & promotion_row; promotions; ) {
+        const int to_index = pop_lsb(&promotions);
+        for (piece_t piece = PIECE_ROOK; piece <= PIECE_QUEEN; ++piece) {
+            push_new_move_to_collection(1ULL << (to_index - offset), 1ULL << to_index, create_pawn_flags(false, piece), collection);
         }
     }
 }
 
 /**
- * Handles the case where a pawn captures an opponent's pawn en passant.
+ * Generates the moves of a set of pawns of the player to move.
+ * 
+ * The destinations of each kind of move are computed for all the pawns at once by shifting their bitboard,
+ * then unpacked into moves.
  * @param state The current state of the game.
  * @param collection The collection of moves.
- * @param square_key The key of the square where the pawn is located.
- * @param color_to_move The color of the pawn.
+ * @param pawns The squares of the pawns.
+ * @param targets The squares the pawns may move to. An en passant capture is also made when the pawn it
+ * captures stands on one of them.
  */
-void handle_en_passant(const state_t *state, move_collection_t *collection, uint64_t square_key, color_t color_to_move) {
-    if (!is_en_passant_target_active(state)) return;
-    uint64_t en_passant_target = get_en_passant_target(state);
+static void add_pawn_moves(const state_t *state, move_collection_t *collection, uint64_t pawns, uint64_t targets) {
+    const color_t color_to_move = get_state_to_move_color(state);
+    const uint64_t opponent_bitboard = states_color_bitboard(state, (color_to_move == WHITE) ? BLACK : WHITE);
+    const uint64_t empty_bitboard = ~get_state_occupancy(state);
+    const uint64_t promotion_row = (color_to_move == WHITE) ? WHITE_PROMOTION_MASK : BLACK_PROMOTION_MASK;
+    const int forward = FORWARD_OFFSET(color_to_move);
+
+    const uint64_t single_pushes = MOVE_FORWARD(pawns, color_to_move) & empty_bitboard;
+    uint64_t double_pushes = MOVE_FORWARD(single_pushes, color_to_move) & empty_bitboard & targets
+                           & ((color_to_move == WHITE) ? WHITE_DOUBLE_PUSH_ROW_MASK : BLACK_DOUBLE_PUSH_ROW_MASK);
+    const uint64_t left_captures = get_pawn_west_attacks(pawns, color_to_move);
+    const uint64_t right_captures = get_pawn_east_attacks(pawns, color_to_move);
+
+    while (double_pushes) {
+        const int to_index = pop_lsb(&double_pushes);
+        flags_t flags = create_pawn_flags(true, NULL_PIECE);
+        flags.en_passant_square = 1ULL << (to_index - forward);  // the skipped square becomes the en passant target
+        push_new_move_to_collection(1ULL << (to_index - 2 * forward), 1ULL << to_index, flags, collection);
+    }
 
-    flags_t flags = create_pawn_flags(false, NULL_PIECE);
+    push_pawn_moves(collection, single_pushes & targets, forward, promotion_row);
 
-    uint64_t capture_moves[] = {CAPTURE_LEFT(square_key, color_to_move), CAPTURE_RIGHT(square_key, color_to_move)};
-    uint64_t rank_masks[] = {LHS_RANK_MASK(color_to_move), RHS_RANK_MASK(color_to_move)};
-    uint64_t rank_moves[] = {LEFT_ON_RANK(square_key, color_to_move), RIGHT_ON_RANK(square_key, color_to_move)};
+    // An en passant capture lands on the target square, which is always empty, and removes the pawn behind it
+    const uint64_t en_passant_target = get_en_passant_target(state);
+    const uint64_t en_passant_pawn = (color_to_move == WHITE) ? en_passant_target >> 8 : en_passant_target << 8;
+    uint64_t capture_targets = opponent_bitboard & targets;
+    if ((en_passant_target | en_passant_pawn) & targets) capture_targets |= en_passant_target;
 
-    for (int i = 0; i < 2; ++i) {
-        if ((square_key & rank_masks[i]) == 0 && en_passant_target == rank_moves[i]) {
-            move_t const *move = new_move(square_key, capture_moves[i], flags);
-            push_move_to_collection(move, collection);
-        }
-    }
+    push_pawn_moves(collection, left_captures & capture_targets, CAPTURE_LEFT_OFFSET(color_to_move), promotion_row);
+    push_pawn_moves(collection, right_captures & capture_targets, CAPTURE_RIGHT_OFFSET(color_to_move), promotion_row);
 }
 
 /**
@@ -161,11 +114,15 @@ void handle_en_passant(const state_t *state, move_collection_t *collection, uint
  * @param square_key The key of the square where the pawn is located.
  */
 void gen_pawn_moves_on_square(const state_t *state, move_collection_t *collection, uint64_t square_key) {
-    const color_t color_to_move = get_state_to_move_color(state);
-    const uint64_t opponent_bitboard = states_color_bitboard(state, (color_to_move == WHITE) ? BLACK : WHITE);
+    add_pawn_moves(state, collection, square_key, ~0ULL);
+}
 
-    handle_double_move_forward(collection, square_key, color_to_move, opponent_bitboard);
-    handle_single_move_forward(collection, square_key, color_to_move, opponent_bitboard);
-    handle_capturing(collection, square_key, color_to_move, opponent_bitboard);
-    handle_en_passant(state, collection, square_key, color_to_move);
-}
\ No newline at end of file
+/**
+ * Generates the moves of every pawn of the player to move.
+ * @param state The current state of the game.
+ * @param collection The collection of moves.
+ * @param targets The squares the pawns may move to (see add_pawn_moves).
+ */
+void gen_pawn_moves(const state_t *state, move_collection_t *collection, uint64_t targets) {
+    add_pawn_moves(state, collection, get_state_peice_bitboard(state, PIECE_PAWN, get_state_to_move_color(state)), targets);
+}
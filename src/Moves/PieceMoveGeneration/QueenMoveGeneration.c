@@ -2,22 +2,49 @@
 
 
 #include "../MoveGeneration.h"
+#include "../SliderAttacks.h"
+#include "../../Utils/BitOperations.h"
 
-// Forward declarations
-void gen_rook_moves_on_square(const state_t *state, move_collection_t *collection, uint64_t square_key);
-void gen_bishop_moves_on_square(const state_t *state, move_collection_t *collection, uint64_t square_key);
+// Queen moves carry no flags
+static const flags_t QUEEN_FLAGS = {
+    .castle = NULL_CASTLE,
+    .double_pawn_push = false,
+    .promotion_piece = NULL_PIECE,
+    .king_moved = false,
+    .kingside_rook_moved = false,
+    .queenside_rook_moved = false
+};
 
 /**
  * Generates all possible moves for a queen on a given square.
  * The queen's movement is a combination of a rook's and a bishop's movements,
- * so this function simply calls the functions to generate rook and bishop moves.
+ * so its attacks are the union of both lookups.
  * 
  * @param state The current state of the game.
  * @param collection The collection of moves.
  * @param square_key The key of the square where the queen is located.
  */
 void gen_queen_moves_on_square(const state_t *state, move_collection_t *collection, uint64_t square_key) {
-    // treat as rook and bishop combined
-    gen_rook_moves_on_square(state, collection, square_key);
-    gen_bishop_moves_on_square(state, collection, square_key);
-}
\ No newline at end of file
+    const uint64_t targets = get_queen_attacks(lsb_index(square_key), get_state_occupancy(state))
+                           & ~states_color_bitboard(state, get_state_to_move_color(state));
+
+    push_new_moves_to_collection(square_key, targets, QUEEN_FLAGS, collection);
+}
+
+/**
+ * Generates the moves of every queen of the player to move.
+ * 
+ * @param state The current state of the game.
+ * @param collection The collection of moves.
+ * @param targets The squares the queens may move to.
+ */
+void gen_queen_moves(const state_t *state, move_collection_t *collection, uint64_t targets) {
+    const uint64_t occupancy = get_state_occupancy(state);
+    uint64_t queens = get_state_peice_bitboard(state, PIECE_QUEEN, get_state_to_move_color(state));
+
+    while (queens) {
+        const int square_index = pop_lsb(&queens);
+        push_new_moves_to_collection(1ULL << square_index, get_queen_attacks(square_index, occupancy) & targets,
+                                     QUEEN_FLAGS, collection);
+    }
+}
@@ -2,13 +2,12 @@
 
 
 #include "../MoveGeneration.h"
+#include "../SliderAttacks.h"
+#include "../../Utils/BitOperations.h"
 
 // Define masks for the king and queen side rooks for both colors
-#define KINGSIDE_ROOK_MASK(COLOR) ((COLOR == WHITE) ? 0x0000000000000080 : 0x8000000000000000)
-#define QUEENSIDE_ROOK_MASK(COLOR) ((COLOR == WHITE) ? 0x0000000000000010 : 0x1000000000000000)
-
-// Define a macro to shift a bitboard in a given direction
-#define SHIFT_IN_DIRECTION(BITBOARD, DIRECTION) (DIRECTION < 0) ? (BITBOARD << -DIRECTION) : (BITBOARD >> -DIRECTION)
+#define KINGSIDE_ROOK_MASK(COLOR) ((COLOR == WHITE) ? 0x0000000000000080ULL : 0x8000000000000000ULL)
+#define QUEENSIDE_ROOK_MASK(COLOR) ((COLOR == WHITE) ? 0x0000000000000001ULL : 0x0100000000000000ULL)
 
 /**
  * Creates flags for a rook move.
@@ -31,47 +30,36 @@ flags_t create_rook_flags(uint64_t from_square, color_t get_state_to_move_color)
 }
 
 /**
- * Handles a rook move or capture.
+ * Generates all possible moves for a rook on a given square.
  * 
+ * @param state The current state of the game.
  * @param collection The collection of moves.
  * @param square_key The key of the square where the rook is located.
- * @param opponent_bitboard The bitboard of the opponent's pieces.
- * @param color_to_move The color of the rook.
- * @param shift_direction The direction to shift the bitboard.
  */
-void handle_rook_move_or_capture(move_collection_t *collection, uint64_t square_key, uint64_t opponent_bitboard, color_t color_to_move, int shift_direction) {
-    const uint64_t rank_mask = 0xFF << (8 * (square_key / 8));
-    const uint64_t file_mask = 0x0101010101010101ULL << (square_key % 8);
-
-    const uint64_t constraint_mask = rank_mask | file_mask;
-
-    uint64_t next_move = SHIFT_IN_DIRECTION(next_move, shift_direction);
+void gen_rook_moves_on_square(const state_t *state, move_collection_t *collection, uint64_t square_key) {
+    const color_t color_to_move = get_state_to_move_color(state);
+    const uint64_t targets = get_rook_attacks(lsb_index(square_key), get_state_occupancy(state))
+                           & ~states_color_bitboard(state, color_to_move);
 
-    while (next_move & constraint_mask > 0) {
-        flags_t flags = create_rook_flags(square_key, color_to_move);
-        move_t const *move = new_move(square_key, next_move, flags);
-        push_move_to_collection(move, collection);
-        
-        if (next_move & opponent_bitboard > 0) break;
-        next_move = SHIFT_IN_DIRECTION(next_move, shift_direction);
-    }   
+    push_new_moves_to_collection(square_key, targets, create_rook_flags(square_key, color_to_move), collection);
 }
 
 /**
- * Generates all possible moves for a rook on a given square.
+ * Generates the moves of every rook of the player to move.
  * 
  * @param state The current state of the game.
  * @param collection The collection of moves.
- * @param square_key The key of the square where the rook is located.
+ * @param targets The squares the rooks may move to.
  */
-void gen_rook_moves_on_square(const state_t *state, move_collection_t *collection, uint64_t square_key) {
+void gen_rook_moves(const state_t *state, move_collection_t *collection, uint64_t targets) {
     const color_t color_to_move = get_state_to_move_color(state);
-    const uint64_t opponent_bitboard = states_color_bitboard(state, (color_to_move == WHITE) ? BLACK : WHITE);
-
-    int directions[] = {8, -8, 1, -1};
-    int num_directions = sizeof(directions) / sizeof(directions[0]);
+    const uint64_t occupancy = get_state_occupancy(state);
+    uint64_t rooks = get_state_peice_bitboard(state, PIECE_ROOK, color_to_move);
 
-    for (int i = 0; i < num_directions; i++) {
-        handle_rook_move_or_capture(collection, square_key, opponent_bitboard, color_to_move, directions[i]);
+    while (rooks) {
+        const int square_index = pop_lsb(&rooks);
+        const uint64_t square_key = 1ULL << square_index;
+        push_new_moves_to_collection(square_key, get_rook_attacks(square_index, occupancy) & targets,
+                                     create_rook_flags(square_key, color_to_move), collection);
     }
-}
\ No newline at end of file
+}
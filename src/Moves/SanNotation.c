@@ -0,0 +1,288 @@
+/* iMate -- Copyright (C) 2024 Martin Newbound */
+
+#include "SanNotation.h"
+#include "MoveGeneration.h"
+#include "../Utils/BitOperations.h"
+#include <string.h>
+
+#define SQUARE_INDEX(SQUARE) lsb_index(SQUARE)
+#define FILE_OF(INDEX) ((INDEX) % 8)
+#define RANK_OF(INDEX) ((INDEX) / 8)
+
+// Arena of san_to_move_key: the moves of the designated pieces and a work state
+#define SAN_ARENA_BLOCK_SIZE 8192
+
+// SAN letters of the pieces, indexed by piece_t (pawns have no letter)
+static const char PIECE_LETTERS[] = {'\0', 'R', 'N', 'B', 'Q', 'K', '\0'};
+
+// Generators of the pseudo legal moves of the piece on a square (see PieceMoveGeneration), indexed by piece_t
+void gen_pawn_moves_on_square(const state_t *state, move_collection_t *collection, uint64_t square_key);
+void gen_rook_moves_on_square(const state_t *state, move_collection_t *collection, uint64_t square_key);
+void gen_knight_moves_on_square(const state_t *state, move_collection_t *collection, uint64_t square_key);
+void gen_bishop_moves_on_square(const state_t *state, move_collection_t *collection, uint64_t square_key);
+void gen_queen_moves_on_square(const state_t *state, move_collection_t *collection, uint64_t square_key);
+void gen_king_moves_on_square(const state_t *state, move_collection_t *collection, uint64_t square_key);
+
+static void (*const SQUARE_MOVE_GENERATORS[6])(const state_t *, move_collection_t *, uint64_t) = {
+    gen_pawn_moves_on_square,
+    gen_rook_moves_on_square,
+    gen_knight_moves_on_square,
+    gen_bishop_moves_on_square,
+    gen_queen_moves_on_square,
+    gen_king_moves_on_square
+};
+
+/**
+ * @brief Works out which parts of the from square are needed to tell a move apart from the other legal moves.
+ *
+ * @param state The state the move is played from.
+ * @param move The move.
+ * @param[out] needs_file Set if the file of the from square must be written.
+ * @param[out] needs_rank Set if the rank of the from square must be written.
+ */
+static void get_disambiguation(const state_t *state, const move_t *move, bool *needs_file, bool *needs_rank) {
+    const uint64_t from_square = get_move_from_square(move);
+    const uint64_t to_square = get_move_to_square(move);
+    const piece_t piece = get_piece_on_square(state, from_square);
+    const int from_index = SQUARE_INDEX(from_square);
+
+    bool is_ambiguous = false, shares_file = false, shares_rank = false;
+
+    move_collection_t *collection = get_legal_moves_of_state(state);
+    move_t *other = pop_collection_head(collection);
+    while (other != NULL) {
+        const uint64_t other_from = get_move_from_square(other);
+
+        // Another piece of the same type which can reach the same square
+        if (get_move_to_square(other) == to_square && other_from != from_square
+            && get_piece_on_square(state, other_from) == piece) {
+            is_ambiguous = true;
+            if (FILE_OF(SQUARE_INDEX(other_from)) == FILE_OF(from_index)) shares_file = true;
+            if (RANK_OF(SQUARE_INDEX(other_from)) == RANK_OF(from_index)) shares_rank = true;
+        }
+
+        free_move(other);
+        other = pop_collection_head(collection);
+    }
+
+    free_move_collection(collection);
+
+    // The file is preferred, the rank is used when the file is shared, both when both are shared
+    *needs_file = is_ambiguous && (!shares_file || shares_rank);
+    *needs_rank = shares_file;
+}
+
+/**
+ * @brief Writes a move in standard algebraic notation without the check or mate suffix.
+ *
+ * @param state The state the move is played from.
+ * @param move The move to convert.
+ * @param buffer A buffer of at least SAN_STRING_LENGTH characters.
+ * @return The number of characters written.
+ */
+static int write_san_body(const state_t *state, const move_t *move, char *buffer) {
+    const flags_t *flags = get_move_flags(move);
+    if (flags->castle != NULL_CASTLE) {
+        const bool kingside = flags->castle == CASTLE_KINGSIDE_WHITE || flags->castle == CASTLE_KINGSIDE_BLACK;
+        strcpy(buffer, kingside ? "O-O" : "O-O-O");
+        return kingside ? 3 : 5;
+    }
+
+    const uint64_t from_square = get_move_from_square(move);
+    const uint64_t to_square = get_move_to_square(move);
+    const int from_index = SQUARE_INDEX(from_square);
+    const int to_index = SQUARE_INDEX(to_square);
+    const piece_t piece = get_piece_on_square(state, from_square);
+
+    const bool is_capture = get_piece_on_square(state, to_square) != NULL_PIECE
+                         || (piece == PIECE_PAWN && FILE_OF(from_index) != FILE_OF(to_index));
+
+    int length = 0;
+    if (piece == PIECE_PAWN) {
+        if (is_capture) buffer[length++] = 'a' + FILE_OF(from_index);
+    } else {
+        buffer[length++] = PIECE_LETTERS[piece];
+
+        bool needs_file, needs_rank;
+        get_disambiguation(state, move, &needs_file, &needs_rank);
+        if (needs_file) buffer[length++] = 'a' + FILE_OF(from_index);
+        if (needs_rank) buffer[length++] = '1' + RANK_OF(from_index);
+    }
+
+    if (is_capture) buffer[length++] = 'x';
+    buffer[length++] = 'a' + FILE_OF(to_index);
+    buffer[length++] = '1' + RANK_OF(to_index);
+
+    if (flags->promotion_piece != NULL_PIECE) {
+        buffer[length++] = '=';
+        buffer[length++] = PIECE_LETTERS[flags->promotion_piece];
+    }
+
+    buffer[length] = '\0';
+    return length;
+}
+
+void move_to_san(const state_t *state, const move_t *move, char *buffer) {
+    int length = write_san_body(state, move, buffer);
+
+    state_t *next_state = new_state();
+    copy_state(state, next_state);
+    play_move(next_state, move);
+
+    const color_t opponent = get_state_to_move_color(next_state);
+    if (is_checkmate(next_state, opponent)) buffer[length++] = '#';
+    else if (is_check(next_state, opponent)) buffer[length++] = '+';
+    buffer[length] = '\0';
+
+    free_state(next_state);
+}
+
+/**
+ * @brief Returns the length of a SAN move once suffixes are dropped.
+ *
+ * @param san The move.
+ * @return The number of characters up to the first suffix, separator or end of string.
+ */
+static size_t san_body_length(const char *san) {
+    size_t length = 0;
+    while (san[length] && strchr("+#!? \t\n\r;,", san[length]) == NULL) length++;
+    return length;
+}
+
+/**
+ * @brief The parts of a move in standard algebraic notation.
+ */
+typedef struct {
+    piece_t piece;
+    bool is_castle;
+    bool is_kingside;
+    int from_file;          // -1 when not given
+    int from_rank;          // -1 when not given
+    int to_index;
+    piece_t promotion;      // NULL_PIECE when not given
+} san_parts_t;
+
+/**
+ * @brief Splits a move in standard algebraic notation into its parts.
+ *
+ * @param san The move, suffixes are ignored.
+ * @param[out] parts Receives the parts.
+ * @return false if the notation is malformed.
+ */
+static bool parse_san(const char *san, san_parts_t *parts) {
+    const size_t length = san_body_length(san);
+    *parts = (san_parts_t){.piece = PIECE_PAWN, .from_file = -1, .from_rank = -1, .promotion = NULL_PIECE};
+
+    // Castling is sometimes written with zeros
+    if ((length == 3 || length == 5) && (san[0] == 'O' || san[0] == '0')) {
+        for (size_t i = 0; i < length; i++) {
+            if (san[i] != (i % 2 ? '-' : san[0])) return false;
+        }
+        parts->is_castle = true;
+        parts->is_kingside = length == 3;
+        return true;
+    }
+
+    size_t i = 0;
+    const char *letter = length ? strchr(PIECE_LETTERS + 1, san[0]) : NULL;
+    if (letter != NULL && san[0] != '\0') {
+        parts->piece = (piece_t)(letter - PIECE_LETTERS);
+        i++;
+    }
+
+    // Up to four coordinates: an optional file and rank of the from square, then the destination
+    char coordinates[4];
+    int coordinate_count = 0;
+
+    for (; i < length; i++) {
+        const char c = san[i];
+
+        if ((c >= 'a' && c <= 'h') || (c >= '1' && c <= '8')) {
+            if (coordinate_count == 4) return false;
+            coordinates[coordinate_count++] = c;
+        } else if (c == '=' || strchr("RNBQ", c) != NULL) {
+            // A promotion, with or without the equal sign, ends the move
+            const char symbol = (char)(c == '=' && i + 1 < length ? san[++i] : c);
+            const char *promotion = strchr(PIECE_LETTERS + 1, symbol >= 'a' ? symbol - 'a' + 'A' : symbol);
+            if (promotion == NULL || *promotion == 'K' || symbol == '\0' || parts->piece != PIECE_PAWN) return false;
+
+            parts->promotion = (piece_t)(promotion - PIECE_LETTERS);
+            if (i + 1 != length) return false;
+        } else if (c != 'x' && c != ':' && c != '-') {
+            return false;
+        }
+    }
+
+    if (coordinate_count < 2) return false;
+
+    const char to_file = coordinates[coordinate_count - 2], to_rank = coordinates[coordinate_count - 1];
+    if (to_file < 'a' || to_file > 'h' || to_rank < '1' || to_rank > '8') return false;
+    parts->to_index = (to_rank - '1') * 8 + (to_file - 'a');
+
+    for (int c = 0; c < coordinate_count - 2; c++) {
+        if (coordinates[c] >= 'a' && coordinates[c] <= 'h' && parts->from_file < 0 && parts->from_rank < 0) parts->from_file = coordinates[c] - 'a';
+        else if (coordinates[c] >= '1' && coordinates[c] <= '8' && parts->from_rank < 0) parts->from_rank = coordinates[c] - '1';
+        else return false;
+    }
+
+    // A pawn move without a from file is a push, captures name the file they come from
+    if (parts->piece == PIECE_PAWN && parts->from_file < 0) parts->from_file = to_file - 'a';
+
+    return true;
+}
+
+/**
+ * @brief Returns the squares of a file or a rank, every square when the index is -1.
+ */
+static uint64_t get_line_mask(int index, bool is_file) {
+    if (index < 0) return ~0ULL;
+    return is_file ? 0x0101010101010101ULL << index : 0xFFULL << (8 * index);
+}
+
+move_t *find_arena_san_move(const state_t *state, const char *san, arena_t *arena) {
+    san_parts_t parts;
+    if (!parse_san(san, &parts)) return NULL;
+
+    const color_t color = get_state_to_move_color(state);
+    const piece_t piece = parts.is_castle ? PIECE_KING : parts.piece;
+    const castle_t castle = !parts.is_castle ? NULL_CASTLE
+        : (parts.is_kingside ? CASTLE_KINGSIDE_WHITE : CASTLE_QUEENSIDE_WHITE) + (color == BLACK ? CASTLE_KINGSIDE_BLACK : 0);
+    const uint64_t to_square = 1ULL << parts.to_index;
+
+    uint64_t candidates = get_state_peice_bitboard(state, piece, color)
+                        & get_line_mask(parts.from_file, true) & get_line_mask(parts.from_rank, false);
+
+    move_t *found = NULL;
+    state_t *next_state = new_arena_state(arena);
+
+    for (; candidates; candidates &= candidates - 1) {
+        move_collection_t *collection = new_arena_move_collection(arena);
+        SQUARE_MOVE_GENERATORS[piece](state, collection, candidates & -candidates);
+
+        move_t *move;
+        while ((move = pop_collection_head(collection)) != NULL) {
+            const flags_t *flags = get_move_flags(move);
+            if (flags->castle != castle) continue;
+            if (castle == NULL_CASTLE && (get_move_to_square(move) != to_square || flags->promotion_piece != parts.promotion)) continue;
+
+            copy_state(state, next_state);
+            play_move(next_state, move);
+            if (is_check(next_state, color)) continue;
+
+            // Two legal moves fit the notation, it does not name a move
+            if (found != NULL) return NULL;
+            found = move;
+        }
+    }
+
+    return found;
+}
+
+uint16_t san_to_move_key(const state_t *state, const char *san) {
+    arena_t *arena = new_arena(SAN_ARENA_BLOCK_SIZE);
+    const move_t *move = find_arena_san_move(state, san, arena);
+    const uint16_t key = move != NULL ? get_move_key(move) : NULL_MOVE_KEY;
+
+    free_arena(arena);
+    return key;
+}
@@ -0,0 +1,74 @@
+/**
+ * @file SanNotation.h
+ * @brief This file contains the declarations of the functions used to read and write moves in standard algebraic notation.
+ * 
+ * @details Standard algebraic notation (SAN) is the notation used by humans, PGN files and the "bm"/"am"
+ * operations of EPD files, e.g. "Nf3", "exd5", "O-O", "e8=Q+". Unlike long algebraic notation it depends on
+ * the position, so every function takes the state the move is played from.
+ * 
+ * @version 1.0.0
+ * @author Martin Newbound
+ * @date 2024
+ * 
+ * @note License:
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef SAN_NOTATION_H
+#define SAN_NOTATION_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "../State/GameState.h"
+#include "Move.h"
+
+// Length of the buffer needed to hold a move in standard algebraic notation (e.g. "Qa1xb2+", "exd8=Q#")
+#define SAN_STRING_LENGTH 10
+
+/**
+ * Writes a legal move in standard algebraic notation, including the check or mate suffix.
+ * 
+ * @param state The state the move is played from.
+ * @param move The move to convert.
+ * @param buffer A buffer of at least SAN_STRING_LENGTH characters.
+ */
+void move_to_san(const state_t *state, const move_t *move, char *buffer);
+
+/**
+ * Finds the legal move written in standard algebraic notation.
+ * 
+ * Check, mate and annotation suffixes ("+", "#", "!", "?") are ignored, as is a "0-0" spelling of castling.
+ * See find_arena_san_move for the notations accepted.
+ * 
+ * @param state The state the move is played from.
+ * @param san The move to find, trailing characters after the move are ignored.
+ * @return The key of the move, or NULL_MOVE_KEY if no legal move matches.
+ */
+uint16_t san_to_move_key(const state_t *state, const char *san);
+
+/**
+ * Finds the legal move written in standard algebraic notation, without allocating outside an arena.
+ * 
+ * The notation is parsed into a piece, a destination, an optional part of the from square and a promotion, and
+ * only the moves of the pieces it can designate are generated and checked, which makes this the decoder for bulk
+ * imports. A from square given when it is not needed ("Ngf3") and a missing or extra capture mark are accepted;
+ * a notation which matches several legal moves is not.
+ * 
+ * @param state The state the move is played from.
+ * @param san The move to find, trailing characters after the move are ignored.
+ * @param arena The arena the move and the work states are allocated from.
+ * @return The move, allocated from the arena, or NULL if no single legal move matches.
+ */
+move_t *find_arena_san_move(const state_t *state, const char *san, arena_t *arena);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SAN_NOTATION_H
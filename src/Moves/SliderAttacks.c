@@ -0,0 +1,195 @@
+/* iMate -- Copyright (C) 2024 Martin Newbound */
+
+#include "SliderAttacks.h"
+#include "../Utils/BitOperations.h"
+#include <string.h>
+
+#define FILE_OF(INDEX) ((INDEX) % 8)
+#define RANK_OF(INDEX) ((INDEX) / 8)
+
+#define RANK_1_MASK 0x00000000000000FFULL
+#define RANK_8_MASK 0xFF00000000000000ULL
+#define FILE_A_MASK 0x0101010101010101ULL
+#define FILE_H_MASK 0x8080808080808080ULL
+
+// Sizes of the tables: the sum over the squares of 2 to the number of bits of the mask
+#define ROOK_ATTACK_TABLE_SIZE 102400
+#define BISHOP_ATTACK_TABLE_SIZE 5248
+
+// Most bits in a mask (a rook in a corner)
+#define MAX_MASK_BITS 12
+
+// The rays from a square, the four of the rook first
+typedef enum {
+    RAY_NORTH,
+    RAY_SOUTH,
+    RAY_EAST,
+    RAY_WEST,
+    RAY_NORTH_EAST,
+    RAY_SOUTH_WEST,
+    RAY_NORTH_WEST,
+    RAY_SOUTH_EAST
+} ray_t;
+
+// Seeds of the magic search per rank of the square, picked so the search ends after few candidates
+static const uint64_t MAGIC_SEEDS[8] = {728, 10316, 55013, 32803, 12281, 15100, 16645, 255};
+
+// File and rank steps of each ray (indexed by ray_t)
+static const int RAY_STEPS[8][2] = {{0, 1}, {0, -1}, {1, 0}, {-1, 0}, {1, 1}, {-1, -1}, {-1, 1}, {1, -1}};
+
+slider_table_t ROOK_TABLES[64];
+slider_table_t BISHOP_TABLES[64];
+bool SLIDER_TABLES_USE_PEXT;
+
+static uint64_t rook_attacks[ROOK_ATTACK_TABLE_SIZE];
+static uint64_t bishop_attacks[BISHOP_ATTACK_TABLE_SIZE];
+
+/**
+ * @brief Walks a ray up to and including the first occupied square.
+ *
+ * @param square The index of the square the ray starts from.
+ * @param occupancy The pieces on the board.
+ * @param ray The ray.
+ * @return The squares of the ray walked.
+ */
+static uint64_t walk_ray(int square, uint64_t occupancy, ray_t ray) {
+    uint64_t squares = 0;
+    int file = FILE_OF(square) + RAY_STEPS[ray][0];
+    int rank = RANK_OF(square) + RAY_STEPS[ray][1];
+
+    for (; file >= 0 && file < 8 && rank >= 0 && rank < 8; file += RAY_STEPS[ray][0], rank += RAY_STEPS[ray][1]) {
+        const uint64_t target = 1ULL << (rank * 8 + file);
+        squares |= target;
+        if (occupancy & target) break;
+    }
+
+    return squares;
+}
+
+/**
+ * @brief Walks the four rays of a slider.
+ *
+ * @param square The index of the slider's square.
+ * @param occupancy The pieces on the board.
+ * @param first_ray The first of the slider's rays (RAY_NORTH for rooks, RAY_NORTH_EAST for bishops).
+ * @return The squares attacked.
+ */
+static uint64_t walk_rays(int square, uint64_t occupancy, ray_t first_ray) {
+    uint64_t attacks = 0;
+    for (ray_t ray = first_ray; ray < first_ray + 4; ray++) attacks |= walk_ray(square, occupancy, ray);
+    return attacks;
+}
+
+/**
+ * @brief Gathers the bits of a value under a mask into the low bits, as PEXT does.
+ */
+static uint64_t extract_bits(uint64_t value, uint64_t mask) {
+    uint64_t result = 0;
+    for (uint64_t bit = 1; mask != 0; bit <<= 1, mask &= mask - 1) {
+        if (value & mask & -mask) result |= bit;
+    }
+    return result;
+}
+
+/**
+ * @brief Generates the next number of a xorshift64* sequence.
+ */
+static uint64_t next_random(uint64_t *seed) {
+    *seed ^= *seed >> 12;
+    *seed ^= *seed << 25;
+    *seed ^= *seed >> 27;
+    return *seed * 0x2545F4914F6CDD1DULL;
+}
+
+/**
+ * @brief Builds the tables of a slider for every square.
+ *
+ * @param tables The tables of the slider, indexed by square.
+ * @param attacks The storage shared by the tables.
+ * @param first_ray The first of the slider's four rays.
+ * @param use_pext Whether the tables are indexed with PEXT rather than magic numbers.
+ */
+static void init_slider_tables(slider_table_t tables[64], uint64_t *attacks, ray_t first_ray, bool use_pext) {
+    uint64_t occupancies[1 << MAX_MASK_BITS];
+    uint64_t references[1 << MAX_MASK_BITS];
+    int epochs[1 << MAX_MASK_BITS];
+    int epoch = 0;
+
+    memset(epochs, 0, sizeof(epochs));
+
+    for (int square = 0; square < 64; square++) {
+        slider_table_t *table = &tables[square];
+
+        // Pieces on the edges never block a ray, except on the slider's own rank or file
+        const uint64_t edges = ((RANK_1_MASK | RANK_8_MASK) & ~(RANK_1_MASK << (8 * RANK_OF(square))))
+                             | ((FILE_A_MASK | FILE_H_MASK) & ~(FILE_A_MASK << FILE_OF(square)));
+        table->mask = walk_rays(square, 0, first_ray) & ~edges;
+        table->shift = 64 - (unsigned int)popcount(table->mask);
+        table->attacks = square == 0 ? attacks : tables[square - 1].attacks + (1ULL << (64 - tables[square - 1].shift));
+        table->magic = 0;
+
+        // Enumerate every subset of the mask (carry rippler)
+        int size = 0;
+        uint64_t subset = 0;
+        do {
+            occupancies[size] = subset;
+            references[size] = walk_rays(square, subset, first_ray);
+            size++;
+            subset = (subset - table->mask) & table->mask;
+        } while (subset);
+
+        uint64_t *entries = (uint64_t *)table->attacks;
+        if (use_pext) {
+            for (int i = 0; i < size; i++) entries[extract_bits(occupancies[i], table->mask)] = references[i];
+            continue;
+        }
+
+        // Try sparse random numbers until one maps every subset to an entry holding its attacks
+        uint64_t seed = MAGIC_SEEDS[RANK_OF(square)];
+        for (int i = 0; i < size;) {
+            do {
+                table->magic = next_random(&seed) & next_random(&seed) & next_random(&seed);
+            } while (popcount((table->magic * table->mask) >> 56) < 6);
+
+            epoch++;
+            for (i = 0; i < size; i++) {
+                const uint64_t index = ((occupancies[i] & table->mask) * table->magic) >> table->shift;
+
+                if (epochs[index] < epoch) {
+                    epochs[index] = epoch;
+                    entries[index] = references[i];
+                } else if (entries[index] != references[i]) {
+                    break;
+                }
+            }
+        }
+    }
+}
+
+bool set_slider_lookup(slider_lookup_t lookup) {
+    detect_cpu_features();
+
+    bool use_pext = lookup == SLIDER_LOOKUP_PEXT || (lookup == SLIDER_LOOKUP_AUTO && CPU_FEATURES.has_fast_pext);
+#if !(defined(__GNUC__) && defined(__x86_64__))
+    if (lookup == SLIDER_LOOKUP_PEXT) return false;
+    use_pext = false;
+#endif
+    if (use_pext && !CPU_FEATURES.has_bmi2) return false;
+
+    init_slider_tables(ROOK_TABLES, rook_attacks, RAY_NORTH, use_pext);
+    init_slider_tables(BISHOP_TABLES, bishop_attacks, RAY_NORTH_EAST, use_pext);
+    SLIDER_TABLES_USE_PEXT = use_pext;
+    return true;
+}
+
+void init_slider_attacks(void) {
+    static bool is_initialized = false;
+    if (is_initialized) return;
+
+    set_slider_lookup(SLIDER_LOOKUP_AUTO);
+    is_initialized = true;
+}
+
+const char *get_slider_lookup_name(void) {
+    return SLIDER_TABLES_USE_PEXT ? "pext" : "magic";
+}
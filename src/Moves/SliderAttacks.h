@@ -0,0 +1,139 @@
+/* iMate -- Copyright (C) 2024 Martin Newbound */
+
+/**
+ * @file SliderAttacks.h
+ * @brief This file contains the attack lookups of the sliding pieces (rooks, bishops and queens).
+ *
+ * @details The squares a slider attacks depend only on its square and on the pieces standing on its rays before
+ * the edge of the board (its mask). For every square all the arrangements of those pieces are enumerated once
+ * and their attacks stored in a table, so a lookup is an index computation and a load. The index of an
+ * arrangement is computed one of two ways, picked once when the tables are built:
+ *
+ * - PEXT: the BMI2 instruction gathers the occupancy bits under the mask into a dense index. Used on processors
+ *   with a fast PEXT.
+ * - Magic: the masked occupancy is multiplied by a magic number found at startup, and the top bits of the
+ *   product give the index. Used everywhere else.
+ *
+ * The tables have the same size either way, and the lookups branch on the method, a branch always predicted.
+ *
+ * @version 1.0.0
+ * @author Martin Newbound
+ * @date 2024
+ *
+ * @note License:
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef SLIDER_ATTACKS_H
+#define SLIDER_ATTACKS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef enum {
+    SLIDER_LOOKUP_AUTO,     // PEXT if the processor has a fast one, magic multiplication otherwise
+    SLIDER_LOOKUP_PEXT,
+    SLIDER_LOOKUP_MAGIC
+} slider_lookup_t;
+
+/**
+ * @brief The lookup of one square: the attacks of every arrangement of the pieces under the mask.
+ */
+typedef struct {
+    uint64_t mask;
+    uint64_t magic;
+    const uint64_t *attacks;
+    unsigned int shift;
+} slider_table_t;
+
+extern slider_table_t ROOK_TABLES[64];
+extern slider_table_t BISHOP_TABLES[64];
+
+// Whether the tables are indexed with PEXT
+extern bool SLIDER_TABLES_USE_PEXT;
+
+/**
+ * Builds the lookup tables for the processor running the engine. Calling it again has no effect.
+ */
+void init_slider_attacks(void);
+
+/**
+ * Rebuilds the lookup tables with a given method.
+ *
+ * @param lookup The method.
+ * @return false if the method is PEXT and the processor lacks BMI2, in which case the tables are unchanged.
+ *
+ * @warning The tables must not be in use, no search may be running.
+ */
+bool set_slider_lookup(slider_lookup_t lookup);
+
+/**
+ * Returns the name of the method the tables are indexed with.
+ *
+ * @return "pext" or "magic".
+ */
+const char *get_slider_lookup_name(void);
+
+/**
+ * Looks up the attacks of a slider.
+ *
+ * @param table The table of the slider's square.
+ * @param occupancy The pieces on the board.
+ * @return The squares attacked, own pieces included.
+ */
+static inline uint64_t get_slider_attacks(const slider_table_t *table, uint64_t occupancy) {
+#if defined(__GNUC__) && defined(__x86_64__)
+    if (SLIDER_TABLES_USE_PEXT) {
+        uint64_t index;
+        __asm__("pextq %2, %1, %0" : "=r"(index) : "r"(occupancy), "r"(table->mask));
+        return table->attacks[index];
+    }
+#endif
+    return table->attacks[((occupancy & table->mask) * table->magic) >> table->shift];
+}
+
+/**
+ * Looks up the squares a rook attacks.
+ *
+ * @param square The index of the rook's square.
+ * @param occupancy The pieces on the board.
+ * @return The squares attacked, own pieces included.
+ */
+static inline uint64_t get_rook_attacks(int square, uint64_t occupancy) {
+    return get_slider_attacks(&ROOK_TABLES[square], occupancy);
+}
+
+/**
+ * Looks up the squares a bishop attacks.
+ *
+ * @param square The index of the bishop's square.
+ * @param occupancy The pieces on the board.
+ * @return The squares attacked, own pieces included.
+ */
+static inline uint64_t get_bishop_attacks(int square, uint64_t occupancy) {
+    return get_slider_attacks(&BISHOP_TABLES[square], occupancy);
+}
+
+/**
+ * Looks up the squares a queen attacks.
+ *
+ * @param square The index of the queen's square.
+ * @param occupancy The pieces on the board.
+ * @return The squares attacked, own pieces included.
+ */
+static inline uint64_t get_queen_attacks(int square, uint64_t occupancy) {
+    return get_rook_attacks(square, occupancy) | get_bishop_attacks(square, occupancy);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SLIDER_ATTACKS_H
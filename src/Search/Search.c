@@ -1,87 +1,906 @@
-/* iMate -- Copyright (C) 2024 Martin Newbound */                                                    
+/* iMate -- Copyright (C) 2024 Martin Newbound */
 
 #include "Search.h"
 #include "../Moves/Move.h"
 #include "../Moves/MoveCollection.h"
 #include "../Moves/MoveGeneration.h"
+#include "../Moves/AttackInfo.h"
 #include "../State/GameState.h"
 #include "../Evaluation/Evaluation.h"
+#include "../Utils/Clock.h"
+#include "SearchStats.h"
+#include "SearchTrace.h"
+#include "../Utils/Profiler.h"
+#include "../Utils/Arena.h"
+#include "../Utils/BitOperations.h"
 
 #include <limits.h>
 #include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+
+#define MAX_MOVES 256
+
+// Size of the blocks of the search arena, enough for the moves and states of every node of a line
+#define SEARCH_ARENA_BLOCK_SIZE (256 * 1024)
+
+// How often (in nodes) the search polls the clock and the node limit
+#define CHECK_INTERVAL 2048
+
+// Minimum time between two periodic "info" lines, in milliseconds
+#define INFO_INTERVAL_MS 1000
+
+// Time kept in reserve for communication delays, in milliseconds
+#define MOVE_OVERHEAD_MS 30
+
+// Moves to plan for when the GUI does not send "movestogo"
+#define DEFAULT_MOVES_TO_GO 30
+
+// Move ordering scores
+#define TT_MOVE_SCORE       2000000
+#define CAPTURE_SCORE       1000000
+#define FIRST_KILLER_SCORE   900000
+#define SECOND_KILLER_SCORE  800000
+#define HISTORY_LIMIT        700000
+
+// Value of each piece type (indexed by piece_t) used to order captures
+static const int ORDERING_PIECE_VALUES[6] = {100, 500, 320, 330, 900, 20000};
+
+/**
+ * @brief A search parameter which can be set by name, and its range.
+ */
+typedef struct {
+    const char *name;
+    size_t offset;      // in search_params_t
+    int min;
+    int max;
+} search_param_info_t;
+
+static const search_param_info_t SEARCH_PARAMS[] = {
+    {"CheckExtension",       offsetof(search_params_t, check_extension),               0, 2},
+    {"NullMoveMinDepth",     offsetof(search_params_t, null_move_min_depth),           1, MAX_PLY},
+    {"NullMoveReduction",    offsetof(search_params_t, null_move_reduction),           0, 8},
+    {"NullMoveDepthDivisor", offsetof(search_params_t, null_move_depth_divisor),       1, MAX_PLY},
+    {"LmrMinDepth",          offsetof(search_params_t, lmr_min_depth),                 1, MAX_PLY},
+    {"LmrMinMoves",          offsetof(search_params_t, lmr_min_moves),                 1, MAX_MOVES},
+    {"LmrLateMoves",         offsetof(search_params_t, lmr_late_moves),                1, MAX_MOVES},
+    {"MobilityWeight",       offsetof(search_params_t, evaluation.mobility_weight),    0, 400},
+    {"KingDangerWeight",     offsetof(search_params_t, evaluation.king_danger_weight), 0, 400}
+};
+
+#define SEARCH_PARAM_COUNT (sizeof(SEARCH_PARAMS) / sizeof(SEARCH_PARAMS[0]))
+
+struct search {
+    transposition_table_t *table;
+    arena_t *arena;     // moves, move lists and states of the nodes on the current line
+    atomic_bool stop;
+    bool aborted;
+
+    search_limits_t limits;
+    search_params_t params;
+    int64_t start_time;
+    int64_t soft_time_limit;
+    int64_t hard_time_limit;
+    int64_t last_info_time;
+    bool report_info;
+
+    uint64_t nodes;
+    int seldepth;
+    int completed_depth;
+
+    uint16_t killer_moves[MAX_PLY][2];
+    int history[2][64][64];
+
+    uint16_t pv[MAX_PLY][MAX_PLY];
+    int pv_length[MAX_PLY];
+
+    // Attack maps of the node at each ply, computed when the node first needs them (see get_attack_info)
+    attack_info_t attack_info[MAX_PLY];
+
+    // Keys of the game positions before the root followed by the positions of the current line, indexed by
+    // root_index + ply. game_keys holds the game as given by set_search_game_history, root position included.
+    uint64_t keys[FIFTY_MOVE_RULE_PLIES + MAX_PLY];
+    uint64_t game_keys[FIFTY_MOVE_RULE_PLIES + 1];
+    int game_key_count;
+    int root_index;
+
+#ifdef SEARCH_STATS
+    search_stats_t stats;
+#endif
+
+#ifdef SEARCH_TRACE
+    trace_ring_t *trace;
+#endif
+};
+
+typedef struct {
+    move_t *move;
+    int score;
+    bool is_capture;
+} scored_move_t;
+
+
+/*
++=============================================================================+
+|             Search Context                                                  |
++=============================================================================+
+*/
+
+void init_search_limits(search_limits_t *limits) {
+    memset(limits, 0, sizeof(search_limits_t));
+}
+
+void init_search_params(search_params_t *params) {
+    params->check_extension = 1;
+    params->null_move_min_depth = 3;
+    params->null_move_reduction = 2;
+    params->null_move_depth_divisor = 6;
+    params->lmr_min_depth = 3;
+    params->lmr_min_moves = 3;
+    params->lmr_late_moves = 6;
+    params->evaluation = DEFAULT_EVALUATION_PARAMS;
+}
+
+bool set_search_param(search_params_t *params, const char *name, int value) {
+    for (size_t i = 0; i < SEARCH_PARAM_COUNT; i++) {
+        const search_param_info_t *info = &SEARCH_PARAMS[i];
+        if (strcmp(info->name, name) != 0) continue;
+        if (value < info->min || value > info->max) return false;
+
+        *(int *)((char *)params + info->offset) = value;
+        return true;
+    }
+
+    return false;
+}
+
+void print_search_params(void) {
+    search_params_t params;
+    init_search_params(&params);
+
+    for (size_t i = 0; i < SEARCH_PARAM_COUNT; i++) {
+        const search_param_info_t *info = &SEARCH_PARAMS[i];
+        printf("  %-22s default %3d  min %3d  max %3d\n", info->name, *(const int *)((const char *)&params + info->offset),
+               info->min, info->max);
+    }
+}
+
+search_t *new_search(transposition_table_t *table) {
+    search_t *search = calloc(1, sizeof(search_t));
+    search->table = table;
+    search->arena = new_arena(SEARCH_ARENA_BLOCK_SIZE);
+    init_search_params(&search->params);
+    atomic_init(&search->stop, false);
+#ifdef SEARCH_TRACE
+    search->trace = new_trace_ring();
+#endif
+    return search;
+}
+
+void free_search(search_t *search) {
+#ifdef SEARCH_TRACE
+    free_trace_ring(search->trace);
+#endif
+    free_arena(search->arena);
+    free(search);
+}
+
+void set_search_game_history(search_t *search, const uint64_t *keys, int key_count) {
+    const int kept = key_count < FIFTY_MOVE_RULE_PLIES + 1 ? key_count : FIFTY_MOVE_RULE_PLIES + 1;
+    memcpy(search->game_keys, keys + key_count - kept, sizeof(uint64_t) * (size_t)kept);
+    search->game_key_count = kept;
+}
+
+void set_search_params(search_t *search, const search_params_t *params) {
+    search->params = *params;
+}
+
+void set_search_reporting(search_t *search, bool report_info) {
+    search->report_info = report_info;
+}
+
+void clear_search_heuristics(search_t *search) {
+    memset(search->killer_moves, 0, sizeof(search->killer_moves));
+    memset(search->history, 0, sizeof(search->history));
+}
+
+void stop_search(search_t *search) {
+    atomic_store(&search->stop, true);
+}
+
+bool is_search_stopped(const search_t *search) {
+    return atomic_load_explicit(&((search_t *)search)->stop, memory_order_relaxed);
+}
+
+void reset_search_stop(search_t *search) {
+    atomic_store(&search->stop, false);
+}
+
+/**
+ * @brief Places the game positions before the root at the start of the key stack.
+ *
+ * The game history is only used when it ends with the root position, otherwise the root has no history.
+ *
+ * @param search The search context.
+ * @param root The root position.
+ */
+static void load_key_history(search_t *search, const state_t *root) {
+    const uint64_t root_key = get_state_hash_key(root);
+    const bool has_history = search->game_key_count > 0 && search->game_keys[search->game_key_count - 1] == root_key;
+
+    search->root_index = has_history ? search->game_key_count - 1 : 0;
+    memcpy(search->keys, search->game_keys, sizeof(uint64_t) * (size_t)search->root_index);
+    search->keys[search->root_index] = root_key;
+}
+
+/**
+ * @brief Records the position of a node and checks whether it is drawn by repetition or by the fifty move rule.
+ *
+ * Only positions since the last irreversible move can be equal, and only those with the same side to move,
+ * so at most half_move_count / 2 keys are compared. A position repeated once inside the searched line is
+ * scored as a draw, as the side which could deviate would already have done so; a position of the game before
+ * the root must have occurred twice before.
+ *
+ * @param search The search context.
+ * @param state The state of the node.
+ * @param ply The distance from the root, at least 1.
+ * @return true if the position is a draw.
+ */
+static bool is_draw(search_t *search, const state_t *state, int ply) {
+    const int index = search->root_index + ply;
+    const uint64_t key = get_state_hash_key(state);
+    search->keys[index] = key;
+
+    const int half_moves = get_state_half_move_count(state);
+    if (half_moves >= FIFTY_MOVE_RULE_PLIES) return true;
+
+    const int oldest = half_moves < index ? index - half_moves : 0;
+    int repetitions = 0;
+
+    for (int i = index - 4; i >= oldest; i -= 2) {
+        if (search->keys[i] != key) continue;
+        if (i >= search->root_index || ++repetitions == 2) return true;
+    }
+
+    return false;
+}
+
+/**
+ * @brief Checks whether the search must unwind, either because a limit was hit or a stop was requested.
+ *
+ * The first iteration is never aborted so a best move is always available.
+ *
+ * @param search The search context.
+ * @return true if the search must return immediately.
+ */
+static bool should_abort(search_t *search) {
+    return search->completed_depth >= 1 && (search->aborted || is_search_stopped(search));
+}
+
+
+/*
++=============================================================================+
+|             Reporting                                                       |
++=============================================================================+
+*/
+
+/**
+ * @brief Prints a score in UCI format, either in centipawns or as a mate distance in moves.
+ *
+ * @param score The score to print.
+ */
+static void print_score(int score) {
+    if (IS_MATE_SCORE(score)) printf("score mate %d", MATE_IN_MOVES(score));
+    else printf("score cp %d", score);
+}
+
+/**
+ * @brief Prints the UCI "info" line for a completed iteration.
+ *
+ * @param search The search context.
+ * @param depth The depth of the completed iteration.
+ * @param score The score of the iteration.
+ */
+static void report_iteration(search_t *search, int depth, int score) {
+    int64_t elapsed = get_time_ms() - search->start_time;
+    uint64_t nps = elapsed > 0 ? search->nodes * 1000 / elapsed : search->nodes * 1000;
+
+    printf("info depth %d seldepth %d ", depth, search->seldepth);
+    print_score(score);
+    printf(" nodes %llu nps %llu hashfull %d time %lld pv",
+        (unsigned long long)search->nodes, (unsigned long long)nps,
+        transposition_table_hashfull(search->table), (long long)elapsed);
+
+    char move_string[MOVE_STRING_LENGTH];
+    for (int i = 0; i < search->pv_length[0]; i++) {
+        move_key_to_string(search->pv[0][i], move_string);
+        printf(" %s", move_string);
+    }
+
+    printf("\n");
+    fflush(stdout);
+    search->last_info_time = get_time_ms();
+}
+
+/**
+ * @brief Prints a periodic progress line, at most once every INFO_INTERVAL_MS.
+ *
+ * @param search The search context.
+ * @param now The current time in milliseconds.
+ */
+static void report_progress(search_t *search, int64_t now) {
+    if (now - search->last_info_time < INFO_INTERVAL_MS) return;
+
+    int64_t elapsed = now - search->start_time;
+    uint64_t nps = elapsed > 0 ? search->nodes * 1000 / elapsed : 0;
+
+    printf("info depth %d seldepth %d nodes %llu nps %llu hashfull %d time %lld\n",
+        search->completed_depth + 1, search->seldepth, (unsigned long long)search->nodes,
+        (unsigned long long)nps, transposition_table_hashfull(search->table), (long long)elapsed);
+    fflush(stdout);
+
+    search->last_info_time = now;
+}
+
+
+/*
++=============================================================================+
+|             Time Management                                                 |
++=============================================================================+
+*/
+
+/**
+ * @brief Derives the soft and hard time limits of a search from its limits.
+ *
+ * The soft limit is checked between iterations (a new iteration is not started once it is exceeded),
+ * the hard limit is checked while searching and aborts the current iteration.
+ *
+ * @param search The search context.
+ * @param color The color of the player to move.
+ */
+static void allocate_time(search_t *search, color_t color) {
+    const search_limits_t *limits = &search->limits;
+    search->soft_time_limit = 0;
+    search->hard_time_limit = 0;
+
+    if (limits->infinite) return;
+
+    if (limits->move_time > 0) {
+        int64_t budget = limits->move_time - MOVE_OVERHEAD_MS;
+        search->soft_time_limit = search->hard_time_limit = budget > 1 ? budget : 1;
+        return;
+    }
+
+    if (limits->time[color] <= 0) return;
+
+    int64_t remaining = limits->time[color] - MOVE_OVERHEAD_MS;
+    if (remaining < 1) remaining = 1;
+
+    int moves_to_go = limits->moves_to_go > 0 ? limits->moves_to_go : DEFAULT_MOVES_TO_GO;
+    int64_t allocation = remaining / moves_to_go + limits->increment[color] * 3 / 4;
+
+    int64_t hard_limit = allocation * 3;
+    if (hard_limit > remaining / 2 && moves_to_go > 1) hard_limit = remaining / 2;
+    if (hard_limit > remaining) hard_limit = remaining;
+
+    search->soft_time_limit = allocation / 2 > 1 ? allocation / 2 : 1;
+    search->hard_time_limit = hard_limit > 1 ? hard_limit : 1;
+}
+
+/**
+ * @brief Polls the clock and node limit, stopping the search when a limit is exceeded.
+ *
+ * The first iteration is always completed so a best move is available.
+ *
+ * @param search The search context.
+ */
+static void check_limits(search_t *search) {
+    int64_t now = get_time_ms();
+    if (search->report_info) report_progress(search, now);
+
+    if (search->completed_depth < 1) return;
+
+    if (search->hard_time_limit && now - search->start_time >= search->hard_time_limit) search->aborted = true;
+    if (search->limits.nodes && search->nodes >= search->limits.nodes) search->aborted = true;
+}
+
+/**
+ * @brief Visits a node, polling the limits every CHECK_INTERVAL nodes.
+ *
+ * @param search The search context.
+ * @param ply The distance from the root.
+ * @return true if the search must stop.
+ */
+static bool visit_node(search_t *search, int ply) {
+    search->nodes++;
+    search->pv_length[ply] = ply;
+    if (ply > search->seldepth) search->seldepth = ply;
+
+    if ((search->nodes % CHECK_INTERVAL) == 0) check_limits(search);
+    return should_abort(search);
+}
+
+
+/*
++=============================================================================+
+|             Move Ordering                                                   |
++=============================================================================+
+*/
+
+/**
+ * @brief Moves the moves of an arena collection into an array.
+ *
+ * @param collection The collection to drain.
+ * @param moves The array to fill.
+ * @return The number of moves.
+ */
+static int drain_collection(move_collection_t *collection, scored_move_t *moves) {
+    int count = 0;
+    move_t *move = pop_collection_head(collection);
+
+    while (move != NULL && count < MAX_MOVES) {
+        moves[count++].move = move;
+        move = pop_collection_head(collection);
+    }
+
+    return count;
+}
+
+/**
+ * @brief Assigns an ordering score to every move.
+ *
+ * The transposition table move comes first, followed by captures in most valuable victim / least
+ * valuable attacker order, promotions, the killer moves of the ply and finally quiet moves ordered by history.
+ *
+ * @param search The search context.
+ * @param state The state the moves were generated for.
+ * @param moves The moves to score.
+ * @param count The number of moves.
+ * @param tt_move The key of the transposition table move.
+ * @param ply The distance from the root.
+ */
+static void score_moves(const search_t *search, const state_t *state, scored_move_t *moves, int count, uint16_t tt_move, int ply) {
+    PROFILE_SCOPE(PROFILE_MOVE_ORDERING);
+    const color_t color = get_state_to_move_color(state);
+
+    for (int i = 0; i < count; i++) {
+        const move_t *move = moves[i].move;
+        const uint16_t key = get_move_key(move);
+        const uint64_t from_square = get_move_from_square(move);
+        const uint64_t to_square = get_move_to_square(move);
+        const piece_t promotion_piece = get_move_flags(move)->promotion_piece;
+
+        piece_t victim = get_piece_on_square(state, to_square);
+        piece_t attacker = get_piece_on_square(state, from_square);
+        if (attacker == PIECE_PAWN && to_square == get_en_passant_target(state)) victim = PIECE_PAWN;
+
+        moves[i].is_capture = victim != NULL_PIECE;
+
+        if (key == tt_move) moves[i].score = TT_MOVE_SCORE;
+        // The attacker term is counted down from the king so that every capture stays above CAPTURE_SCORE
+        else if (victim != NULL_PIECE) moves[i].score = CAPTURE_SCORE + ORDERING_PIECE_VALUES[victim] * 10 + (ORDERING_PIECE_VALUES[PIECE_KING] - ORDERING_PIECE_VALUES[attacker]) / 10;
+        else if (promotion_piece != NULL_PIECE) moves[i].score = CAPTURE_SCORE + ORDERING_PIECE_VALUES[promotion_piece];
+        else if (key == search->killer_moves[ply][0]) moves[i].score = FIRST_KILLER_SCORE;
+        else if (key == search->killer_moves[ply][1]) moves[i].score = SECOND_KILLER_SCORE;
+        else moves[i].score = search->history[color][lsb_index(from_square)][lsb_index(to_square)];
+    }
+}
+
+/**
+ * @brief Swaps the best scored remaining move into position `index` (selection sort step).
+ *
+ * @param moves The scored moves.
+ * @param index The position to fill.
+ * @param count The number of moves.
+ */
+static void pick_next_move(scored_move_t *moves, int index, int count) {
+    PROFILE_SCOPE(PROFILE_MOVE_ORDERING);
+    int best = index;
+    for (int i = index + 1; i < count; i++) {
+        if (moves[i].score > moves[best].score) best = i;
+    }
+
+    scored_move_t tmp = moves[index];
+    moves[index] = moves[best];
+    moves[best] = tmp;
+}
+
+/**
+ * @brief Records a quiet move which caused a beta cutoff in the killer and history tables.
+ *
+ * @param search The search context.
+ * @param color The color of the player who played the move.
+ * @param move The move.
+ * @param depth The remaining depth of the node.
+ * @param ply The distance from the root.
+ */
+static void update_quiet_heuristics(search_t *search, color_t color, const move_t *move, int depth, int ply) {
+    const uint16_t key = get_move_key(move);
+
+    if (search->killer_moves[ply][0] != key) {
+        search->killer_moves[ply][1] = search->killer_moves[ply][0];
+        search->killer_moves[ply][0] = key;
+    }
+
+    int *history = &search->history[color][lsb_index(get_move_from_square(move))][lsb_index(get_move_to_square(move))];
+    *history += depth * depth;
+
+    // Keep history scores below the killer scores by halving the whole table when one grows too large
+    if (*history >= HISTORY_LIMIT) {
+        for (int c = 0; c < 2; c++)
+            for (int from = 0; from < 64; from++)
+                for (int to = 0; to < 64; to++) search->history[c][from][to] /= 2;
+    }
+}
+
+
+/*
++=============================================================================+
+|             Search                                                          |
++=============================================================================+
+*/
+
+/**
+ * @brief Checks whether the move which led to a child left the king of the player who made it in check.
+ *
+ * The attack maps of the child are kept at the next ply, where the search of the child finds them.
+ *
+ * @param search The search context.
+ * @param child The state after the move.
+ * @param ply The distance of the parent from the root.
+ * @return true if the move was illegal.
+ */
+static bool is_king_left_in_check(search_t *search, const state_t *child, int ply) {
+    const color_t color = get_state_to_move_color(child);
+    const uint64_t king = get_state_peice_bitboard(child, PIECE_KING, color == WHITE ? BLACK : WHITE);
+    return king & get_attack_info(child, &search->attack_info[ply + 1])->attacked[color];
+}
+
+/**
+ * @brief Converts a score to the form stored in the transposition table (mate scores relative to the node).
+ */
+static int score_to_tt(int score, int ply) {
+    if (score >= MATE_SCORE - MAX_PLY) return score + ply;
+    if (score <= -MATE_SCORE + MAX_PLY) return score - ply;
+    return score;
+}
+
+/**
+ * @brief Converts a score read from the transposition table back to a score relative to the root.
+ */
+static int score_from_tt(int score, int ply) {
+    if (score >= MATE_SCORE - MAX_PLY) return score - ply;
+    if (score <= -MATE_SCORE + MAX_PLY) return score + ply;
+    return score;
+}
+
+/**
+ * @brief Checks whether the given side has any piece other than pawns and the king.
+ */
+static bool has_non_pawn_material(const state_t *state, color_t color) {
+    return (get_state_peice_bitboard(state, PIECE_ROOK, color) | get_state_peice_bitboard(state, PIECE_KNIGHT, color) |
+            get_state_peice_bitboard(state, PIECE_BISHOP, color) | get_state_peice_bitboard(state, PIECE_QUEEN, color)) != 0;
+}
+
+/**
+ * @brief Copies the principal variation of the child node behind a move at the current ply.
+ */
+static void update_pv(search_t *search, int ply, uint16_t move_key) {
+    search->pv[ply][ply] = move_key;
+    for (int i = ply + 1; i < search->pv_length[ply + 1]; i++) search->pv[ply][i] = search->pv[ply + 1][i];
+    search->pv_length[ply] = search->pv_length[ply + 1] > ply + 1 ? search->pv_length[ply + 1] : ply + 1;
+}
+
+/**
+ * The quiescence search resolves captures at the leaves of the main search so the static evaluation
+ * is only applied to quiet positions.
+ *
+ * @param search The search context.
+ * @param state The current game state.
+ * @param ply The distance from the root.
+ * @param alpha The lower bound of the search window.
+ * @param beta The upper bound of the search window.
+ * @return The score of the state from the perspective of the player to move.
+ */
+static int quiescence(search_t *search, const state_t *state, int ply, int alpha, int beta) {
+    if (visit_node(search, ply)) return 0;
+    STATS_INC(&search->stats, quiescence_nodes);
+
+    // The attack maps serve the evaluation and then the legality checks of the captures
+    const attack_info_t *attack_info = get_attack_info(state, &search->attack_info[ply]);
+    int stand_pat = (int)evaluate_state_with_attack_info(state, attack_info, &search->params.evaluation);
+    if (ply >= MAX_PLY - 1 || stand_pat >= beta) return stand_pat;
+    if (stand_pat > alpha) alpha = stand_pat;
+
+    // Everything this node allocates is given back to the arena when it returns
+    const arena_mark_t mark = get_arena_mark(search->arena);
+    state_t *child = new_arena_state(search->arena);
+
+    scored_move_t moves[MAX_MOVES];
+    int count = drain_collection(generate_arena_psudo_legal_moves(state, attack_info, search->arena), moves);
+    score_moves(search, state, moves, count, NULL_MOVE_KEY, ply);
+
+    int best_score = stand_pat;
+
+    for (int i = 0; i < count; i++) {
+        pick_next_move(moves, i, count);
+
+        // Only captures and promotions are searched, they are ordered ahead of every quiet move
+        if (!moves[i].is_capture && get_move_flags(moves[i].move)->promotion_piece == NULL_PIECE) break;
+
+        // Moves are only played when the attack maps cannot rule them out
+        const move_legality_t legality = get_move_legality(state, attack_info, moves[i].move);
+        if (legality == MOVE_ILLEGAL) continue;
+
+        copy_state(state, child);
+        play_move(child, moves[i].move);
+
+        if (legality == MOVE_LEGALITY_UNKNOWN && is_king_left_in_check(search, child, ply)) continue;
+
+        int score = -quiescence(search, child, ply + 1, -beta, -alpha);
+
+        if (should_abort(search)) {
+            release_arena_to_mark(search->arena, mark);
+            return 0;
+        }
+
+        if (score > best_score) {
+            best_score = score;
+            if (score > alpha) {
+                alpha = score;
+                if (score >= beta) break;
+            }
+        }
+    }
+
+    release_arena_to_mark(search->arena, mark);
+    return best_score;
+}
 
 /**
- * The minimax function is a recursive function that uses the minimax algorithm with alpha-beta pruning 
+ * The negamax function is a recursive function that uses the minimax algorithm with alpha-beta pruning
  * to search the game tree for the best move.
  *
+ * @param search The search context.
  * @param state The current game state.
- * @param depth The maximum depth to search to.
+ * @param depth The remaining depth to search to.
+ * @param ply The distance from the root.
  * @param alpha The best (highest) score that the calling function can guarantee at this level or above.
  * @param beta The worst (lowest) score that the calling function can guarantee at the next level or above.
- * @param best_move A pointer to a move_t struct where the best move will be stored.
+ * @param allow_null Whether a null move may be tried at this node.
  * @return The score of the best move.
  */
-float minimax(const state_t *state, int depth, int alpha, int beta, move_t *best_move) {
+static int negamax(search_t *search, const state_t *state, int depth, int ply, int alpha, int beta, bool allow_null) {
+    // The root is never scored as a draw, so a move is always found
+    // A draw ends the line here, the parent must not copy the principal variation of an earlier sibling
+    if (ply > 0 && is_draw(search, state, ply)) {
+        search->pv_length[ply] = ply;
+        return 0;
+    }
+
+    // The attack maps serve the check test, the move generation and the legality checks of the node
+    const color_t color = get_state_to_move_color(state);
+    const attack_info_t *attack_info = get_attack_info(state, &search->attack_info[ply]);
+    const bool in_check = attack_info->checkers != 0;
+    const bool is_pv_node = beta - alpha > 1;
+
+    // Extend checks so forced sequences are not cut off at the horizon
+    if (in_check) depth += search->params.check_extension;
+
+    // Base case: if we've reached the maximum depth, resolve captures and evaluate the state.
+    if (depth <= 0) return quiescence(search, state, ply, alpha, beta);
+
+    if (visit_node(search, ply)) return 0;
+    TRACE_EVENT(search->trace, TRACE_NODE, depth, ply, NULL_MOVE_KEY, alpha, 0);
+    if (ply >= MAX_PLY - 1) return (int)evaluate_state_with_attack_info(state, attack_info, &search->params.evaluation);
+
+    // Probe the transposition table for a cutoff or a move to try first
+    const uint64_t key = get_state_hash_key(state);
+    uint16_t tt_move = NULL_MOVE_KEY;
+    tt_data_t tt_data;
+
+    STATS_INC(&search->stats, tt_probes);
+    if (probe_transposition_table(search->table, key, &tt_data)) {
+        STATS_INC(&search->stats, tt_hits);
+        tt_move = tt_data.move_key;
+        int tt_score = score_from_tt(tt_data.score, ply);
+
+        if (!is_pv_node && ply > 0 && tt_data.depth >= depth) {
+            if (tt_data.bound == BOUND_EXACT
+                || (tt_data.bound == BOUND_LOWER && tt_score >= beta)
+                || (tt_data.bound == BOUND_UPPER && tt_score <= alpha)) {
+                STATS_INC(&search->stats, tt_cutoffs);
+                return tt_score;
+            }
+        }
+    }
+
+    // Everything this node allocates is given back to the arena when it returns
+    const arena_mark_t mark = get_arena_mark(search->arena);
+    state_t *child = new_arena_state(search->arena);
+
+    // Null move pruning: if passing still fails high the position is good enough to cut
+    const search_params_t *params = &search->params;
+    if (allow_null && !is_pv_node && !in_check && depth >= params->null_move_min_depth && has_non_pawn_material(state, color) &&
+        (int)evaluate_state_with_attack_info(state, attack_info, &params->evaluation) >= beta) {
+        STATS_INC(&search->stats, null_move_tries);
+        copy_state(state, child);
+        play_null_move(child);
+
+        int reduction = params->null_move_reduction + depth / params->null_move_depth_divisor;
+        int score = -negamax(search, child, depth - 1 - reduction, ply + 1, -beta, -beta + 1, false);
+
+        if (should_abort(search)) {
+            release_arena_to_mark(search->arena, mark);
+            return 0;
+        }
+        if (score >= beta) {
+            STATS_INC(&search->stats, null_move_cutoffs);
+            release_arena_to_mark(search->arena, mark);
+            return IS_MATE_SCORE(score) ? beta : score;
+        }
+    }
 
-    // Base case: if we've reached the maximum depth, evaluate the state and return the score.
-    if (depth == 0) return evaluate_state(state);
-    
     // Generate all possible moves from the current state.
-    move_collection_t *moves = generate_psudo_legal_moves(state);
-    prune_illegal_moves(state, moves);
+    scored_move_t moves[MAX_MOVES];
+    int count = drain_collection(generate_arena_psudo_legal_moves(state, attack_info, search->arena), moves);
+    score_moves(search, state, moves, count, tt_move, ply);
 
-    int max_eval = INT_MIN;
-    move_t *max_move = NULL;
+    const int original_alpha = alpha;
+    int best_score = -INFINITE_SCORE;
+    uint16_t best_move = NULL_MOVE_KEY;
+    int legal_moves = 0;
 
     // Iterate over all moves.
-    move_t *curr_move = pop_collection_head(moves);
-    while (curr_move != NULL) {
-        // Apply the current move to a copy of the state.
-        state_t *tmp_state = new_state();
-        copy_state(state, tmp_state);
-        apply_move(curr_move, tmp_state);
+    for (int i = 0; i < count; i++) {
+        pick_next_move(moves, i, count);
+        move_t *move = moves[i].move;
+
+        // Pseudo legal moves which leave the king in check are skipped, most are told apart by the attack maps
+        const move_legality_t legality = get_move_legality(state, attack_info, move);
+        if (legality == MOVE_ILLEGAL) continue;
+
+        // Apply the current move to a copy of the state, and start loading the child's entry while it is checked.
+        copy_state(state, child);
+        play_move(child, move);
+        prefetch_transposition_table(search->table, get_state_hash_key(child));
 
-        // Recursively call minimax on the new state.
-        float eval = -1 * minimax(tmp_state, depth - 1, -beta, -alpha, NULL);
-        free_state(tmp_state);
+        if (legality == MOVE_LEGALITY_UNKNOWN && is_king_left_in_check(search, child, ply)) continue;
+
+        legal_moves++;
+
+        const bool is_quiet = !moves[i].is_capture && get_move_flags(move)->promotion_piece == NULL_PIECE;
+        int score;
+
+        // Recursively search the new state, the first move with a full window and the rest with a null window.
+        if (legal_moves == 1) {
+            score = -negamax(search, child, depth - 1, ply + 1, -beta, -alpha, true);
+        } else {
+            // Late move reductions: quiet moves ordered late are searched shallower first
+            int reduction = 0;
+            if (depth >= params->lmr_min_depth && legal_moves > params->lmr_min_moves && is_quiet && !in_check
+                && !get_attack_info(child, &search->attack_info[ply + 1])->checkers) {
+                reduction = legal_moves > params->lmr_late_moves ? 2 : 1;
+            }
+
+            STATS_ADD(&search->stats, lmr_reductions, reduction > 0);
+            score = -negamax(search, child, depth - 1 - reduction, ply + 1, -alpha - 1, -alpha, true);
+            if (score > alpha && reduction) {
+                STATS_INC(&search->stats, lmr_researches);
+                score = -negamax(search, child, depth - 1, ply + 1, -alpha - 1, -alpha, true);
+            }
+            if (score > alpha && score < beta) score = -negamax(search, child, depth - 1, ply + 1, -beta, -alpha, true);
+        }
+
+        if (should_abort(search)) {
+            release_arena_to_mark(search->arena, mark);
+            return 0;
+        }
 
         // If this move is better than the current best move, update the best move and the best score.
-        if (max_move == NULL || eval > max_eval) {
-            if (max_move != NULL) free_move(max_move);
-            max_move = curr_move;
-            max_eval = eval;
-        } 
-        
-        // If this move is not better than the current best move, free the memory allocated for it.
-        else free_move(curr_move);
+        if (score > best_score) {
+            best_score = score;
+            best_move = get_move_key(move);
+
+            // Update alpha (the best score that we can guarantee at this level or above).
+            if (score > alpha) {
+                alpha = score;
+                update_pv(search, ply, best_move);
 
-        // Update alpha (the best score that we can guarantee at this level or above).
-        alpha = alpha > eval ? alpha : eval;
+                // If alpha is greater than or equal to beta, prune this branch.
+                if (alpha >= beta) {
+                    STATS_INC(&search->stats, beta_cutoffs);
+                    STATS_ADD(&search->stats, first_move_cutoffs, legal_moves == 1);
+                    TRACE_EVENT(search->trace, TRACE_CUTOFF, depth, ply, best_move, score, 0);
+                    if (is_quiet) update_quiet_heuristics(search, color, move, depth, ply);
+                    break;
+                }
+            }
+        }
+    }
 
-        // If alpha is greater than or equal to beta, prune this branch.
-        if (alpha >= beta) break;
+    release_arena_to_mark(search->arena, mark);
 
-        curr_move = pop_collection_head(moves);
-        
-    }    
+    // No legal moves: checkmate or stalemate
+    if (legal_moves == 0) return in_check ? -MATE_SCORE + ply : 0;
 
-    // Free the memory allocated for the move collection.
-    free_move_collection(moves);
+    tt_data_t entry = {
+        .move_key = best_move,
+        .score = (int16_t)score_to_tt(best_score, ply),
+        .depth = (int8_t)depth,
+        .bound = best_score >= beta ? BOUND_LOWER : (best_score > original_alpha ? BOUND_EXACT : BOUND_UPPER)
+    };
+    store_transposition_table(search->table, key, entry);
+    TRACE_EVENT(search->trace, TRACE_TT_STORE, depth, ply, best_move, entry.score, entry.bound);
 
-    // Store the best move in the best_move parameter.
-    best_move = max_move;
-    
-    return max_eval;
+    return best_score;
 }
 
 /**
- * The do_move_search function is the entry point for the search. It calls the minimax function 
- * with the initial alpha and beta values.
- *
- * @param state The current game state.
- * @param best_move A pointer to a move_t struct where the best move will be stored.
- * @param max_depth The maximum depth to search to.
+ * The do_move_search function is the entry point for the search. It runs the negamax search with
+ * increasing depth until a limit is reached, and reports each completed iteration.
  */
-void do_move_search(const state_t *state, move_t *best_move, int max_depth) {
-    minimax(state, max_depth, INT_MIN, INT_MAX, best_move);
-}
\ No newline at end of file
+search_result_t do_move_search(search_t *search, const state_t *state, const search_limits_t *limits) {
+    search_result_t result;
+    memset(&result, 0, sizeof(result));
+
+    search->limits = *limits;
+    search->start_time = get_time_ms();
+    search->last_info_time = search->start_time;
+    search->nodes = 0;
+    search->seldepth = 0;
+    search->completed_depth = 0;
+    search->aborted = false;
+    load_key_history(search, state);
+
+#ifdef SEARCH_STATS
+    memset(&search->stats, 0, sizeof(search->stats));
+    search->stats.searches = 1;
+#endif
+
+    allocate_time(search, get_state_to_move_color(state));
+
+    const int max_depth = limits->depth > 0 && limits->depth < MAX_PLY ? limits->depth : MAX_PLY - 1;
+    TRACE_EVENT(search->trace, TRACE_SEARCH_START, max_depth, 0, NULL_MOVE_KEY, 0, 0);
+
+    for (int depth = 1; depth <= max_depth; depth++) {
+        search->seldepth = 0;
+        reset_arena(search->arena);
+        int score = negamax(search, state, depth, 0, -INFINITE_SCORE, INFINITE_SCORE, false);
+
+        if (should_abort(search)) break;
+
+        search->completed_depth = depth;
+        STATS_ADD(&search->stats, iteration_nodes[depth], search->nodes - result.nodes);
+        result.nodes = search->nodes;
+        result.best_move = search->pv_length[0] > 0 ? search->pv[0][0] : NULL_MOVE_KEY;
+        result.score = score;
+        result.depth = depth;
+        result.seldepth = search->seldepth;
+        result.pv_length = search->pv_length[0];
+        memcpy(result.pv, search->pv[0], sizeof(uint16_t) * search->pv_length[0]);
+
+        TRACE_EVENT(search->trace, TRACE_ITERATION, depth, 0, result.best_move, score, 0);
+        if (search->report_info) report_iteration(search, depth, score);
+
+        // No legal moves at the root, or a forced mate was found within the searched depth
+        if (result.best_move == NULL_MOVE_KEY) break;
+        if (IS_MATE_SCORE(score) && MATE_SCORE - abs(score) <= depth) break;
+
+        if (search->soft_time_limit && get_time_ms() - search->start_time >= search->soft_time_limit) break;
+        if (search->limits.nodes && search->nodes >= search->limits.nodes) break;
+        if (is_search_stopped(search)) break;
+    }
+
+    result.nodes = search->nodes;
+    result.time_ms = get_time_ms() - search->start_time;
+
+#ifdef SEARCH_STATS
+    search->stats.nodes = search->nodes;
+    publish_search_stats(&search->stats);
+#endif
+
+    return result;
+}
@@ -1,15 +1,21 @@
-/* iMate -- Copyright (C) 2024 Martin Newbound */                                                    
+/* iMate -- Copyright (C) 2024 Martin Newbound */
 
 /**
- * @file 
- * @brief
- * 
- * @details
+ * @file Search.h
+ * @brief This file contains the declarations of the functions and data structures used to search for the best move.
+ *
+ * @details The search is an iterative deepening, principal variation alpha-beta search with a quiescence search
+ * at the leaves. It is backed by a transposition table and uses null move pruning, late move reductions, killer
+ * moves and a history table to order and prune moves.
+ *
+ * A search_t holds everything a single search thread needs (node counters, heuristic tables, the arena its nodes
+ * allocate their moves and states from, the principal variation and the stop flag). Only the transposition table
+ * may be shared between searches.
 
  * @version 1.0.0
  * @author Martin Newbound
  * @date 2024
- * 
+ *
  * @note License:
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -20,19 +26,205 @@
 #ifndef SEARCH_H
 #define SEARCH_H
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
 #include "../State/GameState.h"
 #include "../Moves/Move.h"
+#include "../Evaluation/Evaluation.h"
+#include "TranspositionTable.h"
+
+#define MAX_PLY 128
+#define MATE_SCORE 32000
+#define INFINITE_SCORE 32001
+
+// Scores this close to MATE_SCORE describe a forced mate rather than a material evaluation
+#define IS_MATE_SCORE(SCORE) ((SCORE) >= MATE_SCORE - MAX_PLY || (SCORE) <= -MATE_SCORE + MAX_PLY)
+
+// The number of moves to a forced mate described by a mate score, negative when the side to move is mated
+#define MATE_IN_MOVES(SCORE) ((SCORE) > 0 ? (MATE_SCORE - (SCORE) + 1) / 2 : -(MATE_SCORE + (SCORE)) / 2)
+
+/**
+ * @brief The limits a search must respect, mirroring the arguments of the UCI "go" command.
+ *
+ * A value of zero means the limit is not set.
+ */
+typedef struct {
+    int depth;
+    uint64_t nodes;
+    int64_t move_time;      // milliseconds
+    int64_t time[2];        // remaining clock time per color, milliseconds
+    int64_t increment[2];   // increment per move per color, milliseconds
+    int moves_to_go;
+    bool infinite;
+} search_limits_t;
+
+/**
+ * @brief The parameters of the pruning and extension rules of a search, and the weights of its evaluation.
+ *
+ * Each search context holds its own set, so a change made tunable this way can be played against the
+ * previous behaviour in a match (see set_search_param).
+ */
+typedef struct {
+    int check_extension;            // plies added to the depth of a node in check
+    int null_move_min_depth;        // least depth at which a null move is tried
+    int null_move_reduction;        // reduction of a null move search, before the depth dependent part
+    int null_move_depth_divisor;    // the reduction grows by a ply for every this many plies of depth
+    int lmr_min_depth;              // least depth at which late moves are reduced
+    int lmr_min_moves;              // moves searched at full depth before the reductions start
+    int lmr_late_moves;             // moves after which the reduction is two plies instead of one
+    evaluation_params_t evaluation;
+} search_params_t;
+
+/**
+ * @brief The outcome of a search.
+ */
+typedef struct {
+    uint16_t best_move;
+    int score;
+    int depth;
+    int seldepth;
+    uint64_t nodes;
+    int64_t time_ms;
+    uint16_t pv[MAX_PLY];
+    int pv_length;
+} search_result_t;
+
+// Represents the context of a single search thread
+typedef struct search search_t;
+
+/**
+ * @brief Resets search limits to "no limit".
+ *
+ * @param[out] limits The limits to reset.
+ */
+void init_search_limits(search_limits_t *limits);
+
+/**
+ * @brief Sets search parameters to the engine's defaults.
+ *
+ * @param[out] params The parameters to set.
+ */
+void init_search_params(search_params_t *params);
+
+/**
+ * @brief Sets one search parameter by name, such as "NullMoveReduction" or "MobilityWeight".
+ *
+ * @param params The parameters.
+ * @param name The name of the parameter.
+ * @param value The new value.
+ * @return false if there is no parameter of that name or the value is out of its range, in which case
+ * the parameters are unchanged.
+ */
+bool set_search_param(search_params_t *params, const char *name, int value);
+
+/**
+ * @brief Prints the names of the search parameters with their ranges, one per line.
+ */
+void print_search_params(void);
+
+/**
+ * @brief Creates a new search context.
+ *
+ * @param table The transposition table the search reads from and writes to.
+ * @return A pointer to the new search context.
+ *
+ * @warning The caller is responsible for freeing the search with free_search.
+ */
+search_t *new_search(transposition_table_t *table);
+
+/**
+ * @brief Frees a search context. The transposition table is not freed.
+ *
+ * @param search The search to free.
+ */
+void free_search(search_t *search);
+
+/**
+ * @brief Gives the search the positions of the game played so far, so it can recognise repetitions.
+ *
+ * @details Only the last FIFTY_MOVE_RULE_PLIES keys are kept, older positions can never be repeated.
+ * The history is used by the following searches of a state whose key is the last of the history, a search
+ * of any other state only knows its root position.
+ *
+ * @param search The search context.
+ * @param keys The hash keys of the positions of the game, the last one being the position to search.
+ * @param key_count The number of keys.
+ */
+void set_search_game_history(search_t *search, const uint64_t *keys, int key_count);
+
+/**
+ * @brief Replaces the parameters of a search context, which starts with the defaults.
+ *
+ * @param search The search context.
+ * @param params The new parameters.
+ */
+void set_search_params(search_t *search, const search_params_t *params);
+
+/**
+ * @brief Enables or disables the printing of UCI "info" lines while searching.
+ *
+ * @param search The search context.
+ * @param report_info true to print info lines to standard output.
+ */
+void set_search_reporting(search_t *search, bool report_info);
+
+/**
+ * @brief Clears the killer and history tables, used when a new game starts.
+ *
+ * @param search The search context.
+ */
+void clear_search_heuristics(search_t *search);
+
+/**
+ * @brief Requests a running search to stop as soon as possible.
+ *
+ * @details This function may be called from another thread than the one running the search.
+ *
+ * @param search The search context.
+ */
+void stop_search(search_t *search);
+
+/**
+ * @brief Checks whether a stop has been requested for the search.
+ *
+ * @param search The search context.
+ * @return true if stop_search has been called since the search started.
+ */
+bool is_search_stopped(const search_t *search);
+
+/**
+ * @brief Clears a stop request so the next search runs until its limits.
+ *
+ * @details A stop request stays in effect until it is cleared, so a stop sent before a search
+ * thread has started searching is not lost.
+ *
+ * @param search The search context.
+ */
+void reset_search_stop(search_t *search);
 
 /**
  * @brief Performs a search to find the best move from the current game state.
  *
- * This function performs a depth-first search of the game tree to find the best move from the current game state.
- * The search is performed up to a specified maximum depth.
+ * This function performs an iterative deepening search of the game tree to find the best move from the current
+ * game state. The search runs until one of the limits is reached or stop_search is called. The first
+ * iteration always completes so a best move is available.
  *
+ * The transposition table is not aged, the owner of the table calls age_transposition_table before a search
+ * which starts a new move (a table shared by parallel searches is aged once, before they start).
+ *
+ * @param[in] search The search context.
  * @param[in] state Pointer to the game state.
- * @param[out] best_move Pointer to a move_t object where the best move will be stored.
- * @param[in] max_depth The maximum depth of the search.
+ * @param[in] limits The limits of the search.
+ * @return The best move found along with the score and statistics of the search.
  */
-void do_move_search(const state_t *state, move_t *best_move, int max_depth);
+search_result_t do_move_search(search_t *search, const state_t *state, const search_limits_t *limits);
+
+#ifdef __cplusplus
+}
+#endif
 
-#endif // SEARCH_H
\ No newline at end of file
+#endif // SEARCH_H
@@ -0,0 +1,76 @@
+/* iMate -- Copyright (C) 2024 Martin Newbound */
+
+#include "SearchStats.h"
+
+#ifdef SEARCH_STATS
+
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+
+static search_stats_t report;
+static pthread_mutex_t report_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @brief Returns a count as a percentage of another, or zero when the total is zero.
+ */
+static double percentage(uint64_t count, uint64_t total) {
+    return total ? 100.0 * (double)count / (double)total : 0.0;
+}
+
+void publish_search_stats(const search_stats_t *stats) {
+    pthread_mutex_lock(&report_lock);
+
+    report.searches += stats->searches;
+    report.nodes += stats->nodes;
+    report.quiescence_nodes += stats->quiescence_nodes;
+    report.tt_probes += stats->tt_probes;
+    report.tt_hits += stats->tt_hits;
+    report.tt_cutoffs += stats->tt_cutoffs;
+    report.beta_cutoffs += stats->beta_cutoffs;
+    report.first_move_cutoffs += stats->first_move_cutoffs;
+    report.null_move_tries += stats->null_move_tries;
+    report.null_move_cutoffs += stats->null_move_cutoffs;
+    report.lmr_reductions += stats->lmr_reductions;
+    report.lmr_researches += stats->lmr_researches;
+    for (int depth = 0; depth < STATS_MAX_DEPTH; depth++) report.iteration_nodes[depth] += stats->iteration_nodes[depth];
+
+    pthread_mutex_unlock(&report_lock);
+}
+
+void reset_search_stats_report(void) {
+    pthread_mutex_lock(&report_lock);
+    memset(&report, 0, sizeof(report));
+    pthread_mutex_unlock(&report_lock);
+}
+
+void print_search_stats_report(void) {
+    pthread_mutex_lock(&report_lock);
+    const search_stats_t stats = report;
+    pthread_mutex_unlock(&report_lock);
+
+    printf("searches            %llu\n", (unsigned long long)stats.searches);
+    printf("nodes               %llu\n", (unsigned long long)stats.nodes);
+    printf("quiescence nodes    %llu (%.1f%% of nodes)\n", (unsigned long long)stats.quiescence_nodes, percentage(stats.quiescence_nodes, stats.nodes));
+    printf("tt probes           %llu\n", (unsigned long long)stats.tt_probes);
+    printf("tt hits             %llu (%.1f%% of probes)\n", (unsigned long long)stats.tt_hits, percentage(stats.tt_hits, stats.tt_probes));
+    printf("tt cutoffs          %llu (%.1f%% of probes)\n", (unsigned long long)stats.tt_cutoffs, percentage(stats.tt_cutoffs, stats.tt_probes));
+    printf("beta cutoffs        %llu\n", (unsigned long long)stats.beta_cutoffs);
+    printf("first move cutoffs  %llu (%.1f%% of cutoffs)\n", (unsigned long long)stats.first_move_cutoffs, percentage(stats.first_move_cutoffs, stats.beta_cutoffs));
+    printf("null move tries     %llu\n", (unsigned long long)stats.null_move_tries);
+    printf("null move cutoffs   %llu (%.1f%% of tries)\n", (unsigned long long)stats.null_move_cutoffs, percentage(stats.null_move_cutoffs, stats.null_move_tries));
+    printf("lmr reductions      %llu\n", (unsigned long long)stats.lmr_reductions);
+    printf("lmr re-searches     %llu (%.1f%% of reductions)\n", (unsigned long long)stats.lmr_researches, percentage(stats.lmr_researches, stats.lmr_reductions));
+
+    // The effective branching factor of a depth is the cost of its iteration relative to the previous one
+    printf("\ndepth  iteration nodes     ebf\n");
+    for (int depth = 1; depth < STATS_MAX_DEPTH && stats.iteration_nodes[depth]; depth++) {
+        printf("%5d  %15llu", depth, (unsigned long long)stats.iteration_nodes[depth]);
+        if (depth > 1 && stats.iteration_nodes[depth - 1]) printf("  %6.2f", (double)stats.iteration_nodes[depth] / (double)stats.iteration_nodes[depth - 1]);
+        printf("\n");
+    }
+
+    fflush(stdout);
+}
+
+#endif // SEARCH_STATS
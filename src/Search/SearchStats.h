@@ -0,0 +1,93 @@
+/* iMate -- Copyright (C) 2024 Martin Newbound */
+
+/**
+ * @file SearchStats.h
+ * @brief This file contains the declarations of the counters used to analyze the behaviour of the search.
+ * 
+ * @details The counters only exist when the engine is built with SEARCH_STATS defined (the CMake option
+ * IMATE_SEARCH_STATS). Otherwise the STATS_ macros expand to nothing and the search carries no counters at all.
+ * 
+ * Every search context counts into its own search_stats_t, so threads never share counters. When a search ends
+ * its counters are merged into a report, which the "stats" command prints. The report is reset whenever
+ * a new search, or a new batch of searches, starts.
+ * 
+ * @version 1.0.0
+ * @author Martin Newbound
+ * @date 2024
+ * 
+ * @note License:
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef SEARCH_STATS_H
+#define SEARCH_STATS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+// Iterations counted per depth, matching MAX_PLY of Search.h
+#define STATS_MAX_DEPTH 128
+
+#ifdef SEARCH_STATS
+
+/**
+ * @brief The counters of one or more searches.
+ */
+typedef struct {
+    uint64_t searches;
+    uint64_t nodes;                 // main search and quiescence nodes
+    uint64_t quiescence_nodes;
+    uint64_t tt_probes;
+    uint64_t tt_hits;
+    uint64_t tt_cutoffs;
+    uint64_t beta_cutoffs;
+    uint64_t first_move_cutoffs;    // beta cutoffs caused by the first move searched
+    uint64_t null_move_tries;
+    uint64_t null_move_cutoffs;
+    uint64_t lmr_reductions;
+    uint64_t lmr_researches;        // reduced searches which failed high and were searched again
+    uint64_t iteration_nodes[STATS_MAX_DEPTH];  // nodes spent on each iteration of iterative deepening
+} search_stats_t;
+
+#define STATS_ADD(STATS, FIELD, AMOUNT) ((STATS)->FIELD += (AMOUNT))
+
+/**
+ * Adds the counters of a search to the report printed by the "stats" command.
+ * 
+ * This function is thread safe.
+ * 
+ * @param stats The counters to add.
+ */
+void publish_search_stats(const search_stats_t *stats);
+
+/**
+ * Clears the report printed by the "stats" command.
+ */
+void reset_search_stats_report(void);
+
+/**
+ * Prints the report: the counters of every search since the last reset, with the derived rates
+ * and the effective branching factor of each depth.
+ */
+void print_search_stats_report(void);
+
+#else
+
+#define STATS_ADD(STATS, FIELD, AMOUNT) ((void)0)
+#define reset_search_stats_report() ((void)0)
+
+#endif // SEARCH_STATS
+
+#define STATS_INC(STATS, FIELD) STATS_ADD(STATS, FIELD, 1)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SEARCH_STATS_H
@@ -0,0 +1,113 @@
+/* iMate -- Copyright (C) 2024 Martin Newbound */
+
+#include "SearchThread.h"
+#include "../Utils/Clock.h"
+#include "SearchStats.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// How often an infinite search which has finished polls for "stop", in milliseconds
+#define INFINITE_POLL_MS 5
+
+struct search_thread {
+    pthread_t thread;
+    bool is_running;
+
+    transposition_table_t *table;
+    search_t *search;
+
+    state_t *state;
+    search_limits_t limits;
+};
+
+/**
+ * @brief The body of the search thread: searches the stored state and prints the best move.
+ *
+ * @param argument The search thread.
+ * @return Always NULL.
+ */
+static void *search_thread_main(void *argument) {
+    search_thread_t *thread = argument;
+
+    search_result_t result = do_move_search(thread->search, thread->state, &thread->limits);
+
+    // The UCI protocol forbids sending "bestmove" during an infinite search before "stop" is received
+    while (thread->limits.infinite && !is_search_stopped(thread->search)) sleep_ms(INFINITE_POLL_MS);
+
+    char move_string[MOVE_STRING_LENGTH] = "0000";
+    if (result.best_move != NULL_MOVE_KEY) move_key_to_string(result.best_move, move_string);
+
+    if (result.pv_length > 1) {
+        char ponder_string[MOVE_STRING_LENGTH];
+        move_key_to_string(result.pv[1], ponder_string);
+        printf("bestmove %s ponder %s\n", move_string, ponder_string);
+    } else {
+        printf("bestmove %s\n", move_string);
+    }
+
+    fflush(stdout);
+    return NULL;
+}
+
+search_thread_t *new_search_thread(size_t hash_size_mb) {
+    search_thread_t *thread = malloc(sizeof(search_thread_t));
+    thread->is_running = false;
+    thread->table = new_transposition_table(hash_size_mb);
+    thread->search = new_search(thread->table);
+    thread->state = new_state();
+    set_search_reporting(thread->search, true);
+    return thread;
+}
+
+void free_search_thread(search_thread_t *thread) {
+    stop_search_thread(thread);
+    free_search(thread->search);
+    free_transposition_table(thread->table);
+    free_state(thread->state);
+    free(thread);
+}
+
+void start_search_thread(search_thread_t *thread, const state_t *state, const uint64_t *game_keys, int game_key_count,
+                         const search_limits_t *limits) {
+    stop_search_thread(thread);
+
+    copy_state(state, thread->state);
+    set_search_game_history(thread->search, game_keys, game_key_count);
+    thread->limits = *limits;
+    age_transposition_table(thread->table);
+    reset_search_stop(thread->search);
+    reset_search_stats_report();
+    thread->is_running = pthread_create(&thread->thread, NULL, search_thread_main, thread) == 0;
+}
+
+void stop_search_thread(search_thread_t *thread) {
+    if (!thread->is_running) return;
+
+    stop_search(thread->search);
+    wait_search_thread(thread);
+}
+
+void wait_search_thread(search_thread_t *thread) {
+    if (!thread->is_running) return;
+
+    pthread_join(thread->thread, NULL);
+    thread->is_running = false;
+}
+
+bool is_search_thread_running(const search_thread_t *thread) {
+    return thread->is_running;
+}
+
+bool is_search_thread_infinite(const search_thread_t *thread) {
+    return thread->is_running && thread->limits.infinite;
+}
+
+transposition_table_t *get_search_thread_table(search_thread_t *thread) {
+    return thread->table;
+}
+
+search_t *get_search_thread_search(search_thread_t *thread) {
+    return thread->search;
+}
@@ -0,0 +1,120 @@
+/* iMate -- Copyright (C) 2024 Martin Newbound */
+
+/**
+ * @file SearchThread.h
+ * @brief This file contains the declarations of the background search thread used by the UCI front-end.
+ * 
+ * @details The UCI protocol requires the engine to keep reading commands (such as "stop" and "isready")
+ * while a search is running. A search_thread_t owns the transposition table and the search context of the
+ * engine and runs each "go" command on a separate thread, printing "bestmove" when the search ends.
+ * 
+ * @version 1.0.0
+ * @author Martin Newbound
+ * @date 2024
+ * 
+ * @note License:
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef SEARCH_THREAD_H
+#define SEARCH_THREAD_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "Search.h"
+#include "TranspositionTable.h"
+#include "../State/GameState.h"
+
+// Represents the engine's background search thread
+typedef struct search_thread search_thread_t;
+
+/**
+ * Creates a new, idle search thread along with its transposition table and search context.
+ * 
+ * @param hash_size_mb The initial size of the transposition table in megabytes.
+ * @return A pointer to the new search thread.
+ */
+search_thread_t *new_search_thread(size_t hash_size_mb);
+
+/**
+ * Stops any running search and frees the search thread.
+ * 
+ * @param thread The search thread to free.
+ */
+void free_search_thread(search_thread_t *thread);
+
+/**
+ * Starts searching a state in the background.
+ * 
+ * Any search already running is stopped first. The state is copied so the caller may modify
+ * its own state while the search is running. When the search ends "bestmove" is printed.
+ * 
+ * @param thread The search thread.
+ * @param state The state to search.
+ * @param game_keys The hash keys of the positions of the game, the last one being the key of the state.
+ * @param game_key_count The number of keys.
+ * @param limits The limits of the search.
+ */
+void start_search_thread(search_thread_t *thread, const state_t *state, const uint64_t *game_keys, int game_key_count,
+                         const search_limits_t *limits);
+
+/**
+ * Stops the running search (if any) and waits for it to print its best move.
+ * 
+ * @param thread The search thread.
+ */
+void stop_search_thread(search_thread_t *thread);
+
+/**
+ * Waits for the running search (if any) to end on its own.
+ * 
+ * @param thread The search thread.
+ */
+void wait_search_thread(search_thread_t *thread);
+
+/**
+ * Checks whether a search is running.
+ * 
+ * @param thread The search thread.
+ * @return true if a search has been started and has not been joined yet.
+ */
+bool is_search_thread_running(const search_thread_t *thread);
+
+/**
+ * Checks whether the running search only ends on "stop", as with "go infinite" or "go ponder".
+ * 
+ * @param thread The search thread.
+ * @return true if a search is running and waiting on it would never return.
+ */
+bool is_search_thread_infinite(const search_thread_t *thread);
+
+/**
+ * Returns the transposition table of the search thread.
+ * 
+ * @warning The table must not be modified while a search is running.
+ * 
+ * @param thread The search thread.
+ * @return The transposition table.
+ */
+transposition_table_t *get_search_thread_table(search_thread_t *thread);
+
+/**
+ * Returns the search context of the search thread.
+ * 
+ * @param thread The search thread.
+ * @return The search context.
+ */
+search_t *get_search_thread_search(search_thread_t *thread);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SEARCH_THREAD_H
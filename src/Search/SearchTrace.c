@@ -0,0 +1,257 @@
+/* iMate -- Copyright (C) 2024 Martin Newbound */
+
+#include "SearchTrace.h"
+
+static const char *EVENT_NAMES[TRACE_EVENT_TYPE_COUNT] = {
+    "start",
+    "node",
+    "cutoff",
+    "store",
+    "iteration"
+};
+
+const char *get_trace_event_name(int type) {
+    return type >= 0 && type < TRACE_EVENT_TYPE_COUNT ? EVENT_NAMES[type] : "unknown";
+}
+
+#ifdef SEARCH_TRACE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// Events copied out of a ring per write, the copy lives on the stack of the signal handler
+#define DUMP_CHUNK_EVENTS 128
+
+/**
+ * @brief A slot of the ring registry.
+ *
+ * Rings are never freed once registered: a search which ends gives its ring back and the next search reuses it.
+ * A dump, which may run in a signal handler at any moment, therefore never reads freed memory, and the events
+ * of the last searches stay available after they end.
+ */
+typedef struct {
+    trace_ring_t *ring;
+    bool in_use;
+} ring_slot_t;
+
+static ring_slot_t ring_slots[MAX_TRACE_RINGS];
+static uint32_t next_ring_id;
+
+// Clock readings taken when tracing was set up, used to convert timestamps to time
+static pthread_once_t calibration_once = PTHREAD_ONCE_INIT;
+static uint64_t start_ticks;
+static int64_t start_time_ns;
+
+// The file written on SIGUSR1, chosen up front as formatting a path is not async-signal-safe
+static char signal_dump_path[64];
+
+
+/*
++=============================================================================+
+|             Rings                                                           |
++=============================================================================+
+*/
+
+/**
+ * @brief Records the clock readings the timestamps are measured from.
+ */
+static void calibrate_trace_clock(void) {
+    start_ticks = read_cycle_counter();
+    start_time_ns = get_time_ns();
+}
+
+/**
+ * @brief Clears a ring and gives it a new id, before a new search uses it.
+ */
+static void reset_trace_ring(trace_ring_t *ring) {
+    __atomic_store_n(&ring->id, __atomic_fetch_add(&next_ring_id, 1, __ATOMIC_RELAXED), __ATOMIC_RELAXED);
+    __atomic_store_n(&ring->head, 0, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Claims a free slot of the registry, reusing its ring when it has one.
+ *
+ * @return The claimed ring, or NULL if every slot is taken.
+ */
+static trace_ring_t *claim_ring_slot(void) {
+    // Reuse the ring of an ended search first, then take an empty slot
+    for (int pass = 0; pass < 2; pass++) {
+        for (int i = 0; i < MAX_TRACE_RINGS; i++) {
+            ring_slot_t *slot = &ring_slots[i];
+            trace_ring_t *ring = __atomic_load_n(&slot->ring, __ATOMIC_ACQUIRE);
+            if ((ring != NULL) != (pass == 0)) continue;
+
+            bool expected = false;
+            if (!__atomic_compare_exchange_n(&slot->in_use, &expected, true, false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) continue;
+
+            // A slot which had no ring may have received one since it was looked at
+            ring = __atomic_load_n(&slot->ring, __ATOMIC_ACQUIRE);
+            if (ring == NULL) {
+                ring = calloc(1, sizeof(trace_ring_t));
+                reset_trace_ring(ring);
+                __atomic_store_n(&slot->ring, ring, __ATOMIC_RELEASE);
+            } else {
+                reset_trace_ring(ring);
+            }
+            return ring;
+        }
+    }
+
+    return NULL;
+}
+
+trace_ring_t *new_trace_ring(void) {
+    pthread_once(&calibration_once, calibrate_trace_clock);
+
+    trace_ring_t *ring = claim_ring_slot();
+    if (ring != NULL) return ring;
+
+    // More searches than slots: the ring still records, it is just not dumped
+    ring = calloc(1, sizeof(trace_ring_t));
+    reset_trace_ring(ring);
+    return ring;
+}
+
+void free_trace_ring(trace_ring_t *ring) {
+    for (int i = 0; i < MAX_TRACE_RINGS; i++) {
+        if (__atomic_load_n(&ring_slots[i].ring, __ATOMIC_ACQUIRE) == ring) {
+            __atomic_store_n(&ring_slots[i].in_use, false, __ATOMIC_RELEASE);
+            return;
+        }
+    }
+
+    free(ring);
+}
+
+int get_search_trace_size(uint64_t *event_count) {
+    int ring_count = 0;
+    *event_count = 0;
+
+    for (int i = 0; i < MAX_TRACE_RINGS; i++) {
+        const trace_ring_t *ring = __atomic_load_n(&ring_slots[i].ring, __ATOMIC_ACQUIRE);
+        if (ring == NULL) continue;
+
+        const uint64_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+        *event_count += head < TRACE_RING_SIZE ? head : TRACE_RING_SIZE;
+        ring_count++;
+    }
+
+    return ring_count;
+}
+
+
+/*
++=============================================================================+
+|             Dumps                                                           |
++=============================================================================+
+*/
+
+/**
+ * @brief Writes a whole buffer to a file descriptor, carrying on after partial writes and interruptions.
+ *
+ * @return false if the write failed.
+ */
+static bool write_all(int fd, const void *buffer, size_t size) {
+    const char *bytes = buffer;
+
+    while (size > 0) {
+        ssize_t written = write(fd, bytes, size);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        bytes += written;
+        size -= (size_t)written;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Writes the header and the held events of a ring, oldest first.
+ *
+ * @return false if the write failed.
+ */
+static bool dump_trace_ring(int fd, const trace_ring_t *ring) {
+    const uint64_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    const uint64_t count = head < TRACE_RING_SIZE ? head : TRACE_RING_SIZE;
+
+    trace_ring_header_t header = {
+        .ring_id = __atomic_load_n(&ring->id, __ATOMIC_RELAXED),
+        .event_count = (uint32_t)count,
+        .total_events = head
+    };
+    if (!write_all(fd, &header, sizeof(header))) return false;
+
+    uint64_t chunk[DUMP_CHUNK_EVENTS][2];
+    for (uint64_t index = head - count; index < head; ) {
+        int events = 0;
+        for (; events < DUMP_CHUNK_EVENTS && index < head; events++, index++) {
+            const uint64_t *slot = ring->words[index & (TRACE_RING_SIZE - 1)];
+            chunk[events][0] = __atomic_load_n(&slot[0], __ATOMIC_RELAXED);
+            chunk[events][1] = __atomic_load_n(&slot[1], __ATOMIC_RELAXED);
+        }
+        if (!write_all(fd, chunk, sizeof(chunk[0]) * (size_t)events)) return false;
+    }
+
+    return true;
+}
+
+bool dump_search_trace(const char *path) {
+    // Rings are only ever added, so the ones seen now are the ones written even if a search starts meanwhile
+    const trace_ring_t *rings[MAX_TRACE_RINGS];
+    uint32_t ring_count = 0;
+    for (int i = 0; i < MAX_TRACE_RINGS; i++) {
+        const trace_ring_t *ring = __atomic_load_n(&ring_slots[i].ring, __ATOMIC_ACQUIRE);
+        if (ring != NULL) rings[ring_count++] = ring;
+    }
+
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return false;
+
+    trace_file_header_t header = {
+        .version = TRACE_FILE_VERSION,
+        .ring_count = ring_count,
+        .start_ticks = start_ticks,
+        .start_time_ns = start_time_ns,
+        .dump_ticks = read_cycle_counter(),
+        .dump_time_ns = get_time_ns()
+    };
+    memcpy(header.magic, TRACE_FILE_MAGIC, sizeof(header.magic));
+
+    bool written = write_all(fd, &header, sizeof(header));
+    for (uint32_t i = 0; written && i < ring_count; i++) written = dump_trace_ring(fd, rings[i]);
+
+    return close(fd) == 0 && written;
+}
+
+/**
+ * @brief Dumps the rings to the file chosen by init_search_trace.
+ */
+static void handle_dump_signal(int signal_number) {
+    (void)signal_number;
+
+    const int saved_errno = errno;
+    dump_search_trace(signal_dump_path);
+    errno = saved_errno;
+}
+
+void init_search_trace(void) {
+    pthread_once(&calibration_once, calibrate_trace_clock);
+    snprintf(signal_dump_path, sizeof(signal_dump_path), "imate-trace-%ld.bin", (long)getpid());
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = handle_dump_signal;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGUSR1, &action, NULL);
+}
+
+#endif // SEARCH_TRACE
@@ -0,0 +1,197 @@
+/* iMate -- Copyright (C) 2024 Martin Newbound */
+
+/**
+ * @file SearchTrace.h
+ * @brief This file contains the declarations of the ring buffers recording the recent events of each search.
+ *
+ * @details The rings only exist when the engine is built with SEARCH_TRACE defined (the CMake option
+ * IMATE_TRACE). Otherwise TRACE_EVENT expands to nothing and the search carries no ring at all.
+ *
+ * Every search context owns a ring of the last TRACE_RING_SIZE events it went through (node entry, beta cutoff,
+ * transposition table store, completed iteration). Only the search writes to its ring, so recording an event is
+ * a read of the cycle counter and two relaxed 8 byte stores, without locks or read-modify-write instructions.
+ * Older events are overwritten, the ring always holds the latest ones.
+ *
+ * The rings can be dumped to a binary file with the "trace dump" command, or by sending SIGUSR1 to the engine,
+ * while searches are running. A dump taken during a search may hold a few events of the search's latest lap
+ * among the oldest ones, the timestamps tell them apart. The iMateTrace tool decodes a dump into text.
+ *
+ * The layout of the dump is declared whether or not tracing is compiled in, so the decoder always builds.
+ *
+ * @version 1.0.0
+ * @author Martin Newbound
+ * @date 2024
+ *
+ * @note License:
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef SEARCH_TRACE_H
+#define SEARCH_TRACE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../Utils/Clock.h"
+
+// Events kept per search, a power of two (16 bytes each)
+#define TRACE_RING_SIZE (1 << 16)
+
+// Searches whose rings can be dumped at the same time
+#define MAX_TRACE_RINGS 64
+
+#define TRACE_FILE_MAGIC "IMTRACE1"
+#define TRACE_FILE_VERSION 1
+
+/**
+ * @brief The kinds of events recorded.
+ */
+typedef enum {
+    TRACE_SEARCH_START,     // a search starts, depth is the deepest iteration allowed
+    TRACE_NODE,             // a node of the main search is entered
+    TRACE_CUTOFF,           // move is the move which failed high, score its score
+    TRACE_TT_STORE,         // move, score, depth and bound of the stored entry
+    TRACE_ITERATION,        // an iteration completed, move is its best move and score its score
+    TRACE_EVENT_TYPE_COUNT
+} trace_event_type_t;
+
+/**
+ * @brief One recorded event, 16 bytes.
+ */
+typedef struct {
+    uint64_t timestamp;     // read_cycle_counter
+    uint16_t move_key;
+    int16_t score;
+    uint8_t type;           // trace_event_type_t
+    uint8_t depth;
+    uint8_t ply;
+    uint8_t bound;          // tt_bound_t, for TT_STORE events
+} trace_event_t;
+
+/**
+ * @brief The header of a dump file, followed by ring_count rings.
+ *
+ * The two clock readings let the decoder convert timestamps to nanoseconds.
+ */
+typedef struct {
+    char magic[8];          // TRACE_FILE_MAGIC, not null terminated
+    uint32_t version;
+    uint32_t ring_count;
+    uint64_t start_ticks;   // cycle counter when tracing was set up
+    int64_t start_time_ns;  // get_time_ns at the same moment
+    uint64_t dump_ticks;    // cycle counter when the dump was taken
+    int64_t dump_time_ns;
+} trace_file_header_t;
+
+/**
+ * @brief The header of a ring in a dump file, followed by event_count events, oldest first.
+ */
+typedef struct {
+    uint32_t ring_id;       // the order in which the searches were created
+    uint32_t event_count;
+    uint64_t total_events;  // events recorded since the search was created, including overwritten ones
+} trace_ring_header_t;
+
+/**
+ * Returns the name of an event type, as printed by the decoder.
+ *
+ * @param type The event type.
+ * @return The name of the type, or "unknown".
+ */
+const char *get_trace_event_name(int type);
+
+#ifdef SEARCH_TRACE
+
+/**
+ * @brief The ring of one search. The events are stored as pairs of words so they can be copied atomically.
+ */
+typedef struct {
+    uint64_t words[TRACE_RING_SIZE][2];
+    uint64_t head;          // events recorded so far, written by the owning search only
+    uint32_t id;
+} trace_ring_t;
+
+/**
+ * Records the starting clock readings, installs the SIGUSR1 handler and chooses the file it dumps to
+ * (imate-trace-<pid>.bin in the working directory).
+ */
+void init_search_trace(void);
+
+/**
+ * Creates a ring and makes it visible to dumps.
+ *
+ * @return The new ring, free it with free_trace_ring.
+ */
+trace_ring_t *new_trace_ring(void);
+
+/**
+ * Removes a ring from dumps and frees it.
+ *
+ * @param ring The ring to free.
+ */
+void free_trace_ring(trace_ring_t *ring);
+
+/**
+ * Writes every ring to a file. This function only uses async-signal-safe calls.
+ *
+ * The clock readings of the header are only set once init_search_trace or new_trace_ring has been called.
+ *
+ * @param path The file to write.
+ * @return false if the file could not be written.
+ */
+bool dump_search_trace(const char *path);
+
+/**
+ * Returns the number of rings which would be dumped and the number of events they hold.
+ *
+ * @param[out] event_count The number of events held by the rings.
+ * @return The number of rings.
+ */
+int get_search_trace_size(uint64_t *event_count);
+
+/**
+ * Appends an event to a ring.
+ *
+ * Only the search owning the ring may call this function.
+ */
+static inline void record_trace_event(trace_ring_t *ring, int type, int depth, int ply, uint16_t move_key, int score, int bound) {
+    union {
+        trace_event_t event;
+        uint64_t words[2];
+    } record = {.event = {
+        .timestamp = read_cycle_counter(),
+        .move_key = move_key,
+        .score = (int16_t)score,
+        .type = (uint8_t)type,
+        .depth = (uint8_t)depth,
+        .ply = (uint8_t)ply,
+        .bound = (uint8_t)bound
+    }};
+
+    const uint64_t head = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+    uint64_t *slot = ring->words[head & (TRACE_RING_SIZE - 1)];
+    __atomic_store_n(&slot[0], record.words[0], __ATOMIC_RELAXED);
+    __atomic_store_n(&slot[1], record.words[1], __ATOMIC_RELAXED);
+    __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+}
+
+#define TRACE_EVENT(RING, TYPE, DEPTH, PLY, MOVE, SCORE, BOUND) \
+    record_trace_event(RING, TYPE, DEPTH, PLY, MOVE, SCORE, BOUND)
+
+#else
+
+#define TRACE_EVENT(RING, TYPE, DEPTH, PLY, MOVE, SCORE, BOUND) ((void)0)
+
+#endif // SEARCH_TRACE
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SEARCH_TRACE_H
@@ -0,0 +1,207 @@
+/* iMate -- Copyright (C) 2024 Martin Newbound */                                                    
+
+#include "TranspositionTable.h"
+#include "../Utils/Profiler.h"
+#include "../Utils/LargePages.h"
+#include "../Threads/ThreadPool.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define HASHFULL_SAMPLE_SIZE 1000
+
+// Tables smaller than this are cleared by the calling thread, starting workers would cost more than it saves
+#define PARALLEL_CLEAR_MIN_SIZE (64 * 1024 * 1024)
+
+// Bit offsets of the fields packed into the data word of an entry
+#define DATA_SCORE_SHIFT 16
+#define DATA_DEPTH_SHIFT 32
+#define DATA_BOUND_SHIFT 40
+#define DATA_AGE_SHIFT 48
+
+#define DATA_MOVE_KEY(DATA) ((uint16_t)(DATA))
+#define DATA_SCORE(DATA) ((int16_t)((DATA) >> DATA_SCORE_SHIFT))
+#define DATA_DEPTH(DATA) ((int8_t)((DATA) >> DATA_DEPTH_SHIFT))
+#define DATA_BOUND(DATA) ((uint8_t)((DATA) >> DATA_BOUND_SHIFT))
+#define DATA_AGE(DATA) ((uint8_t)((DATA) >> DATA_AGE_SHIFT))
+
+/**
+ * @brief An entry of the table.
+ *
+ * Several searches may share a table without locking. The data (move, score, depth, bound and age) is packed
+ * into one word and the key is stored XORed with it, so an entry torn by two threads writing at once no longer
+ * matches the key of either position and is treated as a miss.
+ */
+struct tt_entry {
+    uint64_t checked_key;   // key ^ data
+    uint64_t data;
+};
+
+struct transposition_table {
+    struct tt_entry *entries;
+    size_t entry_count;
+    page_kind_t page_kind;
+    uint8_t age;
+};
+
+/**
+ * @brief A part of the table cleared by one worker.
+ */
+typedef struct {
+    struct tt_entry *entries;
+    size_t entry_count;
+} entry_range_t;
+
+/**
+ * @brief Allocates the entries of a table, rounding the entry count down to a power of two.
+ *
+ * @param table The table to allocate the entries of.
+ * @param size_mb The size of the table in megabytes.
+ */
+static void allocate_entries(transposition_table_t *table, size_t size_mb) {
+    if (size_mb < MIN_HASH_SIZE_MB) size_mb = MIN_HASH_SIZE_MB;
+    if (size_mb > MAX_HASH_SIZE_MB) size_mb = MAX_HASH_SIZE_MB;
+
+    size_t entry_count = 1;
+    while (entry_count * 2 * sizeof(struct tt_entry) <= size_mb * 1024 * 1024) entry_count *= 2;
+
+    table->entries = allocate_large_pages(entry_count * sizeof(struct tt_entry), &table->page_kind);
+    table->entry_count = entry_count;
+
+    // Clearing also touches every page up front, in parallel, rather than one fault at a time during the search
+    clear_transposition_table(table);
+}
+
+/**
+ * @brief Frees the entries of a table.
+ *
+ * @param table The table to free the entries of.
+ */
+static void free_entries(transposition_table_t *table) {
+    free_large_pages(table->entries, table->entry_count * sizeof(struct tt_entry), table->page_kind);
+}
+
+/**
+ * @brief Clears a range of entries, run by the workers of clear_transposition_table.
+ *
+ * @param argument The entry_range_t to clear.
+ * @param worker_index Unused.
+ */
+static void clear_entry_range(void *argument, int worker_index) {
+    (void)worker_index;
+    const entry_range_t *range = argument;
+    memset(range->entries, 0, range->entry_count * sizeof(struct tt_entry));
+}
+
+transposition_table_t *new_transposition_table(size_t size_mb) {
+    transposition_table_t *table = malloc(sizeof(transposition_table_t));
+    allocate_entries(table, size_mb);
+    return table;
+}
+
+void free_transposition_table(transposition_table_t *table) {
+    free_entries(table);
+    free(table);
+}
+
+void resize_transposition_table(transposition_table_t *table, size_t size_mb) {
+    free_entries(table);
+    allocate_entries(table, size_mb);
+}
+
+void clear_transposition_table(transposition_table_t *table) {
+    table->age = 0;
+
+    const size_t size = table->entry_count * sizeof(struct tt_entry);
+    const int thread_count = size < PARALLEL_CLEAR_MIN_SIZE ? 1 : get_processor_count();
+    if (thread_count == 1) {
+        memset(table->entries, 0, size);
+        return;
+    }
+
+    // One range per worker, the last one also takes the entries left over by the division
+    entry_range_t *ranges = malloc(sizeof(entry_range_t) * (size_t)thread_count);
+    const size_t range_size = table->entry_count / (size_t)thread_count;
+    thread_pool_t *pool = new_thread_pool(thread_count);
+
+    for (int i = 0; i < thread_count; i++) {
+        ranges[i].entries = table->entries + range_size * (size_t)i;
+        ranges[i].entry_count = i == thread_count - 1 ? table->entry_count - range_size * (size_t)i : range_size;
+        submit_thread_pool_task(pool, clear_entry_range, &ranges[i]);
+    }
+
+    free_thread_pool(pool);
+    free(ranges);
+}
+
+const char *get_transposition_table_pages(const transposition_table_t *table) {
+    return get_page_kind_name(table->page_kind);
+}
+
+void prefetch_transposition_table(const transposition_table_t *table, uint64_t key) {
+    __builtin_prefetch(&table->entries[key & (table->entry_count - 1)]);
+}
+
+void age_transposition_table(transposition_table_t *table) {
+    table->age++;
+}
+
+/**
+ * @brief Reads the key and data of an entry, tolerating concurrent writers.
+ *
+ * @param entry The entry to read.
+ * @param[out] data Receives the data word.
+ * @return The key the entry belongs to, or a meaningless value if the entry was torn by concurrent writes.
+ */
+static uint64_t load_entry(const struct tt_entry *entry, uint64_t *data) {
+    *data = __atomic_load_n(&entry->data, __ATOMIC_RELAXED);
+    return __atomic_load_n(&entry->checked_key, __ATOMIC_RELAXED) ^ *data;
+}
+
+bool probe_transposition_table(const transposition_table_t *table, uint64_t key, tt_data_t *data) {
+    PROFILE_SCOPE(PROFILE_TT_PROBE);
+    uint64_t entry_data;
+    if (load_entry(&table->entries[key & (table->entry_count - 1)], &entry_data) != key) return false;
+    if (DATA_BOUND(entry_data) == BOUND_NONE) return false;
+
+    data->move_key = DATA_MOVE_KEY(entry_data);
+    data->score = DATA_SCORE(entry_data);
+    data->depth = DATA_DEPTH(entry_data);
+    data->bound = (bound_t)DATA_BOUND(entry_data);
+    return true;
+}
+
+void store_transposition_table(transposition_table_t *table, uint64_t key, tt_data_t data) {
+    PROFILE_SCOPE(PROFILE_TT_STORE);
+    struct tt_entry *entry = &table->entries[key & (table->entry_count - 1)];
+
+    uint64_t entry_data;
+    const bool same_position = load_entry(entry, &entry_data) == key;
+
+    // Keep deeper results of the current search for the same position, but always replace stale entries
+    if (same_position && DATA_AGE(entry_data) == table->age && data.bound != BOUND_EXACT
+        && data.depth < DATA_DEPTH(entry_data) - 2) return;
+
+    // Keep the previous best move when the new result did not find one
+    if (data.move_key == 0 && same_position) data.move_key = DATA_MOVE_KEY(entry_data);
+
+    const uint64_t new_data = (uint64_t)data.move_key
+                            | (uint64_t)(uint16_t)data.score << DATA_SCORE_SHIFT
+                            | (uint64_t)(uint8_t)data.depth << DATA_DEPTH_SHIFT
+                            | (uint64_t)(uint8_t)data.bound << DATA_BOUND_SHIFT
+                            | (uint64_t)table->age << DATA_AGE_SHIFT;
+
+    __atomic_store_n(&entry->checked_key, key ^ new_data, __ATOMIC_RELAXED);
+    __atomic_store_n(&entry->data, new_data, __ATOMIC_RELAXED);
+}
+
+int transposition_table_hashfull(const transposition_table_t *table) {
+    size_t sample_size = table->entry_count < HASHFULL_SAMPLE_SIZE ? table->entry_count : HASHFULL_SAMPLE_SIZE;
+    int used = 0;
+
+    for (size_t i = 0; i < sample_size; i++) {
+        const uint64_t data = __atomic_load_n(&table->entries[i].data, __ATOMIC_RELAXED);
+        if (DATA_BOUND(data) != BOUND_NONE && DATA_AGE(data) == table->age) used++;
+    }
+
+    return (int)(used * 1000 / sample_size);
+}
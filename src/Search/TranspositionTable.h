@@ -0,0 +1,149 @@
+/* iMate -- Copyright (C) 2024 Martin Newbound */                                                    
+
+/**
+ * @file TranspositionTable.h
+ * @brief This file contains the declarations of the transposition table used by the search.
+ * 
+ * @details The transposition table caches the results of previously searched positions, indexed by
+ * the Zobrist hash key of the game state. Entries remember the best move found, the score, the depth
+ * the position was searched to and whether the score is exact or a bound.
+ * 
+ * Probing and storing are safe while other threads probe and store the same table, so searches running in
+ * parallel may share one table. Resizing, clearing and aging must only happen while no search is running.
+ * 
+ * The entries are backed by huge pages when the system provides them (see LargePages.h), and the search
+ * prefetches the entry of a child position as soon as the move is made, so the probe rarely waits for memory.
+ * 
+ * @version 1.0.0
+ * @author Martin Newbound
+ * @date 2024
+ * 
+ * @note License:
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef TRANSPOSITION_TABLE_H
+#define TRANSPOSITION_TABLE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#define DEFAULT_HASH_SIZE_MB 16
+#define MIN_HASH_SIZE_MB 1
+#define MAX_HASH_SIZE_MB 65536
+
+typedef enum {
+    BOUND_NONE      = 0,
+    BOUND_UPPER     = 1,
+    BOUND_LOWER     = 2,
+    BOUND_EXACT     = 3
+} bound_t;
+
+/**
+ * @brief The data stored for a position in the transposition table.
+ */
+typedef struct {
+    uint16_t move_key;
+    int16_t score;
+    int8_t depth;
+    bound_t bound;
+} tt_data_t;
+
+// Represents a transposition table
+typedef struct transposition_table transposition_table_t;
+
+/**
+ * Creates a new, empty transposition table.
+ * 
+ * @param size_mb The size of the table in megabytes. The number of entries is rounded down to a power of two.
+ * @return A pointer to the new transposition table.
+ */
+transposition_table_t *new_transposition_table(size_t size_mb);
+
+/**
+ * Frees a transposition table.
+ * 
+ * @param table The transposition table to free.
+ */
+void free_transposition_table(transposition_table_t *table);
+
+/**
+ * Resizes a transposition table, discarding all of its entries.
+ * 
+ * @param table The transposition table to resize.
+ * @param size_mb The new size of the table in megabytes.
+ */
+void resize_transposition_table(transposition_table_t *table, size_t size_mb);
+
+/**
+ * Removes all entries from a transposition table.
+ * 
+ * Large tables are cleared by one thread per processor. No search may use the table meanwhile.
+ * 
+ * @param table The transposition table to clear.
+ */
+void clear_transposition_table(transposition_table_t *table);
+
+/**
+ * Describes the pages backing a transposition table, such as "transparent huge pages" (see LargePages.h).
+ * 
+ * @param table The transposition table.
+ * @return The description of the pages.
+ */
+const char *get_transposition_table_pages(const transposition_table_t *table);
+
+/**
+ * Marks the start of a new search, entries from older searches become preferred for replacement.
+ * 
+ * @param table The transposition table.
+ */
+void age_transposition_table(transposition_table_t *table);
+
+/**
+ * Looks up a position in the transposition table.
+ * 
+ * @param table The transposition table.
+ * @param key The hash key of the position.
+ * @param data Receives the stored data when the position is found.
+ * @return true if the position is found, false otherwise.
+ */
+bool probe_transposition_table(const transposition_table_t *table, uint64_t key, tt_data_t *data);
+
+/**
+ * Starts loading the entry of a position into the cache, ahead of probing it.
+ * 
+ * @param table The transposition table.
+ * @param key The hash key of the position.
+ */
+void prefetch_transposition_table(const transposition_table_t *table, uint64_t key);
+
+/**
+ * Stores the result of a search in the transposition table.
+ * 
+ * @param table The transposition table.
+ * @param key The hash key of the position.
+ * @param data The data to store.
+ */
+void store_transposition_table(transposition_table_t *table, uint64_t key, tt_data_t data);
+
+/**
+ * Estimates how full the transposition table is with entries from the current search.
+ * 
+ * @param table The transposition table.
+ * @return The occupancy in permille (0 to 1000), as reported by the UCI "hashfull" field.
+ */
+int transposition_table_hashfull(const transposition_table_t *table);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TRANSPOSITION_TABLE_H
@@ -0,0 +1,72 @@
+/* iMate -- Copyright (C) 2024 Martin Newbound */
+
+#include "GameHistory.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Large enough for almost every game, the arrays grow if a game is longer
+#define INITIAL_HISTORY_CAPACITY 512
+
+// The longest legal FEN string is under 100 characters
+#define ROOT_FEN_LENGTH 128
+
+struct game_history {
+    char root_fen[ROOT_FEN_LENGTH];
+
+    uint16_t *moves;
+    uint64_t *keys;     // one more key than there are moves
+    int length;
+    int capacity;
+};
+
+game_history_t *new_game_history(void) {
+    game_history_t *history = malloc(sizeof(game_history_t));
+    history->capacity = INITIAL_HISTORY_CAPACITY;
+    history->moves = malloc(sizeof(uint16_t) * history->capacity);
+    history->keys = malloc(sizeof(uint64_t) * (history->capacity + 1));
+    history->length = 0;
+    history->keys[0] = 0;
+    strcpy(history->root_fen, START_FEN);
+    return history;
+}
+
+void free_game_history(game_history_t *history) {
+    free(history->moves);
+    free(history->keys);
+    free(history);
+}
+
+void reset_game_history(game_history_t *history, const char *root_fen, const state_t *root) {
+    strncpy(history->root_fen, root_fen, ROOT_FEN_LENGTH - 1);
+    history->root_fen[ROOT_FEN_LENGTH - 1] = '\0';
+
+    history->length = 0;
+    history->keys[0] = get_state_hash_key(root);
+}
+
+void push_game_history(game_history_t *history, uint16_t move_key, const state_t *state) {
+    if (history->length == history->capacity) {
+        history->capacity *= 2;
+        history->moves = realloc(history->moves, sizeof(uint16_t) * history->capacity);
+        history->keys = realloc(history->keys, sizeof(uint64_t) * (history->capacity + 1));
+    }
+
+    history->moves[history->length] = move_key;
+    history->keys[++history->length] = get_state_hash_key(state);
+}
+
+bool is_game_history_root(const game_history_t *history, const char *root_fen) {
+    return strcmp(history->root_fen, root_fen) == 0;
+}
+
+int get_game_history_length(const game_history_t *history) {
+    return history->length;
+}
+
+uint16_t get_game_history_move(const game_history_t *history, int index) {
+    return history->moves[index];
+}
+
+const uint64_t *get_game_history_keys(const game_history_t *history) {
+    return history->keys;
+}
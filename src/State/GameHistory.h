@@ -0,0 +1,109 @@
+/**
+ * @file GameHistory.h
+ * @brief This file contains the declarations of the functions used to record the moves of the game being played.
+ * 
+ * @details The history stores the position the game started from, every move played since and the hash key of
+ * every position reached. It lets the "position" command recognise a move list which extends the one it has
+ * already played, so only the new moves are applied, and it provides the hash keys of earlier positions.
+ * 
+ * @version 1.0.0
+ * @author Martin Newbound
+ * @date 2024
+ * 
+ * @note License:
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef GAME_HISTORY_H
+#define GAME_HISTORY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "GameState.h"
+
+// Represents the moves played in a game from a given starting position
+typedef struct game_history game_history_t;
+
+/**
+ * @brief Creates a new, empty game history starting from the standard starting position.
+ *
+ * @return A pointer to the new game history.
+ *
+ * @warning The caller is responsible for freeing the history with free_game_history.
+ */
+game_history_t *new_game_history(void);
+
+/**
+ * @brief Frees a game history.
+ *
+ * @param history The history to free.
+ */
+void free_game_history(game_history_t *history);
+
+/**
+ * @brief Discards all moves and records a new starting position.
+ *
+ * @param history The history to reset.
+ * @param root_fen The FEN string the game starts from.
+ * @param root The state loaded from root_fen.
+ */
+void reset_game_history(game_history_t *history, const char *root_fen, const state_t *root);
+
+/**
+ * @brief Records a move which has just been played.
+ *
+ * @param history The history to append to.
+ * @param move_key The key of the move played (see get_move_key).
+ * @param state The state after the move was played.
+ */
+void push_game_history(game_history_t *history, uint16_t move_key, const state_t *state);
+
+/**
+ * @brief Checks whether the game started from the given FEN string.
+ *
+ * @param history The game history.
+ * @param root_fen The FEN string to compare with.
+ * @return true if the history was last reset with the same FEN string.
+ */
+bool is_game_history_root(const game_history_t *history, const char *root_fen);
+
+/**
+ * @brief Returns the number of moves played since the starting position.
+ *
+ * @param history The game history.
+ * @return The number of moves recorded.
+ */
+int get_game_history_length(const game_history_t *history);
+
+/**
+ * @brief Returns a move of the game.
+ *
+ * @param history The game history.
+ * @param index The index of the move, 0 being the first move played from the starting position.
+ * @return The key of the move.
+ */
+uint16_t get_game_history_move(const game_history_t *history, int index);
+
+/**
+ * @brief Returns the hash keys of the positions of the game.
+ *
+ * @details The array holds get_game_history_length() + 1 keys, the first one being the key of the starting position
+ * and the last one the key of the current position.
+ *
+ * @param history The game history.
+ * @return The hash keys, valid until the next move is recorded.
+ */
+const uint64_t *get_game_history_keys(const game_history_t *history);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GAME_HISTORY_H
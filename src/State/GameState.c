@@ -2,9 +2,27 @@
 
 #include <string.h>
 #include <stdlib.h>
+#include <ctype.h>
+#include <stdio.h>
 
+#include "Zobrist.h"
 #include "../Moves/MoveCollection.h"
 #include "../Moves/MoveGeneration.h"
+#include "../Moves/SliderAttacks.h"
+#include "../Utils/BitOperations.h"
+#include "../Utils/Profiler.h"
+
+#define SQUARE_INDEX(SQUARE) lsb_index(SQUARE)
+#define FILE_OF(INDEX) ((INDEX) % 8)
+#define RANK_OF(INDEX) ((INDEX) / 8)
+
+// Corner squares of the rooks which hold the castling rights (indexed by castle_t)
+static const uint64_t CASTLING_ROOK_SQUARES[4] = {
+    0x0000000000000080ULL,  // h1
+    0x0000000000000001ULL,  // a1
+    0x8000000000000000ULL,  // h8
+    0x0100000000000000ULL   // a8
+};
 
 /**
  * @struct state
@@ -23,29 +41,44 @@ struct state {
     uint64_t bitboards[2][6];
 
     /**
-     * @brief An array representing the castling rights for each color and side.
-     *
-     * The indices are mapped one to one with castle_t.
+     * @brief The squares occupied by each color (indexed by color_t), maintained incrementally by toggle_piece.
      */
-    bool castling_rights[4];
+    uint64_t occupancy[2];
 
     /**
-     * @brief The en passant target square, represented as a bitboard.
-     *
-     * If there is no en passant target square, this value is 0.
+     * @brief The squares occupied by either color.
+     */
+    uint64_t occupied;
+
+    /**
+     * @brief The Zobrist hash key of the state, maintained incrementally by play_move.
      */
-    uint64_t en_passant_target_square;
+    uint64_t hash_key;
 
-    color_t to_move_color;
-    game_status_t status; 
+    uint16_t half_move_count;
+    uint16_t full_move_count;
+    uint8_t to_move_color;
 
-    bool kingside_castle_is_possible;
-    bool queenside_castle_is_possible;
+    /**
+     * @brief The castling rights, one bit per castle_t (see CASTLING_RIGHT).
+     */
+    uint8_t castling_rights;
 
-    int half_move_count;
-    int full_move_count;
+    /**
+     * @brief The index of the en passant target square.
+     *
+     * If there is no en passant target square, this value is 0 (a1 can never be a target).
+     */
+    uint8_t en_passant_square;
+
+    int8_t status;
 };
 
+#define CASTLING_RIGHT(CASTLE) (1U << (CASTLE))
+
+// Counters are stored in 16 bits, this bounds the values a FEN string or position fields may hold
+#define MAX_MOVE_COUNTER 65535
+
 
 /*
 +=============================================================================+
@@ -55,27 +88,421 @@ struct state {
 
 state_t *new_state() {
     state_t *state = (state_t *)malloc(sizeof(state_t));
-    
-    memset(state->bitboards, 0, sizeof(state->bitboards));    
-    memset(state->castling_rights, 0, sizeof(state->castling_rights));
 
-    state -> en_passant_target_square = 0;
-    state -> kingside_castle_is_possible = false;
-    state -> queenside_castle_is_possible = false;
+    memset(state->bitboards, 0, sizeof(state->bitboards));
+    memset(state->occupancy, 0, sizeof(state->occupancy));
 
+    state->occupied = 0;
+    state->castling_rights = 0;
+    state->en_passant_square = 0;
     state->to_move_color = WHITE;
     state->status = UNDEFINED;
+    state->half_move_count = 0;
+    state->full_move_count = 1;
+    state->hash_key = 0;
     return state;
 }
 
 
+state_t *new_arena_state(arena_t *arena) {
+    return arena_alloc(arena, sizeof(state_t));
+}
+
 void free_state(state_t *state) {
     free(state);
 }
 
 
 void copy_state(const state_t *fromState, state_t *toState) {
-    memcpy(toState->bitboards, fromState->bitboards, sizeof(toState->bitboards));
+    memcpy(toState, fromState, sizeof(state_t));
+}
+
+
+/*
++=============================================================================+
+|             Hashing                                                         |
++=============================================================================+
+*/
+
+uint64_t compute_state_hash_key(const state_t *state) {
+    uint64_t key = 0;
+
+    for (int color = WHITE; color <= BLACK; color++) {
+        for (int piece = PIECE_PAWN; piece <= PIECE_KING; piece++) {
+            uint64_t bitboard = state->bitboards[color][piece];
+            while (bitboard) {
+                key ^= ZOBRIST_PIECE_KEYS[color][piece][SQUARE_INDEX(bitboard)];
+                bitboard &= bitboard - 1;
+            }
+        }
+    }
+
+    for (int castle = CASTLE_KINGSIDE_WHITE; castle <= CASTLE_QUEENSIDE_BLACK; castle++) {
+        if (state->castling_rights & CASTLING_RIGHT(castle)) key ^= ZOBRIST_CASTLING_KEYS[castle];
+    }
+
+    if (state->en_passant_square) key ^= ZOBRIST_EN_PASSANT_KEYS[FILE_OF(state->en_passant_square)];
+    if (state->to_move_color == BLACK) key ^= ZOBRIST_SIDE_KEY;
+
+    return key;
+}
+
+
+uint64_t get_state_hash_key(const state_t *state) {
+    return state->hash_key;
+}
+
+
+/*
++=============================================================================+
+|             Loading a FEN String                                            |
++=============================================================================+
+*/
+
+/**
+ * @brief Maps a FEN piece character to a piece type.
+ *
+ * @param symbol The FEN character (case insensitive).
+ * @return The piece type, or NULL_PIECE for an unknown character.
+ */
+static piece_t piece_from_fen_symbol(char symbol) {
+    switch (tolower((unsigned char)symbol)) {
+        case 'p': return PIECE_PAWN;
+        case 'r': return PIECE_ROOK;
+        case 'n': return PIECE_KNIGHT;
+        case 'b': return PIECE_BISHOP;
+        case 'q': return PIECE_QUEEN;
+        case 'k': return PIECE_KING;
+        default:  return NULL_PIECE;
+    }
+}
+
+
+// King and rook home squares which a castling right requires (indexed by castle_t)
+static const uint64_t CASTLING_KING_SQUARES[4] = {
+    0x0000000000000010ULL,  // e1
+    0x0000000000000010ULL,  // e1
+    0x1000000000000000ULL,  // e8
+    0x1000000000000000ULL   // e8
+};
+
+#define RANK_1_AND_8_MASK 0xFF000000000000FFULL
+
+/**
+ * @brief Parses the piece placement field of a FEN string.
+ *
+ * @param state The state to place the pieces on, its bitboards must be empty.
+ * @param fen The start of the field.
+ * @return A pointer past the field, or NULL if the field is malformed.
+ */
+static const char *parse_piece_placement(state_t *state, const char *fen) {
+    int file = 0, rank = 7;
+
+    for (; *fen && *fen != ' '; fen++) {
+        if (*fen == '/') {
+            if (file != 8 || rank == 0) return NULL;
+            file = 0;
+            rank--;
+        } else if (*fen >= '1' && *fen <= '8') {
+            file += *fen - '0';
+            if (file > 8) return NULL;
+        } else {
+            piece_t piece = piece_from_fen_symbol(*fen);
+            if (piece == NULL_PIECE || file == 8) return NULL;
+
+            color_t color = isupper((unsigned char)*fen) ? WHITE : BLACK;
+            state->bitboards[color][piece] |= 1ULL << (rank * 8 + file);
+            file++;
+        }
+    }
+
+    return (file == 8 && rank == 0) ? fen : NULL;
+}
+
+/**
+ * @brief Parses the castling field of a FEN string.
+ *
+ * Rights whose king or rook is not on its home square are dropped rather than rejected,
+ * as many published test suites carry such stale rights.
+ *
+ * @param state The state to set the castling rights of.
+ * @param fen The start of the field.
+ * @return A pointer past the field, or NULL if the field is malformed.
+ */
+static const char *parse_castling_rights(state_t *state, const char *fen) {
+    if (*fen == '-') return fen + 1;
+
+    for (; *fen && *fen != ' '; fen++) {
+        castle_t castle;
+        switch (*fen) {
+            case 'K': castle = CASTLE_KINGSIDE_WHITE; break;
+            case 'Q': castle = CASTLE_QUEENSIDE_WHITE; break;
+            case 'k': castle = CASTLE_KINGSIDE_BLACK; break;
+            case 'q': castle = CASTLE_QUEENSIDE_BLACK; break;
+            default:  return NULL;
+        }
+
+        const color_t color = castle < CASTLE_KINGSIDE_BLACK ? WHITE : BLACK;
+        if ((state->bitboards[color][PIECE_KING] & CASTLING_KING_SQUARES[castle])
+            && (state->bitboards[color][PIECE_ROOK] & CASTLING_ROOK_SQUARES[castle])) {
+            state->castling_rights |= CASTLING_RIGHT(castle);
+        }
+    }
+
+    return fen;
+}
+
+/**
+ * @brief Parses the en passant field of a FEN string.
+ *
+ * @param state The state to set the en passant target of, the pieces and side to move must already be set.
+ * @param fen The start of the field.
+ * @return A pointer past the field, or NULL if the field is malformed or names a square no pawn can have skipped.
+ */
+static const char *parse_en_passant_target(state_t *state, const char *fen) {
+    if (*fen == '-') return fen + 1;
+    if (fen[0] < 'a' || fen[0] > 'h') return NULL;
+
+    // The target lies behind a pawn of the side which is not to move
+    const bool white_to_move = state->to_move_color == WHITE;
+    if (fen[1] != (white_to_move ? '6' : '3')) return NULL;
+
+    const int target = (fen[1] - '1') * 8 + (fen[0] - 'a');
+    const uint64_t pushed_pawn = 1ULL << (white_to_move ? target - 8 : target + 8);
+    if (!(state->bitboards[white_to_move ? BLACK : WHITE][PIECE_PAWN] & pushed_pawn)) return NULL;
+
+    state->en_passant_square = (uint8_t)target;
+    return fen + 2;
+}
+
+/**
+ * @brief Parses a non negative decimal number without the overhead of strtol.
+ *
+ * @param fen The start of the number.
+ * @param[out] value Receives the number.
+ * @return A pointer past the number, or NULL if there are no digits or the number is too large.
+ */
+static const char *parse_counter(const char *fen, int *value) {
+    if (!isdigit((unsigned char)*fen)) return NULL;
+
+    int number = 0;
+    for (; isdigit((unsigned char)*fen); fen++) {
+        number = number * 10 + (*fen - '0');
+        if (number > MAX_MOVE_COUNTER) return NULL;
+    }
+
+    *value = number;
+    return fen;
+}
+
+/**
+ * @brief Checks the piece placement describes a position which can occur in a game.
+ *
+ * @param state The parsed state.
+ * @return true if both sides have one king, no pawn stands on the first or last rank
+ * and the side which has just moved is not in check.
+ */
+static bool is_valid_position(const state_t *state) {
+    for (color_t color = WHITE; color <= BLACK; color++) {
+        if (popcount(state->bitboards[color][PIECE_KING]) != 1) return false;
+        if (state->bitboards[color][PIECE_PAWN] & RANK_1_AND_8_MASK) return false;
+    }
+
+    return !is_check(state, state->to_move_color == WHITE ? BLACK : WHITE);
+}
+
+/**
+ * @brief Computes the occupancy bitboards of a state from its piece bitboards.
+ *
+ * @param state The state, whose pieces were placed without toggle_piece.
+ */
+static void compute_state_occupancy(state_t *state) {
+    for (color_t color = WHITE; color <= BLACK; color++) {
+        state->occupancy[color] = 0;
+        for (piece_t piece = PIECE_PAWN; piece <= PIECE_KING; piece++) state->occupancy[color] |= state->bitboards[color][piece];
+    }
+    state->occupied = state->occupancy[WHITE] | state->occupancy[BLACK];
+}
+
+#define IS_FEN_SPACE(C) ((C) == ' ' || (C) == '\t' || (C) == '\n' || (C) == '\r')
+#define SKIP_SPACES(TEXT) while (IS_FEN_SPACE(*(TEXT))) (TEXT)++
+
+const char *load_fen_position(state_t *state, const char *fen) {
+    state_t parsed;
+    memset(&parsed, 0, sizeof(parsed));
+    parsed.full_move_count = 1;
+
+    SKIP_SPACES(fen);
+    if ((fen = parse_piece_placement(&parsed, fen)) == NULL || !IS_FEN_SPACE(*fen)) return NULL;
+    compute_state_occupancy(&parsed);
+
+    SKIP_SPACES(fen);
+    if (*fen != 'w' && *fen != 'b') return NULL;
+    parsed.to_move_color = (*fen++ == 'b') ? BLACK : WHITE;
+    if (!IS_FEN_SPACE(*fen)) return NULL;
+
+    SKIP_SPACES(fen);
+    if ((fen = parse_castling_rights(&parsed, fen)) == NULL || !IS_FEN_SPACE(*fen)) return NULL;
+
+    SKIP_SPACES(fen);
+    if ((fen = parse_en_passant_target(&parsed, fen)) == NULL) return NULL;
+    if (*fen && !IS_FEN_SPACE(*fen)) return NULL;
+
+    if (!is_valid_position(&parsed)) return NULL;
+
+    parsed.status = IN_GAME;
+    parsed.hash_key = compute_state_hash_key(&parsed);
+    copy_state(&parsed, state);
+    return fen;
+}
+
+const char *load_fen_move_counters(state_t *state, const char *text) {
+    const char *fen = text;
+    int half_move_count, full_move_count;
+
+    SKIP_SPACES(fen);
+    if ((fen = parse_counter(fen, &half_move_count)) == NULL || !IS_FEN_SPACE(*fen)) return text;
+    SKIP_SPACES(fen);
+    if ((fen = parse_counter(fen, &full_move_count)) == NULL || full_move_count == 0) return text;
+    if (*fen && !IS_FEN_SPACE(*fen)) return text;
+
+    state->half_move_count = (uint16_t)half_move_count;
+    state->full_move_count = (uint16_t)full_move_count;
+    return fen;
+}
+
+bool load_fen_string(state_t *state, const char *fen) {
+    state_t parsed;
+    if ((fen = load_fen_position(&parsed, fen)) == NULL) return false;
+
+    // The move counters are optional, positions from EPD files commonly leave them out
+    fen = load_fen_move_counters(&parsed, fen);
+    SKIP_SPACES(fen);
+    if (*fen) return false;
+
+    copy_state(&parsed, state);
+    return true;
+}
+
+void state_to_fen(const state_t *state, char *buffer) {
+    static const char PIECE_SYMBOLS[2][6] = {{'P', 'R', 'N', 'B', 'Q', 'K'}, {'p', 'r', 'n', 'b', 'q', 'k'}};
+    static const char CASTLING_SYMBOLS[4] = {'K', 'Q', 'k', 'q'};
+    char *out = buffer;
+
+    for (int rank = 7; rank >= 0; rank--) {
+        int empty_squares = 0;
+
+        for (int file = 0; file < 8; file++) {
+            const uint64_t square = 1ULL << (rank * 8 + file);
+            char symbol = '\0';
+
+            for (color_t color = WHITE; color <= BLACK && !symbol; color++) {
+                for (piece_t piece = PIECE_PAWN; piece <= PIECE_KING; piece++) {
+                    if (state->bitboards[color][piece] & square) symbol = PIECE_SYMBOLS[color][piece];
+                }
+            }
+
+            if (!symbol) {
+                empty_squares++;
+                continue;
+            }
+
+            if (empty_squares) *out++ = (char)('0' + empty_squares);
+            empty_squares = 0;
+            *out++ = symbol;
+        }
+
+        if (empty_squares) *out++ = (char)('0' + empty_squares);
+        if (rank) *out++ = '/';
+    }
+
+    *out++ = ' ';
+    *out++ = state->to_move_color == WHITE ? 'w' : 'b';
+    *out++ = ' ';
+
+    const char *castling_start = out;
+    for (castle_t castle = CASTLE_KINGSIDE_WHITE; castle <= CASTLE_QUEENSIDE_BLACK; castle++) {
+        if (state->castling_rights & CASTLING_RIGHT(castle)) *out++ = CASTLING_SYMBOLS[castle];
+    }
+    if (out == castling_start) *out++ = '-';
+    *out++ = ' ';
+
+    if (state->en_passant_square) {
+        const int target = state->en_passant_square;
+        *out++ = (char)('a' + target % 8);
+        *out++ = (char)('1' + target / 8);
+    } else {
+        *out++ = '-';
+    }
+
+    sprintf(out, " %d %d", state->half_move_count, state->full_move_count);
+}
+
+
+/*
++=============================================================================+
+|             Position Fields                                                 |
++=============================================================================+
+*/
+
+void get_state_position_fields(const state_t *state, position_fields_t *fields) {
+    memcpy(fields->bitboards, state->bitboards, sizeof(fields->bitboards));
+    for (castle_t castle = CASTLE_KINGSIDE_WHITE; castle <= CASTLE_QUEENSIDE_BLACK; castle++) {
+        fields->castling_rights[castle] = (state->castling_rights & CASTLING_RIGHT(castle)) != 0;
+    }
+    fields->to_move_color = state->to_move_color;
+    fields->en_passant_target = get_en_passant_target(state);
+    fields->half_move_count = state->half_move_count;
+    fields->full_move_count = state->full_move_count;
+}
+
+bool load_position_fields(state_t *state, const position_fields_t *fields) {
+    state_t parsed;
+    memset(&parsed, 0, sizeof(parsed));
+
+    uint64_t occupancy = 0;
+    for (color_t color = WHITE; color <= BLACK; color++) {
+        for (piece_t piece = PIECE_PAWN; piece <= PIECE_KING; piece++) {
+            if (occupancy & fields->bitboards[color][piece]) return false;
+            occupancy |= fields->bitboards[color][piece];
+        }
+    }
+
+    if (fields->to_move_color != WHITE && fields->to_move_color != BLACK) return false;
+    if (fields->half_move_count < 0 || fields->half_move_count > MAX_MOVE_COUNTER) return false;
+    if (fields->full_move_count < 1 || fields->full_move_count > MAX_MOVE_COUNTER) return false;
+
+    memcpy(parsed.bitboards, fields->bitboards, sizeof(parsed.bitboards));
+    compute_state_occupancy(&parsed);
+    parsed.to_move_color = (uint8_t)fields->to_move_color;
+    parsed.half_move_count = (uint16_t)fields->half_move_count;
+    parsed.full_move_count = (uint16_t)fields->full_move_count;
+
+    for (castle_t castle = CASTLE_KINGSIDE_WHITE; castle <= CASTLE_QUEENSIDE_BLACK; castle++) {
+        const color_t color = castle < CASTLE_KINGSIDE_BLACK ? WHITE : BLACK;
+        if (fields->castling_rights[castle]
+            && (parsed.bitboards[color][PIECE_KING] & CASTLING_KING_SQUARES[castle])
+            && (parsed.bitboards[color][PIECE_ROOK] & CASTLING_ROOK_SQUARES[castle])) {
+            parsed.castling_rights |= CASTLING_RIGHT(castle);
+        }
+    }
+
+    // The target lies behind a pawn of the side which is not to move, as checked by parse_en_passant_target
+    const uint64_t target = fields->en_passant_target;
+    if (target) {
+        const bool white_to_move = parsed.to_move_color == WHITE;
+        const uint64_t pushed_pawn = white_to_move ? target >> 8 : target << 8;
+        if ((target & (target - 1)) || !(target & (white_to_move ? 0x0000FF0000000000ULL : 0x0000000000FF0000ULL))
+            || !(parsed.bitboards[white_to_move ? BLACK : WHITE][PIECE_PAWN] & pushed_pawn)) return false;
+        parsed.en_passant_square = (uint8_t)SQUARE_INDEX(target);
+    }
+
+    if (!is_valid_position(&parsed)) return false;
+
+    parsed.status = IN_GAME;
+    parsed.hash_key = compute_state_hash_key(&parsed);
+    copy_state(&parsed, state);
+    return true;
 }
 
 
@@ -85,37 +512,62 @@ void copy_state(const state_t *fromState, state_t *toState) {
 +=============================================================================+
 */
 
+/**
+ * @brief Adds or removes a piece on a square, keeping the occupancy and the hash key in sync.
+ *
+ * @param state The state to modify.
+ * @param color The color of the piece.
+ * @param piece The type of the piece.
+ * @param square Single-bit bitboard of the square.
+ */
+static void toggle_piece(state_t *state, color_t color, piece_t piece, uint64_t square) {
+    state->bitboards[color][piece] ^= square;
+    state->occupancy[color] ^= square;
+    state->occupied ^= square;
+    state->hash_key ^= ZOBRIST_PIECE_KEYS[color][piece][SQUARE_INDEX(square)];
+}
+
+
+/**
+ * @brief Removes a castling right, keeping the hash key in sync.
+ *
+ * @param state The state to modify.
+ * @param castle The castling right to remove.
+ */
+static void revoke_castling_right(state_t *state, castle_t castle) {
+    if (!(state->castling_rights & CASTLING_RIGHT(castle))) return;
+    state->castling_rights &= (uint8_t)~CASTLING_RIGHT(castle);
+    state->hash_key ^= ZOBRIST_CASTLING_KEYS[castle];
+}
+
+
 void handle_castling_flags(state_t *state, const castle_t castle) {
     if (castle == CASTLE_KINGSIDE_BLACK) {
-        state->bitboards[BLACK][PIECE_KING]  =  0x1000000000000000;
-        state->bitboards[BLACK][PIECE_ROOK] |=  0x8000000000000000;
-        state->bitboards[BLACK][PIECE_ROOK] &= ~0x1000000000000000;  
-    } 
-    
+        toggle_piece(state, BLACK, PIECE_ROOK, 0x8000000000000000);     // h8
+        toggle_piece(state, BLACK, PIECE_ROOK, 0x2000000000000000);     // f8
+    }
+
     else if (castle == CASTLE_QUEENSIDE_BLACK) {
-        state->bitboards[BLACK][PIECE_KING]  =  0x1000000000000000;
-        state->bitboards[BLACK][PIECE_ROOK] |=  0x1000000000000000;
-        state->bitboards[BLACK][PIECE_ROOK] &= ~0x8000000000000000;
-    } 
-    
+        toggle_piece(state, BLACK, PIECE_ROOK, 0x0100000000000000);     // a8
+        toggle_piece(state, BLACK, PIECE_ROOK, 0x0800000000000000);     // d8
+    }
+
     else if (castle == CASTLE_KINGSIDE_WHITE) {
-        state->bitboards[WHITE][PIECE_KING]  =  0x0000000000000010;
-        state->bitboards[WHITE][PIECE_ROOK] |=  0x0000000000000001;
-        state->bitboards[WHITE][PIECE_ROOK] &= ~0x0000000000000010;
-    } 
-    
+        toggle_piece(state, WHITE, PIECE_ROOK, 0x0000000000000080);     // h1
+        toggle_piece(state, WHITE, PIECE_ROOK, 0x0000000000000020);     // f1
+    }
+
     else if (castle == CASTLE_QUEENSIDE_WHITE) {
-        state->bitboards[WHITE][PIECE_KING]  =  0x0000000000000010;
-        state->bitboards[WHITE][PIECE_ROOK] |=  0x0000000000000010;
-        state->bitboards[WHITE][PIECE_ROOK] &= ~0x0000000000000001;
+        toggle_piece(state, WHITE, PIECE_ROOK, 0x0000000000000001);     // a1
+        toggle_piece(state, WHITE, PIECE_ROOK, 0x0000000000000008);     // d1
     }
 }
 
 
 void handle_promotion_flag(state_t *state, const piece_t promotion_piece, uint64_t to_square) {
     if (promotion_piece == NULL_PIECE) return;
-    state->bitboards[state->to_move_color][promotion_piece] |= to_square;
-    state->bitboards[state->to_move_color][PIECE_PAWN] &= ~to_square;
+    toggle_piece(state, state->to_move_color, PIECE_PAWN, to_square);
+    toggle_piece(state, state->to_move_color, promotion_piece, to_square);
 }
 
 
@@ -123,12 +575,12 @@ void handle_castling_nullification_flags(state_t *state, const flags_t *flags) {
     int color_offset = (state->to_move_color == WHITE) ? 0 : 2;
 
     if (flags->king_moved) {
-        state->castling_rights[CASTLE_KINGSIDE_WHITE + color_offset] = false;
-        state->castling_rights[CASTLE_QUEENSIDE_WHITE + color_offset] = false;
+        revoke_castling_right(state, CASTLE_KINGSIDE_WHITE + color_offset);
+        revoke_castling_right(state, CASTLE_QUEENSIDE_WHITE + color_offset);
     }
 
-    if (flags->kingside_rook_moved) state->castling_rights[CASTLE_KINGSIDE_WHITE + color_offset] = false;
-    if (flags->queenside_rook_moved) state->castling_rights[CASTLE_QUEENSIDE_WHITE + color_offset] = false;
+    if (flags->kingside_rook_moved) revoke_castling_right(state, CASTLE_KINGSIDE_WHITE + color_offset);
+    if (flags->queenside_rook_moved) revoke_castling_right(state, CASTLE_QUEENSIDE_WHITE + color_offset);
 }
 
 
@@ -136,7 +588,9 @@ void process_move_flags(state_t *state, const move_t *move) {
     const flags_t *flags = get_move_flags(move);
 
     // handle moves which update the en passant target square
-    state->en_passant_target_square = flags->en_passant_square;
+    if (state->en_passant_square) state->hash_key ^= ZOBRIST_EN_PASSANT_KEYS[FILE_OF(state->en_passant_square)];
+    state->en_passant_square = flags->double_pawn_push ? (uint8_t)SQUARE_INDEX(flags->en_passant_square) : 0;
+    if (state->en_passant_square) state->hash_key ^= ZOBRIST_EN_PASSANT_KEYS[FILE_OF(state->en_passant_square)];
 
     handle_promotion_flag(state, flags->promotion_piece, get_move_to_square(move));
     handle_castling_flags(state, flags->castle);
@@ -145,23 +599,52 @@ void process_move_flags(state_t *state, const move_t *move) {
 
 
 void play_move(state_t *state, const move_t *move) {
+    PROFILE_SCOPE(PROFILE_MAKE_MOVE);
     color_t to_move_c = state->to_move_color;
     color_t opponent_c = to_move_c == WHITE ? BLACK : WHITE;
 
-    piece_t to_piece = piece_on_square(state, get_move_to_square(move));
-    piece_t from_piece = piece_on_square(state, get_move_from_square(move));
+    const uint64_t from_square = get_move_from_square(move);
+    const uint64_t to_square = get_move_to_square(move);
+
+    piece_t to_piece = get_piece_on_square(state, to_square);
+    piece_t from_piece = get_piece_on_square(state, from_square);
 
     // remove any captured piece (if one exists)
-    if (from_piece != NULL_PIECE) state->bitboards[opponent_c][to_piece] &= ~get_move_to_square(move);
+    if (to_piece != NULL_PIECE) toggle_piece(state, opponent_c, to_piece, to_square);
+
+    // an en passant capture removes the pawn behind the target square
+    if (from_piece == PIECE_PAWN && state->en_passant_square && to_square == 1ULL << state->en_passant_square) {
+        toggle_piece(state, opponent_c, PIECE_PAWN, to_move_c == WHITE ? to_square >> 8 : to_square << 8);
+    }
+
+    // capturing a rook on its starting corner removes the opponent's right to castle with it
+    for (castle_t castle = CASTLE_KINGSIDE_WHITE; castle <= CASTLE_QUEENSIDE_BLACK; castle++) {
+        if (to_square & CASTLING_ROOK_SQUARES[castle]) revoke_castling_right(state, castle);
+    }
 
     // move the from piece to the to square
-    state->bitboards[to_move_c][from_piece] &= ~get_move_from_square(move);
-    state->bitboards[to_move_c][from_piece] |= get_move_to_square(move);
+    toggle_piece(state, to_move_c, from_piece, from_square);
+    toggle_piece(state, to_move_c, from_piece, to_square);
 
     if (state->to_move_color == BLACK) state->full_move_count++;
 
+    // captures and pawn moves are irreversible and restart the fifty move count
+    state->half_move_count = (from_piece == PIECE_PAWN || to_piece != NULL_PIECE) ? 0 : state->half_move_count + 1;
+
     process_move_flags(state, move);
     state->to_move_color = opponent_c;
+    state->hash_key ^= ZOBRIST_SIDE_KEY;
+}
+
+
+void play_null_move(state_t *state) {
+    PROFILE_SCOPE(PROFILE_MAKE_MOVE);
+    if (state->en_passant_square) state->hash_key ^= ZOBRIST_EN_PASSANT_KEYS[FILE_OF(state->en_passant_square)];
+    state->en_passant_square = 0;
+
+    state->half_move_count = 0;
+    state->to_move_color = state->to_move_color == WHITE ? BLACK : WHITE;
+    state->hash_key ^= ZOBRIST_SIDE_KEY;
 }
 
 
@@ -173,51 +656,117 @@ void play_move(state_t *state, const move_t *move) {
 
 typedef struct {
     const state_t *state;
-    const color_t to_move_color;
-    const color_t opponent_color;
-    const uint64_t king_square;
-} king_status_t;
+    const color_t attacker_color;
+    const int square;
+    const uint64_t occupancy;
+} attack_query_t;
 
 
+/**
+ * @brief Offsets a square index, rejecting offsets which leave the board or wrap around a file edge.
+ *
+ * @param square The square index to offset from.
+ * @param offset The offset (in terms of squares).
+ * @param max_file_distance The largest file distance the offset can legally span.
+ * @param target Receives the offset square index.
+ * @return true if the offset square is on the board.
+ */
+static bool offset_square(int square, int offset, int max_file_distance, int *target) {
+    *target = square + offset;
+    return *target >= 0 && *target < 64 && abs(FILE_OF(*target) - FILE_OF(square)) <= max_file_distance;
+}
 
-bool are_non_sliding_attackers(king_status_t status) {
-    const uint64_t opp_knight_bitboard = status.state->bitboards[status.opponent_color][PIECE_KNIGHT];
 
-    // Knight move offsets (in terms of squares)
+bool are_non_sliding_attackers(attack_query_t query) {
+    const uint64_t *attacker_bitboards = query.state->bitboards[query.attacker_color];
 
-    int pawn_offsets[] = status.to_move_color == WHITE ? (int[]){7, 9} : (int[]){-7, -9};
+    // Attacking pawns sit one rank behind the square (from the attacker's point of view)
+    int pawn_offsets[2][2] = {{-7, -9}, {7, 9}};
     int knight_offsets[] = {-17, -15, -10, -6, 6, 10, 15, 17};
     int king_offsets[] = {-9, -8, -7, -1, 1, 7, 8, 9};
 
-    int num_pawn_offsets = sizeof(pawn_offsets)     / sizeof(pawn_offsets[0]);
     int num_knight_offsets = sizeof(knight_offsets) / sizeof(knight_offsets[0]);
     int num_king_offsets = sizeof(king_offsets)     / sizeof(king_offsets[0]);
 
-    for (int i = 0; i < num_pawn_offsets; i++) {
-        int offset = pawn_offsets[i];
-        uint64_t offset_sq = offset > 0 ? status.king_square << offset : status.king_square >> -offset;
+    int target;
 
-        // Check if the move is within the board and doesn't wrap around
-        if (offset_sq < 64 && abs((offset_sq % 8) - (status.king_square % 8)) <= 2) {
-            if (opp_knight_bitboard & (1ULL << offset_sq)) return true;
-        }
+    for (int i = 0; i < 2; i++) {
+        if (offset_square(query.square, pawn_offsets[query.attacker_color][i], 1, &target) &&
+            (attacker_bitboards[PIECE_PAWN] & (1ULL << target))) return true;
+    }
+
+    for (int i = 0; i < num_knight_offsets; i++) {
+        if (offset_square(query.square, knight_offsets[i], 2, &target) &&
+            (attacker_bitboards[PIECE_KNIGHT] & (1ULL << target))) return true;
+    }
+
+    for (int i = 0; i < num_king_offsets; i++) {
+        if (offset_square(query.square, king_offsets[i], 1, &target) &&
+            (attacker_bitboards[PIECE_KING] & (1ULL << target))) return true;
     }
 
     return false;
 }
 
 
-bool in_check(const state_t *state) {
-    color_t opponent_color = state->to_move_color == WHITE ? BLACK : WHITE;
+bool are_sliding_attackers(attack_query_t query) {
+    const uint64_t *attacker_bitboards = query.state->bitboards[query.attacker_color];
+    const uint64_t straight_attackers = attacker_bitboards[PIECE_ROOK] | attacker_bitboards[PIECE_QUEEN];
+    const uint64_t diagonal_attackers = attacker_bitboards[PIECE_BISHOP] | attacker_bitboards[PIECE_QUEEN];
+
+    // A slider attacks the square if a slider of the same kind on the square would attack it back
+    if (straight_attackers && (get_rook_attacks(query.square, query.occupancy) & straight_attackers)) return true;
+    return diagonal_attackers && (get_bishop_attacks(query.square, query.occupancy) & diagonal_attackers);
+}
 
-    king_status_t status = {
+
+bool is_square_attacked(const state_t *state, uint64_t square, color_t color) {
+    PROFILE_SCOPE(PROFILE_ATTACK_DETECTION);
+    attack_query_t query = {
         .state = state,
-        .to_move_color = state->to_move_color,
-        .opponent_color = opponent_color,
-        .king_square = states_piece_bitboard(state, PIECE_KING, state->to_move_color)
+        .attacker_color = color,
+        .square = SQUARE_INDEX(square),
+        .occupancy = state->occupied
     };
 
-    if (!are_attacking_knight(status)) return false;
+    return are_non_sliding_attackers(query) || are_sliding_attackers(query);
+}
+
+
+bool is_check(const state_t *state, color_t color) {
+    const uint64_t king_square = state->bitboards[color][PIECE_KING];
+    if (!king_square) return false;
+
+    return is_square_attacked(state, king_square, color == WHITE ? BLACK : WHITE);
+}
+
+
+/**
+ * @brief Checks whether the player to move has at least one legal move.
+ *
+ * @param state The state to inspect.
+ * @return true if a legal move exists.
+ */
+static bool has_legal_move(const state_t *state) {
+    move_collection_t *moves = get_legal_moves_of_state(state);
+    move_t *move = pop_collection_head(moves);
+    bool has_move = move != NULL;
+
+    if (move) free_move(move);
+    free_move_collection(moves);
+    return has_move;
+}
+
+
+bool is_checkmate(const state_t *state, color_t color) {
+    if (state->to_move_color != color || !is_check(state, color)) return false;
+    return !has_legal_move(state);
+}
+
+
+bool is_stalemate(const state_t *state, color_t color) {
+    if (state->to_move_color != color || is_check(state, color)) return false;
+    return !has_legal_move(state);
 }
 
 
@@ -229,8 +778,12 @@ bool in_check(const state_t *state) {
 */
 
 
-color_t to_move_color(const state_t *state) {
-    return state->to_move_color;
+color_t get_state_to_move_color(const state_t *state) {
+    return (color_t)state->to_move_color;
+}
+
+int get_state_half_move_count(const state_t *state) {
+    return state->half_move_count;
 }
 
 /*
@@ -240,11 +793,49 @@ color_t to_move_color(const state_t *state) {
 */
 
 uint64_t states_color_bitboard(const state_t *state, color_t color) {
-    uint64_t colorBitboard = 0;
-    for (size_t i = PIECE_PAWN; i <= PIECE_KING; i++) {
-        colorBitboard |= state->bitboards[color][i];
+    return state->occupancy[color];
+}
+
+
+uint64_t get_state_occupancy(const state_t *state) {
+    return state->occupied;
+}
+
+
+uint64_t get_state_peice_bitboard(const state_t *state, piece_t piece, color_t color) {
+    return state->bitboards[color][piece];
+}
+
+
+piece_t get_piece_on_square(const state_t *state, uint64_t square) {
+    if (!(state->occupied & square)) return NULL_PIECE;
+    for (int piece = PIECE_PAWN; piece <= PIECE_KING; piece++) {
+        if ((state->bitboards[WHITE][piece] | state->bitboards[BLACK][piece]) & square) return piece;
     }
-    return colorBitboard;
+    return NULL_PIECE;
+}
+
+
+color_t get_color_of_piece_on_square(const state_t *state, uint64_t square) {
+    if (state->occupancy[WHITE] & square) return WHITE;
+    if (state->occupancy[BLACK] & square) return BLACK;
+    return NULL_COLOR;
+}
+
+
+/*
++=============================================================================+
+|             En Passant                                                      |
++=============================================================================+
+*/
+
+bool is_en_passant_target_active(const state_t *state) {
+    return state->en_passant_square != 0;
+}
+
+
+uint64_t get_en_passant_target(const state_t *state) {
+    return state->en_passant_square ? 1ULL << state->en_passant_square : 0;
 }
 
 
@@ -256,4 +847,5 @@ uint64_t states_color_bitboard(const state_t *state, color_t color) {
 
 bool state_can_castle(const state_t *state, castle_t castle) {
     if (state->status != IN_GAME) return false;
-}
\ No newline at end of file
+    return (state->castling_rights & CASTLING_RIGHT(castle)) != 0;
+}
@@ -39,8 +39,15 @@ extern "C" {
 
 #include <stdint.h>
 #include <stdbool.h>
-#include "../Moves/Move.h"
 
+// The standard starting position of a game of chess
+#define START_FEN "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1"
+
+// Length of the buffer needed to hold a FEN string written by state_to_fen
+#define FEN_STRING_LENGTH 96
+
+// Half moves without a capture or a pawn move after which the game is drawn (the fifty move rule)
+#define FIFTY_MOVE_RULE_PLIES 100
 
 typedef enum {
     NULL_COLOR      = -1,
@@ -66,6 +73,16 @@ typedef enum {
     CASTLE_QUEENSIDE_BLACK  = 3
 } castle_t;
 
+typedef enum {
+    UNDEFINED       = -1,
+    IN_GAME         =  0,
+    WHITE_CHECK     =  1,
+    BLACK_CHECK     =  2,
+    WHITE_CHECKMATE =  3,
+    BLACK_CHECKMATE =  4,
+    STALEMATE       =  5
+} game_status_t;
+
 /**
  * @brief Forward declaration of the state type
  * 
@@ -79,6 +96,12 @@ typedef enum {
  */
 typedef struct state state_t;
 
+// Forward declaration of the move type (see Move.h)
+typedef struct move move_t;
+
+#include "../Moves/Move.h"
+#include "../Utils/Arena.h"
+
 
 /**
  * @brief Allocates and initializes a new game state.
@@ -100,6 +123,19 @@ typedef struct state state_t;
 state_t* new_state();
 
 
+/**
+ * @brief Allocates a game state in an arena.
+ *
+ * @details
+ * The state is not initialized, it is meant to receive a copy of another state (see copy_state).
+ * It is freed along with the arena and must not be passed to free_state.
+ *
+ * @param arena The arena to allocate the state from.
+ * @return Pointer to the new game state.
+ */
+state_t *new_arena_state(arena_t *arena);
+
+
 /**
  * @brief Frees the memory allocated for a game state.
  *
@@ -143,8 +179,38 @@ void copy_state(const state_t *fromState, state_t *toState);
 color_t get_state_to_move_color(const state_t *state);
 
 
+/**
+ * @brief Returns the number of half moves since the last capture or pawn move.
+ *
+ * @details
+ * The count is read from the FEN string and maintained by play_move. It drives the fifty
+ * move rule, and no position older than this many half moves can be repeated.
+ *
+ * @param state Pointer to the game state.
+ * @return The half move clock.
+ */
+int get_state_half_move_count(const state_t *state);
+
+
+/**
+ * @brief Returns the type of the piece occupying a square.
+ *
+ * @param state     Pointer to the game state.
+ * @param square    Single-bit bitboard of the square to inspect.
+ *
+ * @return          The piece on the square, or NULL_PIECE if the square is empty.
+ */
 piece_t get_piece_on_square(const state_t *state, uint64_t square);
 
+
+/**
+ * @brief Returns the color of the piece occupying a square.
+ *
+ * @param state     Pointer to the game state.
+ * @param square    Single-bit bitboard of the square to inspect.
+ *
+ * @return          The color of the piece on the square, or NULL_COLOR if the square is empty.
+ */
 color_t get_color_of_piece_on_square(const state_t *state, uint64_t square);
 
 /**
@@ -183,6 +249,16 @@ bool state_can_castle(const state_t *state, castle_t castle);
 uint64_t states_color_bitboard(const state_t *state, color_t color);
 
 
+/**
+ * @brief Retrieves the bitboard of the squares occupied by either color.
+ *
+ * @param state     Pointer to the game state.
+ * 
+ * @return          The bitboard of all the pieces on the board.
+ */
+uint64_t get_state_occupancy(const state_t *state);
+
+
 /**
  * @brief Retrieves the bitboard representing the positions of a specific type of piece of a specific color.
  *
@@ -195,7 +271,100 @@ uint64_t states_color_bitboard(const state_t *state, color_t color);
  * 
  * @return          The bitboard for the specified piece and color.
  */
-uint64_t get_state_peice_bitboard(const state_t *state, colored_peice_t colored_peice);
+uint64_t get_state_peice_bitboard(const state_t *state, piece_t piece, color_t color);
+
+
+/**
+ * @brief Checks whether an en passant capture is available in the given state.
+ *
+ * @param state     Pointer to the game state.
+ * @return          true if the last move was a double pawn push, false otherwise.
+ */
+bool is_en_passant_target_active(const state_t *state);
+
+
+/**
+ * @brief Retrieves the en passant target square.
+ *
+ * @details
+ * The target square is the square the double-pushed pawn skipped over, i.e. the square
+ * a capturing pawn lands on. This matches the en passant field of a FEN string.
+ *
+ * @param state     Pointer to the game state.
+ * @return          Single-bit bitboard of the target square, or 0 if there is none.
+ */
+uint64_t get_en_passant_target(const state_t *state);
+
+
+/**
+ * @brief Returns the Zobrist hash key of the game state.
+ *
+ * @details
+ * The key is maintained incrementally by play_move and uniquely (up to collisions)
+ * identifies the piece placement, side to move, castling rights and en passant square.
+ *
+ * @param state     Pointer to the game state.
+ * @return          The 64 bit hash key of the state.
+ */
+uint64_t get_state_hash_key(const state_t *state);
+
+
+/**
+ * @brief Computes the Zobrist hash key of the game state from scratch.
+ *
+ * @details
+ * The result always equals get_state_hash_key, which is far cheaper. This function
+ * is meant for loading positions and for checking the incremental updates.
+ *
+ * @param state     Pointer to the game state.
+ * @return          The 64 bit hash key of the state.
+ */
+uint64_t compute_state_hash_key(const state_t *state);
+
+
+/**
+ * @brief Checks whether a square is attacked by any piece of the given color.
+ *
+ * @param state     Pointer to the game state.
+ * @param square    Single-bit bitboard of the square to inspect.
+ * @param color     The color of the attacking side.
+ *
+ * @return          true if at least one piece of `color` attacks the square.
+ */
+bool is_square_attacked(const state_t *state, uint64_t square, color_t color);
+
+/**
+ * Loads the position fields of a FEN string or EPD record into a game state.
+ * 
+ * @param state The game state to load the position into.
+ * @param fen The text to parse, starting with the piece placement field.
+ * 
+ * @return A pointer past the en passant field, or NULL if the position is invalid.
+ * 
+ * @details
+ * Only the first four fields (piece placement, side to move, castling rights and en passant square)
+ * are parsed, so the function reads EPD records as well as FEN strings. The move counters are reset.
+ * The text is validated: malformed fields, a missing king, pawns on the first or last rank and a
+ * side to move which could capture the opposing king are rejected. Castling rights whose king or rook
+ * has left its home square are dropped. The state is left unchanged if the position is invalid.
+ * Nothing is allocated.
+ */
+const char *load_fen_position(state_t *state, const char *fen);
+
+/**
+ * Loads the move counters which may follow the position fields of a FEN string.
+ *
+ * @param state The game state whose counters are set.
+ * @param text The text after the en passant field, as returned by load_fen_position.
+ *
+ * @return A pointer past the counters, or text itself if it does not start with a half and a full
+ * move counter, in which case the state is unchanged.
+ *
+ * @details
+ * Each counter must be followed by a space or the end of the text, so a game result such as "1-0"
+ * which follows the position is not taken for a counter.
+ */
+const char *load_fen_move_counters(state_t *state, const char *text);
 
 /**
  * Loads a FEN (Forsyth-Edwards Notation) string into a game state.
@@ -203,11 +372,56 @@ uint64_t get_state_peice_bitboard(const state_t *state, colored_peice_t colored_
  * @param state The game state to load the FEN string into.
  * @param fen The FEN string to load.
  * 
+ * @return true if the FEN string is valid, false otherwise (in which case the state is unchanged).
+ * 
  * @details
  * The FEN string represents a specific game position. The function updates the game state
- * to reflect the game position described by the FEN string.
+ * to reflect the game position described by the FEN string. The half and full move counters
+ * are optional. See load_fen_position for the checks applied.
  */
-void load_fen_string(state_t *state, const char *fen);
+bool load_fen_string(state_t *state, const char *fen);
+
+/**
+ * Writes the FEN string of a game state, move counters included.
+ *
+ * @param state The game state.
+ * @param buffer A buffer of at least FEN_STRING_LENGTH characters.
+ */
+void state_to_fen(const state_t *state, char *buffer);
+
+/**
+ * @brief The fields of a position, as described by a FEN string.
+ */
+typedef struct {
+    uint64_t bitboards[2][6];       // indexed by color_t, then piece_t
+    color_t to_move_color;
+    bool castling_rights[4];        // indexed by castle_t
+    uint64_t en_passant_target;     // single-bit bitboard, 0 if there is none
+    int half_move_count;
+    int full_move_count;
+} position_fields_t;
+
+/**
+ * Copies the fields of a game state's position.
+ *
+ * @param state The game state.
+ * @param[out] fields Receives the position.
+ */
+void get_state_position_fields(const state_t *state, position_fields_t *fields);
+
+/**
+ * Loads the fields of a position into a game state.
+ *
+ * @param state The game state to load the position into.
+ * @param fields The position.
+ *
+ * @return true if the position is valid, false otherwise (in which case the state is unchanged).
+ *
+ * @details
+ * This is the binary counterpart of load_fen_string and applies the same checks, except that the pieces are
+ * also required not to overlap. Nothing is allocated.
+ */
+bool load_position_fields(state_t *state, const position_fields_t *fields);
 
 /**
  * Applies a move to a game state.
@@ -220,6 +434,18 @@ void load_fen_string(state_t *state, const char *fen);
  */
 void play_move(state_t *state, const move_t *move);
 
+/**
+ * Passes the turn to the opponent without moving a piece.
+ * 
+ * @param state The game state to apply the null move to.
+ * 
+ * @details
+ * Used by the search for null move pruning. The en passant target is cleared
+ * and the hash key is updated accordingly. The half move clock restarts, as
+ * no position before a null move can be repeated by the moves after it.
+ */
+void play_null_move(state_t *state);
+
 /**
  * Checks if a player is in check.
  * 
@@ -231,7 +457,7 @@ void play_move(state_t *state, const move_t *move);
  * @details
  * The function checks if the king of the specified color is under attack in the current game state.
  */
-bool is_check(state_t *state, color_t color);
+bool is_check(const state_t *state, color_t color);
 
 /**
  * Checks if a player is in checkmate.
@@ -244,7 +470,17 @@ bool is_check(state_t *state, color_t color);
  * @details
  * The function checks if the player of the specified color is in check and has no legal moves in the current game state.
  */
-bool is_checkmate(state_t *state, color_t color);
+bool is_checkmate(const state_t *state, color_t color);
+
+/**
+ * Checks if a player is in stalemate.
+ * 
+ * @param state The current game state.
+ * @param color The color of the player to check.
+ * 
+ * @return true if the player is to move, is not in check and has no legal moves.
+ */
+bool is_stalemate(const state_t *state, color_t color);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,157 @@
+/* iMate -- Copyright (C) 2024 Martin Newbound */
+
+#include "PackedPosition.h"
+#include "../Utils/BitOperations.h"
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define BLACK_TO_MOVE_FLAG 1
+#define CASTLING_FLAGS_SHIFT 1
+
+#define NIBBLE_COLOR_SHIFT 3
+#define NIBBLE_PIECE_MASK 7
+
+/**
+ * @brief A read only memory mapping of a file of packed positions.
+ */
+struct packed_position_file {
+    const packed_position_t *positions;
+    size_t count;
+    size_t size;        // the size of the mapping, 0 for an empty file
+};
+
+bool pack_position(const state_t *state, int score, int result, packed_position_t *packed) {
+    position_fields_t fields;
+    get_state_position_fields(state, &fields);
+    memset(packed, 0, sizeof(packed_position_t));
+
+    uint8_t nibbles[64];
+    for (color_t color = WHITE; color <= BLACK; color++) {
+        for (piece_t piece = PIECE_PAWN; piece <= PIECE_KING; piece++) {
+            for (uint64_t bitboard = fields.bitboards[color][piece]; bitboard; bitboard &= bitboard - 1) {
+                nibbles[lsb_index(bitboard)] = (uint8_t)(piece | (color << NIBBLE_COLOR_SHIFT));
+            }
+            packed->occupancy |= fields.bitboards[color][piece];
+        }
+    }
+    if (popcount(packed->occupancy) > 32) return false;
+
+    // The nibbles follow the squares in ascending order
+    int index = 0;
+    for (uint64_t occupancy = packed->occupancy; occupancy; occupancy &= occupancy - 1, index++) {
+        packed->pieces[index / 2] |= (uint8_t)(nibbles[lsb_index(occupancy)] << (index % 2 * 4));
+    }
+
+    packed->flags = fields.to_move_color == BLACK ? BLACK_TO_MOVE_FLAG : 0;
+    for (castle_t castle = CASTLE_KINGSIDE_WHITE; castle <= CASTLE_QUEENSIDE_BLACK; castle++) {
+        if (fields.castling_rights[castle]) packed->flags |= (uint8_t)(1 << (CASTLING_FLAGS_SHIFT + castle));
+    }
+
+    packed->en_passant_square = fields.en_passant_target ? (uint8_t)lsb_index(fields.en_passant_target) : PACKED_NO_EN_PASSANT;
+    packed->half_move_count = (uint8_t)(fields.half_move_count < UINT8_MAX ? fields.half_move_count : UINT8_MAX);
+    packed->full_move_count = (uint16_t)(fields.full_move_count < UINT16_MAX ? fields.full_move_count : UINT16_MAX);
+    packed->score = (int16_t)(score < INT16_MIN ? INT16_MIN : score > INT16_MAX ? INT16_MAX : score);
+    packed->result = (uint8_t)result;
+    return true;
+}
+
+bool unpack_position(const packed_position_t *packed, state_t *state) {
+    position_fields_t fields;
+    memset(&fields, 0, sizeof(fields));
+
+    int index = 0;
+    for (uint64_t occupancy = packed->occupancy; occupancy; occupancy &= occupancy - 1, index++) {
+        if (index == 32) return false;
+
+        const uint8_t nibble = (uint8_t)(packed->pieces[index / 2] >> (index % 2 * 4)) & 0xF;
+        const int piece = nibble & NIBBLE_PIECE_MASK;
+        if (piece > PIECE_KING) return false;
+
+        fields.bitboards[nibble >> NIBBLE_COLOR_SHIFT][piece] |= occupancy & -occupancy;
+    }
+
+    fields.to_move_color = packed->flags & BLACK_TO_MOVE_FLAG ? BLACK : WHITE;
+    for (castle_t castle = CASTLE_KINGSIDE_WHITE; castle <= CASTLE_QUEENSIDE_BLACK; castle++) {
+        fields.castling_rights[castle] = packed->flags & (1 << (CASTLING_FLAGS_SHIFT + castle));
+    }
+
+    if (packed->en_passant_square > PACKED_NO_EN_PASSANT) return false;
+    fields.en_passant_target = packed->en_passant_square == PACKED_NO_EN_PASSANT ? 0 : 1ULL << packed->en_passant_square;
+    fields.half_move_count = packed->half_move_count;
+    fields.full_move_count = packed->full_move_count;
+
+    return load_position_fields(state, &fields);
+}
+
+bool parse_labeled_position(const char *line, state_t *state, int *result) {
+    const char *rest = load_fen_position(state, line);
+    if (rest == NULL) return false;
+    rest = load_fen_move_counters(state, rest);
+
+    const char *bracket = strchr(rest, '[');
+    if (bracket != NULL) {
+        char *end;
+        const double score = strtod(bracket + 1, &end);
+        if (end == bracket + 1 || score < 0.0 || score > 1.0) return false;
+
+        *result = score > 0.75 ? PACKED_WHITE_WINS : score < 0.25 ? PACKED_BLACK_WINS : PACKED_DRAW;
+        return true;
+    }
+
+    if (strstr(rest, "1/2-1/2") != NULL) *result = PACKED_DRAW;
+    else if (strstr(rest, "1-0") != NULL) *result = PACKED_WHITE_WINS;
+    else if (strstr(rest, "0-1") != NULL) *result = PACKED_BLACK_WINS;
+    else return false;
+
+    return true;
+}
+
+bool write_packed_positions(FILE *file, const packed_position_t *positions, size_t count) {
+    return fwrite(positions, sizeof(packed_position_t), count, file) == count;
+}
+
+packed_position_file_t *open_packed_positions(const char *path) {
+    const int descriptor = open(path, O_RDONLY);
+    if (descriptor < 0) return NULL;
+
+    struct stat status;
+    if (fstat(descriptor, &status) != 0 || status.st_size % (off_t)sizeof(packed_position_t) != 0) {
+        close(descriptor);
+        return NULL;
+    }
+
+    packed_position_file_t *file = calloc(1, sizeof(packed_position_file_t));
+    file->size = (size_t)status.st_size;
+    file->count = file->size / sizeof(packed_position_t);
+
+    if (file->size > 0) {
+        void *mapping = mmap(NULL, file->size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+        if (mapping == MAP_FAILED) {
+            close(descriptor);
+            free(file);
+            return NULL;
+        }
+
+        // The records are read front to back, the kernel can read ahead and drop the pages behind
+        posix_madvise(mapping, file->size, POSIX_MADV_SEQUENTIAL);
+        file->positions = mapping;
+    }
+
+    // The mapping outlives the descriptor
+    close(descriptor);
+    return file;
+}
+
+void close_packed_positions(packed_position_file_t *file) {
+    if (file->size > 0) munmap((void *)file->positions, file->size);
+    free(file);
+}
+
+const packed_position_t *get_packed_positions(const packed_position_file_t *file, size_t *count) {
+    *count = file->count;
+    return file->positions;
+}
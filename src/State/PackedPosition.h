@@ -0,0 +1,141 @@
+/* iMate -- Copyright (C) 2024 Martin Newbound */
+
+/**
+ * @file PackedPosition.h
+ * @brief This file contains the declarations of the packed binary format of the training and tuning positions.
+ *
+ * @details A packed position is a fixed 32 byte record: the occupancy bitboard, one nibble per occupied square
+ * (piece type in bits 0-2, bit 3 set for black) in square order, the side to move, the castling rights, the en
+ * passant target, the move counters, and a score and a game result, both from white's point of view. It converts
+ * to and from a state_t without loss.
+ *
+ * A file of packed positions is a plain array of records, so files can be concatenated, and is read through a
+ * memory mapping: iterating over it allocates nothing and the kernel reads ahead. Records are stored in the
+ * byte order of the machine writing them, little endian on the platforms the engine targets.
+ *
+ * @version 1.0.0
+ * @author Martin Newbound
+ * @date 2024
+ *
+ * @note License:
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef PACKED_POSITION_H
+#define PACKED_POSITION_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "GameState.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// Files with this extension hold packed positions rather than text
+#define PACKED_POSITIONS_EXTENSION ".packed"
+
+// Stored in en_passant_square when there is no en passant target
+#define PACKED_NO_EN_PASSANT 64
+
+// Game results, as white's score in half points
+#define PACKED_BLACK_WINS 0
+#define PACKED_DRAW 1
+#define PACKED_WHITE_WINS 2
+
+/**
+ * @brief A position and its labels in 32 bytes.
+ */
+typedef struct {
+    uint64_t occupancy;
+    uint8_t pieces[16];         // the piece of the n-th occupied square is in nibble n, low nibble first
+    uint8_t flags;              // bit 0 set for black to move, bits 1-4 the castling rights indexed by castle_t
+    uint8_t en_passant_square;  // square index, or PACKED_NO_EN_PASSANT
+    uint8_t half_move_count;
+    uint8_t result;             // PACKED_BLACK_WINS, PACKED_DRAW or PACKED_WHITE_WINS
+    int16_t score;              // centipawns, from white's point of view
+    uint16_t full_move_count;
+} packed_position_t;
+
+_Static_assert(sizeof(packed_position_t) == 32, "packed positions are 32 bytes");
+
+// A read only memory mapping of a file of packed positions
+typedef struct packed_position_file packed_position_file_t;
+
+/**
+ * Packs a position and its labels.
+ *
+ * @param state The position, with at most 32 pieces.
+ * @param score The score of the position in centipawns from white's point of view, clamped to 16 bits.
+ * @param result The result of the game, PACKED_BLACK_WINS, PACKED_DRAW or PACKED_WHITE_WINS.
+ * @param[out] packed Receives the record.
+ * @return false if the position has more than 32 pieces.
+ */
+bool pack_position(const state_t *state, int score, int result, packed_position_t *packed);
+
+/**
+ * Unpacks the position of a record.
+ *
+ * @param packed The record.
+ * @param state The game state to load the position into.
+ * @return false if the record does not hold a valid position, in which case the state is unchanged.
+ */
+bool unpack_position(const packed_position_t *packed, state_t *state);
+
+/**
+ * Reads a labeled position from a line of text: a FEN string or EPD record followed by the result of its game,
+ * either in brackets ("[1.0]", "[0.5]", "[0.0]") or as a game result ("1-0", "1/2-1/2", "0-1", as in an EPD
+ * c9 opcode). The move counters are read when they follow the position.
+ *
+ * @param line The line.
+ * @param state The game state to load the position into.
+ * @param[out] result Receives the result, PACKED_BLACK_WINS, PACKED_DRAW or PACKED_WHITE_WINS.
+ * @return false if the line holds no valid position or no result.
+ */
+bool parse_labeled_position(const char *line, state_t *state, int *result);
+
+/**
+ * Appends records to a file of packed positions.
+ *
+ * @param file The file, opened in binary mode.
+ * @param positions The records.
+ * @param count The number of records.
+ * @return true if every record was written.
+ */
+bool write_packed_positions(FILE *file, const packed_position_t *positions, size_t count);
+
+/**
+ * Maps a file of packed positions into memory.
+ *
+ * @param path The file.
+ * @return The mapping, or NULL if the file cannot be mapped or its size is not a whole number of records.
+ *
+ * @warning The caller is responsible for closing the mapping with close_packed_positions.
+ */
+packed_position_file_t *open_packed_positions(const char *path);
+
+/**
+ * Unmaps a file of packed positions.
+ *
+ * @param file The mapping.
+ */
+void close_packed_positions(packed_position_file_t *file);
+
+/**
+ * Returns the records of a file of packed positions, valid until the file is closed.
+ *
+ * @param file The mapping.
+ * @param[out] count Receives the number of records.
+ * @return The first record.
+ */
+const packed_position_t *get_packed_positions(const packed_position_file_t *file, size_t *count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PACKED_POSITION_H
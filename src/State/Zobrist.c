@@ -0,0 +1,42 @@
+/* iMate -- Copyright (C) 2024 Martin Newbound */
+
+#include "Zobrist.h"
+#include <stdbool.h>
+
+#define ZOBRIST_SEED 0x9E3779B97F4A7C15ULL
+
+uint64_t ZOBRIST_PIECE_KEYS[2][6][64];
+uint64_t ZOBRIST_CASTLING_KEYS[4];
+uint64_t ZOBRIST_EN_PASSANT_KEYS[8];
+uint64_t ZOBRIST_SIDE_KEY;
+
+/**
+ * @brief Generates the next number of a xorshift64* sequence.
+ *
+ * @param seed The generator state, updated in place.
+ * @return The next pseudo random number.
+ */
+static uint64_t next_random(uint64_t *seed) {
+    *seed ^= *seed >> 12;
+    *seed ^= *seed << 25;
+    *seed ^= *seed >> 27;
+    return *seed * 0x2545F4914F6CDD1DULL;
+}
+
+void init_zobrist_keys(void) {
+    static bool is_initialized = false;
+    if (is_initialized) return;
+
+    uint64_t seed = ZOBRIST_SEED;
+
+    for (int color = 0; color < 2; color++)
+        for (int piece = 0; piece < 6; piece++)
+            for (int square = 0; square < 64; square++)
+                ZOBRIST_PIECE_KEYS[color][piece][square] = next_random(&seed);
+
+    for (int i = 0; i < 4; i++) ZOBRIST_CASTLING_KEYS[i] = next_random(&seed);
+    for (int i = 0; i < 8; i++) ZOBRIST_EN_PASSANT_KEYS[i] = next_random(&seed);
+
+    ZOBRIST_SIDE_KEY = next_random(&seed);
+    is_initialized = true;
+}
@@ -0,0 +1,46 @@
+/**
+ * @file Zobrist.h
+ * @brief This file contains the declarations of the Zobrist keys used for hashing game states.
+ * 
+ * @details Every (color, piece, square) triple, every castling right, every en passant file and
+ * the side to move is assigned a pseudo random 64 bit key. The hash of a state is the XOR of the keys
+ * of all features present in it, which allows the hash to be updated incrementally when a move is played.
+ * 
+ * @version 1.0.0
+ * @author Martin Newbound
+ * @date 2024
+ * 
+ * @note License:
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef ZOBRIST_H
+#define ZOBRIST_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+extern uint64_t ZOBRIST_PIECE_KEYS[2][6][64];
+extern uint64_t ZOBRIST_CASTLING_KEYS[4];
+extern uint64_t ZOBRIST_EN_PASSANT_KEYS[8];
+extern uint64_t ZOBRIST_SIDE_KEY;
+
+/**
+ * Initializes the Zobrist key tables.
+ * 
+ * The keys are generated from a fixed seed so hash keys are identical between runs.
+ * This function must be called once before any game state is hashed, it is safe to call it more than once.
+ */
+void init_zobrist_keys(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ZOBRIST_H
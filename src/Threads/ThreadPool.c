@@ -0,0 +1,250 @@
+/* iMate -- Copyright (C) 2024 Martin Newbound */
+
+#include "ThreadPool.h"
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#define INITIAL_QUEUE_CAPACITY 64
+
+typedef struct {
+    thread_pool_task_t task;
+    void *argument;
+} queued_task_t;
+
+/**
+ * @brief A double ended queue of tasks held in a ring buffer.
+ *
+ * The owning worker takes tasks from the back, other workers steal from the front.
+ */
+typedef struct {
+    pthread_mutex_t lock;
+    queued_task_t *tasks;
+    size_t capacity;        // a power of two
+    size_t front;
+    size_t back;            // one past the newest task
+} task_queue_t;
+
+typedef struct {
+    pthread_t thread;
+    thread_pool_t *pool;
+    int index;
+    task_queue_t queue;
+} worker_t;
+
+struct thread_pool {
+    worker_t *workers;
+    int worker_count;
+    unsigned next_worker;
+
+    pthread_mutex_t lock;
+    pthread_cond_t work_available;
+    pthread_cond_t work_done;
+    size_t queued_count;    // tasks waiting in a queue
+    size_t pending_count;   // tasks submitted but not finished
+    bool is_stopping;
+};
+
+
+/*
++=============================================================================+
+|             Task Queues                                                     |
++=============================================================================+
+*/
+
+static void init_task_queue(task_queue_t *queue) {
+    pthread_mutex_init(&queue->lock, NULL);
+    queue->capacity = INITIAL_QUEUE_CAPACITY;
+    queue->tasks = malloc(sizeof(queued_task_t) * queue->capacity);
+    queue->front = 0;
+    queue->back = 0;
+}
+
+static void destroy_task_queue(task_queue_t *queue) {
+    pthread_mutex_destroy(&queue->lock);
+    free(queue->tasks);
+}
+
+/**
+ * @brief Appends a task to the back of a queue, doubling the ring buffer when it is full.
+ *
+ * @param queue The queue.
+ * @param task The task to append.
+ */
+static void push_task(task_queue_t *queue, queued_task_t task) {
+    pthread_mutex_lock(&queue->lock);
+
+    if (queue->back - queue->front == queue->capacity) {
+        queued_task_t *tasks = malloc(sizeof(queued_task_t) * queue->capacity * 2);
+        for (size_t i = queue->front; i < queue->back; i++) tasks[i - queue->front] = queue->tasks[i & (queue->capacity - 1)];
+
+        free(queue->tasks);
+        queue->tasks = tasks;
+        queue->back -= queue->front;
+        queue->front = 0;
+        queue->capacity *= 2;
+    }
+
+    queue->tasks[queue->back++ & (queue->capacity - 1)] = task;
+    pthread_mutex_unlock(&queue->lock);
+}
+
+/**
+ * @brief Takes a task from a queue.
+ *
+ * @param queue The queue.
+ * @param from_back true to take the newest task (the owner), false to take the oldest one (a thief).
+ * @param[out] task Receives the task.
+ * @return false if the queue is empty.
+ */
+static bool take_task(task_queue_t *queue, bool from_back, queued_task_t *task) {
+    pthread_mutex_lock(&queue->lock);
+
+    const bool is_empty = queue->front == queue->back;
+    if (!is_empty) {
+        const size_t index = from_back ? --queue->back : queue->front++;
+        *task = queue->tasks[index & (queue->capacity - 1)];
+    }
+
+    pthread_mutex_unlock(&queue->lock);
+    return !is_empty;
+}
+
+
+/*
++=============================================================================+
+|             Workers                                                         |
++=============================================================================+
+*/
+
+/**
+ * @brief Finds the next task for a worker: its own newest task, or else the oldest task of another worker.
+ *
+ * @param worker The worker looking for work.
+ * @param[out] task Receives the task.
+ * @return false if every queue is empty.
+ */
+static bool find_task(worker_t *worker, queued_task_t *task) {
+    if (take_task(&worker->queue, true, task)) return true;
+
+    thread_pool_t *pool = worker->pool;
+    for (int i = 1; i < pool->worker_count; i++) {
+        worker_t *victim = &pool->workers[(worker->index + i) % pool->worker_count];
+        if (take_task(&victim->queue, false, task)) return true;
+    }
+
+    return false;
+}
+
+static void *worker_main(void *argument) {
+    worker_t *worker = argument;
+    thread_pool_t *pool = worker->pool;
+    queued_task_t task;
+
+    while (true) {
+        if (find_task(worker, &task)) {
+            pthread_mutex_lock(&pool->lock);
+            pool->queued_count--;
+            pthread_mutex_unlock(&pool->lock);
+
+            task.task(task.argument, worker->index);
+
+            pthread_mutex_lock(&pool->lock);
+            if (--pool->pending_count == 0) pthread_cond_broadcast(&pool->work_done);
+            pthread_mutex_unlock(&pool->lock);
+            continue;
+        }
+
+        pthread_mutex_lock(&pool->lock);
+        while (pool->queued_count == 0 && !pool->is_stopping) pthread_cond_wait(&pool->work_available, &pool->lock);
+        const bool should_exit = pool->queued_count == 0 && pool->is_stopping;
+        pthread_mutex_unlock(&pool->lock);
+
+        if (should_exit) break;
+    }
+
+    return NULL;
+}
+
+
+/*
++=============================================================================+
+|             Pool                                                            |
++=============================================================================+
+*/
+
+int get_processor_count(void) {
+    const long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (int)count : 1;
+}
+
+thread_pool_t *new_thread_pool(int thread_count) {
+    if (thread_count < 1) thread_count = 1;
+
+    thread_pool_t *pool = malloc(sizeof(thread_pool_t));
+    pool->workers = malloc(sizeof(worker_t) * thread_count);
+    pool->worker_count = thread_count;
+    pool->next_worker = 0;
+    pool->queued_count = 0;
+    pool->pending_count = 0;
+    pool->is_stopping = false;
+
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->work_available, NULL);
+    pthread_cond_init(&pool->work_done, NULL);
+
+    // Every queue must exist before any worker starts stealing
+    for (int i = 0; i < thread_count; i++) {
+        pool->workers[i].pool = pool;
+        pool->workers[i].index = i;
+        init_task_queue(&pool->workers[i].queue);
+    }
+
+    for (int i = 0; i < thread_count; i++) pthread_create(&pool->workers[i].thread, NULL, worker_main, &pool->workers[i]);
+
+    return pool;
+}
+
+void free_thread_pool(thread_pool_t *pool) {
+    wait_thread_pool(pool);
+
+    pthread_mutex_lock(&pool->lock);
+    pool->is_stopping = true;
+    pthread_cond_broadcast(&pool->work_available);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (int i = 0; i < pool->worker_count; i++) pthread_join(pool->workers[i].thread, NULL);
+    for (int i = 0; i < pool->worker_count; i++) destroy_task_queue(&pool->workers[i].queue);
+
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->work_available);
+    pthread_cond_destroy(&pool->work_done);
+    free(pool->workers);
+    free(pool);
+}
+
+int get_thread_pool_size(const thread_pool_t *pool) {
+    return pool->worker_count;
+}
+
+void submit_thread_pool_task(thread_pool_t *pool, thread_pool_task_t task, void *argument) {
+    const queued_task_t queued_task = {task, argument};
+
+    pthread_mutex_lock(&pool->lock);
+    worker_t *worker = &pool->workers[pool->next_worker++ % pool->worker_count];
+    pool->pending_count++;
+
+    // The task is counted only once it can be found, and a worker which takes it early waits on the pool lock
+    // before uncounting it, so queued_count never disagrees with the queues for a waiting worker
+    push_task(&worker->queue, queued_task);
+    pool->queued_count++;
+    pthread_cond_signal(&pool->work_available);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+void wait_thread_pool(thread_pool_t *pool) {
+    pthread_mutex_lock(&pool->lock);
+    while (pool->pending_count > 0) pthread_cond_wait(&pool->work_done, &pool->lock);
+    pthread_mutex_unlock(&pool->lock);
+}
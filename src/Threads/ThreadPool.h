@@ -0,0 +1,93 @@
+/* iMate -- Copyright (C) 2024 Martin Newbound */
+
+/**
+ * @file ThreadPool.h
+ * @brief This file contains the declarations of the work-stealing thread pool used to run independent jobs in parallel.
+ * 
+ * @details Each worker owns a queue of tasks. A worker takes the most recently queued task of its own queue and,
+ * once its queue is empty, steals the oldest task of another worker's queue, so the load evens out however
+ * long individual tasks run. Tasks learn the index of the worker running them, which lets them use per-worker
+ * resources (such as a search context) without locking.
+ * 
+ * @version 1.0.0
+ * @author Martin Newbound
+ * @date 2024
+ * 
+ * @note License:
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief A function run by the pool.
+ *
+ * @param argument The argument the task was submitted with.
+ * @param worker_index The index of the worker running the task, from 0 to the size of the pool - 1.
+ */
+typedef void (*thread_pool_task_t)(void *argument, int worker_index);
+
+// Represents a pool of worker threads
+typedef struct thread_pool thread_pool_t;
+
+/**
+ * Returns the number of processors available to the engine.
+ * 
+ * @return The number of online processors, at least 1.
+ */
+int get_processor_count(void);
+
+/**
+ * Creates a pool of worker threads, which wait for tasks.
+ * 
+ * @param thread_count The number of workers, at least 1.
+ * @return A pointer to the new thread pool.
+ * 
+ * @warning The caller is responsible for freeing the pool with free_thread_pool.
+ */
+thread_pool_t *new_thread_pool(int thread_count);
+
+/**
+ * Waits for all submitted tasks to finish, then stops the workers and frees the pool.
+ * 
+ * @param pool The thread pool to free.
+ */
+void free_thread_pool(thread_pool_t *pool);
+
+/**
+ * Returns the number of workers of a pool.
+ * 
+ * @param pool The thread pool.
+ * @return The number of workers.
+ */
+int get_thread_pool_size(const thread_pool_t *pool);
+
+/**
+ * Queues a task. Tasks are spread over the workers' queues in turn.
+ * 
+ * @param pool The thread pool.
+ * @param task The function to run.
+ * @param argument The argument passed to the function.
+ */
+void submit_thread_pool_task(thread_pool_t *pool, thread_pool_task_t task, void *argument);
+
+/**
+ * Blocks until every submitted task has finished.
+ * 
+ * @param pool The thread pool.
+ */
+void wait_thread_pool(thread_pool_t *pool);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // THREAD_POOL_H
@@ -0,0 +1,60 @@
+/* iMate -- Copyright (C) 2024 Martin Newbound */
+
+#include "Arena.h"
+#include <stdlib.h>
+
+/**
+ * @brief Allocates a block able to hold a given number of bytes.
+ *
+ * @param size The usable size of the block.
+ * @return The new block.
+ */
+static arena_block_t *new_arena_block(size_t size) {
+    arena_block_t *block = malloc(sizeof(arena_block_t) + size);
+    if (block == NULL) abort();
+
+    block->next = NULL;
+    block->size = size;
+    return block;
+}
+
+arena_t *new_arena(size_t block_size) {
+    arena_t *arena = malloc(sizeof(arena_t));
+    arena->block_size = (block_size + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1);
+    arena->first = new_arena_block(arena->block_size);
+    arena->current = arena->first;
+    arena->offset = 0;
+    return arena;
+}
+
+void free_arena(arena_t *arena) {
+    arena_block_t *block = arena->first;
+    while (block != NULL) {
+        arena_block_t *next = block->next;
+        free(block);
+        block = next;
+    }
+
+    free(arena);
+}
+
+void *grow_arena(arena_t *arena, size_t size) {
+    // Reuse the next block when it is large enough, otherwise insert a new one before it
+    arena_block_t *next = arena->current->next;
+    if (next == NULL || next->size < size) {
+        arena_block_t *block = new_arena_block(size > arena->block_size ? size : arena->block_size);
+        block->next = next;
+        arena->current->next = block;
+        next = block;
+    }
+
+    arena->current = next;
+    arena->offset = size;
+    return next->data;
+}
+
+size_t get_arena_capacity(const arena_t *arena) {
+    size_t capacity = 0;
+    for (const arena_block_t *block = arena->first; block != NULL; block = block->next) capacity += block->size;
+    return capacity;
+}
@@ -0,0 +1,151 @@
+/* iMate -- Copyright (C) 2024 Martin Newbound */
+
+/**
+ * @file Arena.h
+ * @brief This file contains the declarations of the bump allocator used for the short lived objects of a search.
+ *
+ * @details An arena hands out memory by moving a pointer forward inside large blocks, and gives it all back at
+ * once by moving the pointer back. Nothing allocated from an arena is freed on its own.
+ *
+ * Allocations follow the recursion of the search: a node takes a mark before allocating its moves and child
+ * states, and releases the arena to that mark before returning, which frees everything its subtree allocated
+ * in O(1). Blocks are kept when the arena is released, so once the deepest line has been searched an arena
+ * stops asking the system for memory and its size stays flat however long the search runs.
+ *
+ * An arena belongs to one thread (each search context owns its own), it is not thread safe.
+ *
+ * @version 1.0.0
+ * @author Martin Newbound
+ * @date 2024
+ *
+ * @note License:
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Every allocation is aligned to this many bytes
+#define ARENA_ALIGNMENT 16
+
+// A block of memory of an arena, blocks are chained in the order they are used
+typedef struct arena_block {
+    struct arena_block *next;
+    size_t size;
+    _Alignas(ARENA_ALIGNMENT) unsigned char data[];
+} arena_block_t;
+
+/**
+ * @brief A bump allocator. The fields are only exposed so arena_alloc can be inlined, use the functions below.
+ */
+typedef struct {
+    arena_block_t *first;
+    arena_block_t *current;
+    size_t offset;          // bytes used in the current block
+    size_t block_size;
+} arena_t;
+
+/**
+ * @brief A position of an arena, everything allocated after it is freed by release_arena_to_mark.
+ */
+typedef struct {
+    arena_block_t *block;
+    size_t offset;
+} arena_mark_t;
+
+/**
+ * Creates an arena.
+ *
+ * @param block_size The size of the blocks the arena reserves, larger allocations get a block of their own.
+ * @return A pointer to the new arena.
+ *
+ * @warning The caller is responsible for freeing the arena with free_arena.
+ */
+arena_t *new_arena(size_t block_size);
+
+/**
+ * Frees an arena along with everything allocated from it.
+ *
+ * @param arena The arena to free.
+ */
+void free_arena(arena_t *arena);
+
+/**
+ * Moves the arena to a new block when the current one is full. Called by arena_alloc.
+ *
+ * @param arena The arena.
+ * @param size The size of the allocation which did not fit, already rounded to ARENA_ALIGNMENT.
+ * @return The allocated memory.
+ */
+void *grow_arena(arena_t *arena, size_t size);
+
+/**
+ * Allocates memory from an arena. The memory is not cleared.
+ *
+ * @param arena The arena.
+ * @param size The number of bytes to allocate.
+ * @return The allocated memory, aligned to ARENA_ALIGNMENT.
+ */
+static inline void *arena_alloc(arena_t *arena, size_t size) {
+    size = (size + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1);
+    if (arena->current->size - arena->offset < size) return grow_arena(arena, size);
+
+    void *memory = arena->current->data + arena->offset;
+    arena->offset += size;
+    return memory;
+}
+
+/**
+ * Returns the current position of an arena.
+ *
+ * @param arena The arena.
+ * @return The mark to give to release_arena_to_mark.
+ */
+static inline arena_mark_t get_arena_mark(const arena_t *arena) {
+    return (arena_mark_t){.block = arena->current, .offset = arena->offset};
+}
+
+/**
+ * Frees everything allocated from an arena since a mark was taken, in O(1).
+ *
+ * @param arena The arena.
+ * @param mark A mark of the arena, taken before the allocations to free.
+ */
+static inline void release_arena_to_mark(arena_t *arena, arena_mark_t mark) {
+    arena->current = mark.block;
+    arena->offset = mark.offset;
+}
+
+/**
+ * Frees everything allocated from an arena, in O(1). The blocks are kept for the next allocations.
+ *
+ * @param arena The arena.
+ */
+static inline void reset_arena(arena_t *arena) {
+    arena->current = arena->first;
+    arena->offset = 0;
+}
+
+/**
+ * Returns the memory reserved by an arena, whether in use or not.
+ *
+ * @param arena The arena.
+ * @return The total size of the arena's blocks in bytes.
+ */
+size_t get_arena_capacity(const arena_t *arena);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ARENA_H
@@ -0,0 +1,36 @@
+/* iMate -- Copyright (C) 2024 Martin Newbound */
+
+/**
+ * @file BenchPositions.h
+ * @brief This file contains the declaration of the fixed set of positions used by the benchmarks.
+ * 
+ * @details The positions are a mix of openings, middlegames, endgames with few pieces, and mated or
+ * stalemated positions. They are searched by the "bench" command and timed by the microbenchmarks.
+ * Changing the list changes the signature printed by "bench".
+ * 
+ * @version 1.0.0
+ * @author Martin Newbound
+ * @date 2024
+ * 
+ * @note License:
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef BENCH_POSITIONS_H
+#define BENCH_POSITIONS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern const char *const BENCH_POSITIONS[];
+extern const int BENCH_POSITION_COUNT;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BENCH_POSITIONS_H
@@ -0,0 +1,101 @@
+/* iMate -- Copyright (C) 2024 Martin Newbound */
+
+/**
+ * @file BitOperations.h
+ * @brief This file contains the bit operations on bitboards: population count and bit scans.
+ *
+ * @details Every operation maps to a single instruction where the processor has one. Bit scans use BSF/BSR
+ * (TZCNT/LZCNT when built for them), which every x86-64 processor has. The population count uses the POPCNT
+ * instruction when the build targets it, or when detect_cpu_features found it on the processor running a
+ * baseline build, and otherwise falls back to a branchless SWAR count.
+ *
+ * @version 1.0.0
+ * @author Martin Newbound
+ * @date 2024
+ *
+ * @note License:
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef BIT_OPERATIONS_H
+#define BIT_OPERATIONS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "CpuFeatures.h"
+#include <stdint.h>
+
+/**
+ * Counts the bits set in a bitboard without the POPCNT instruction.
+ *
+ * @param bitboard The bitboard.
+ * @return The number of bits set.
+ */
+static inline int popcount_portable(uint64_t bitboard) {
+    bitboard -= (bitboard >> 1) & 0x5555555555555555ULL;
+    bitboard = (bitboard & 0x3333333333333333ULL) + ((bitboard >> 2) & 0x3333333333333333ULL);
+    bitboard = (bitboard + (bitboard >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return (int)((bitboard * 0x0101010101010101ULL) >> 56);
+}
+
+/**
+ * Counts the bits set in a bitboard.
+ *
+ * @param bitboard The bitboard.
+ * @return The number of bits set.
+ */
+static inline int popcount(uint64_t bitboard) {
+#if defined(__POPCNT__) || !(defined(__GNUC__) && defined(__x86_64__))
+    return __builtin_popcountll(bitboard);
+#else
+    if (CPU_FEATURES.has_popcnt) {
+        uint64_t count;
+        __asm__("popcntq %1, %0" : "=r"(count) : "r"(bitboard));
+        return (int)count;
+    }
+    return popcount_portable(bitboard);
+#endif
+}
+
+/**
+ * Returns the index of the least significant bit set in a bitboard.
+ *
+ * @param bitboard The bitboard, which must not be empty.
+ * @return The index of the bit, 0 to 63.
+ */
+static inline int lsb_index(uint64_t bitboard) {
+    return __builtin_ctzll(bitboard);
+}
+
+/**
+ * Returns the index of the most significant bit set in a bitboard.
+ *
+ * @param bitboard The bitboard, which must not be empty.
+ * @return The index of the bit, 0 to 63.
+ */
+static inline int msb_index(uint64_t bitboard) {
+    return 63 ^ __builtin_clzll(bitboard);
+}
+
+/**
+ * Clears the least significant bit set in a bitboard and returns its index.
+ *
+ * @param bitboard The bitboard, which must not be empty.
+ * @return The index of the bit cleared, 0 to 63.
+ */
+static inline int pop_lsb(uint64_t *bitboard) {
+    const int index = lsb_index(*bitboard);
+    *bitboard &= *bitboard - 1;
+    return index;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BIT_OPERATIONS_H
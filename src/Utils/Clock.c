@@ -0,0 +1,22 @@
+/* iMate -- Copyright (C) 2024 Martin Newbound */
+
+#include "Clock.h"
+#include <time.h>
+
+int64_t get_time_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (int64_t)now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+int64_t get_time_ms(void) {
+    return get_time_ns() / 1000000LL;
+}
+
+void sleep_ms(int64_t milliseconds) {
+    struct timespec duration = {
+        .tv_sec = milliseconds / 1000,
+        .tv_nsec = (milliseconds % 1000) * 1000000L
+    };
+    nanosleep(&duration, NULL);
+}
@@ -0,0 +1,67 @@
+/**
+ * @file Clock.h
+ * @brief This file contains the declarations of the monotonic clock helpers used for timing searches.
+ * 
+ * @version 1.0.0
+ * @author Martin Newbound
+ * @date 2024
+ * 
+ * @note License:
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/**
+ * Returns the current time of a monotonic clock in milliseconds.
+ * 
+ * The starting point is arbitrary, only differences between two readings are meaningful.
+ * 
+ * @return The current time in milliseconds.
+ */
+int64_t get_time_ms(void);
+
+/**
+ * Returns the current time of a monotonic clock in nanoseconds.
+ * 
+ * @return The current time in nanoseconds.
+ */
+int64_t get_time_ns(void);
+
+/**
+ * Suspends the calling thread for a number of milliseconds.
+ * 
+ * @param milliseconds The time to sleep for.
+ */
+void sleep_ms(int64_t milliseconds);
+
+/**
+ * Reads a cheap, high resolution counter: the time stamp counter on x86, the monotonic clock elsewhere.
+ * 
+ * The length of a tick is unknown, callers convert ticks to time by comparing two readings with get_time_ns.
+ * 
+ * @return The current value of the counter.
+ */
+static inline uint64_t read_cycle_counter(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __builtin_ia32_rdtsc();
+#else
+    return (uint64_t)get_time_ns();
+#endif
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CLOCK_H
@@ -0,0 +1,51 @@
+/* iMate -- Copyright (C) 2024 Martin Newbound */
+
+#include "CpuFeatures.h"
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <cpuid.h>
+#define HAS_CPUID
+#endif
+
+// CPUID feature bits
+#define CPUID_1_ECX_POPCNT (1u << 23)
+#define CPUID_7_EBX_AVX2 (1u << 5)
+#define CPUID_7_EBX_BMI2 (1u << 8)
+
+// AMD implements PEXT in microcode (tens of cycles) up to Zen 2, family 17h
+#define AMD_FAST_PEXT_FAMILY 0x19
+
+cpu_features_t CPU_FEATURES;
+
+void detect_cpu_features(void) {
+    static bool is_detected = false;
+    if (is_detected) return;
+    is_detected = true;
+
+#ifdef HAS_CPUID
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(0, &eax, &ebx, &ecx, &edx)) return;
+
+    const unsigned int max_leaf = eax;
+    char vendor[13];
+    memcpy(vendor, &ebx, 4);
+    memcpy(vendor + 4, &edx, 4);
+    memcpy(vendor + 8, &ecx, 4);
+    vendor[12] = '\0';
+
+    __get_cpuid(1, &eax, &ebx, &ecx, &edx);
+    const unsigned int base_family = (eax >> 8) & 0xF;
+    const unsigned int family = base_family == 0xF ? base_family + ((eax >> 20) & 0xFF) : base_family;
+    CPU_FEATURES.has_popcnt = (ecx & CPUID_1_ECX_POPCNT) != 0;
+
+    if (max_leaf >= 7) {
+        __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx);
+        CPU_FEATURES.has_avx2 = (ebx & CPUID_7_EBX_AVX2) != 0;
+        CPU_FEATURES.has_bmi2 = (ebx & CPUID_7_EBX_BMI2) != 0;
+    }
+
+    const bool is_amd = strcmp(vendor, "AuthenticAMD") == 0 || strcmp(vendor, "HygonGenuine") == 0;
+    CPU_FEATURES.has_fast_pext = CPU_FEATURES.has_bmi2 && !(is_amd && family < AMD_FAST_PEXT_FAMILY);
+#endif
+}
@@ -0,0 +1,55 @@
+/* iMate -- Copyright (C) 2024 Martin Newbound */
+
+/**
+ * @file CpuFeatures.h
+ * @brief This file contains the detection of the instruction set extensions of the processor running the engine.
+ *
+ * @details The engine is built for the baseline of its architecture, so one binary runs on every machine. The
+ * extensions which pay off in the hot paths (POPCNT for bit counting, BMI2 PEXT for the slider lookups) are
+ * detected once at startup with CPUID, and the code using them branches on CPU_FEATURES, a branch which is
+ * always predicted. Until detect_cpu_features is called every feature reads as absent, so the portable code paths
+ * are taken.
+ *
+ * @version 1.0.0
+ * @author Martin Newbound
+ * @date 2024
+ *
+ * @note License:
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef CPU_FEATURES_H
+#define CPU_FEATURES_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+
+/**
+ * @brief The extensions of the processor the engine uses.
+ */
+typedef struct {
+    bool has_popcnt;        // POPCNT
+    bool has_bmi2;          // BMI2 (PEXT, PDEP)
+    bool has_fast_pext;     // BMI2 with a PEXT as fast as a multiplication, which AMD processors before Zen 3 lack
+    bool has_avx2;          // AVX2
+} cpu_features_t;
+
+// The features of the processor, filled by detect_cpu_features
+extern cpu_features_t CPU_FEATURES;
+
+/**
+ * Detects the features of the processor into CPU_FEATURES. Calling it again has no effect.
+ */
+void detect_cpu_features(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CPU_FEATURES_H
@@ -0,0 +1,94 @@
+/* iMate -- Copyright (C) 2024 Martin Newbound */
+
+// MAP_ANONYMOUS, MAP_HUGETLB and MADV_HUGEPAGE are Linux extensions hidden by a strict POSIX feature level
+#ifdef __linux__
+#define _DEFAULT_SOURCE
+#endif
+
+#include "LargePages.h"
+#include <stdint.h>
+#include <stdlib.h>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+#define HUGE_PAGE_SIZE (2 * 1024 * 1024)
+#define CACHE_LINE_SIZE 64
+
+static const char *PAGE_KIND_NAMES[] = {
+    "heap pages",
+    "normal pages",
+    "transparent huge pages",
+    "huge pages"
+};
+
+/**
+ * @brief Rounds a size up to a whole number of huge pages.
+ */
+static size_t round_to_huge_pages(size_t size) {
+    return (size + HUGE_PAGE_SIZE - 1) & ~(size_t)(HUGE_PAGE_SIZE - 1);
+}
+
+#ifdef __linux__
+
+/**
+ * @brief Maps memory aligned to a huge page, so the kernel can back all of it with transparent huge pages.
+ *
+ * @param size The size to map, a whole number of huge pages.
+ * @param[out] kind Receives PAGES_TRANSPARENT_HUGE, or PAGES_MAPPED if the kernel refused the advice.
+ * @return The mapping, or NULL if it failed.
+ */
+static void *map_aligned_pages(size_t size, page_kind_t *kind) {
+    // Map one huge page more than needed, then unmap what lies before and after the aligned part
+    unsigned char *mapping = mmap(NULL, size + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mapping == MAP_FAILED) return NULL;
+
+    const size_t head = (HUGE_PAGE_SIZE - (uintptr_t)mapping % HUGE_PAGE_SIZE) % HUGE_PAGE_SIZE;
+    if (head > 0) munmap(mapping, head);
+    munmap(mapping + head + size, HUGE_PAGE_SIZE - head);
+
+    unsigned char *memory = mapping + head;
+    *kind = madvise(memory, size, MADV_HUGEPAGE) == 0 ? PAGES_TRANSPARENT_HUGE : PAGES_MAPPED;
+    return memory;
+}
+
+#endif // __linux__
+
+void *allocate_large_pages(size_t size, page_kind_t *kind) {
+#ifdef __linux__
+    const size_t mapped_size = round_to_huge_pages(size);
+
+    void *memory = mmap(NULL, mapped_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (memory != MAP_FAILED) {
+        *kind = PAGES_HUGE;
+        return memory;
+    }
+
+    memory = map_aligned_pages(mapped_size, kind);
+    if (memory != NULL) return memory;
+#endif
+
+    *kind = PAGES_HEAP;
+    return aligned_alloc(CACHE_LINE_SIZE, (size + CACHE_LINE_SIZE - 1) & ~(size_t)(CACHE_LINE_SIZE - 1));
+}
+
+void free_large_pages(void *memory, size_t size, page_kind_t kind) {
+    if (memory == NULL) return;
+
+#ifdef __linux__
+    if (kind != PAGES_HEAP) {
+        munmap(memory, round_to_huge_pages(size));
+        return;
+    }
+#else
+    (void)size;
+    (void)kind;
+#endif
+
+    free(memory);
+}
+
+const char *get_page_kind_name(page_kind_t kind) {
+    return PAGE_KIND_NAMES[kind];
+}
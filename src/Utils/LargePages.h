@@ -0,0 +1,75 @@
+/* iMate -- Copyright (C) 2024 Martin Newbound */
+
+/**
+ * @file LargePages.h
+ * @brief This file contains the declarations of the allocator used for large tables, backed by huge pages.
+ *
+ * @details A table of several gigabytes spread over 4KB pages needs far more address translations than the TLB
+ * holds, so almost every random access to it misses the TLB. Backing it with 2MB pages removes most of those
+ * misses.
+ *
+ * On Linux the memory is first requested from the reserved huge page pool (MAP_HUGETLB), then as a 2MB aligned
+ * mapping the kernel is asked to back with transparent huge pages (MADV_HUGEPAGE), then as a plain mapping.
+ * Elsewhere, or if mapping fails, it comes from the heap.
+ *
+ * @version 1.0.0
+ * @author Martin Newbound
+ * @date 2024
+ *
+ * @note License:
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef LARGE_PAGES_H
+#define LARGE_PAGES_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+
+// How the memory of a large allocation was obtained
+typedef enum {
+    PAGES_HEAP,                 // the heap, normal pages
+    PAGES_MAPPED,               // a mapping with normal pages
+    PAGES_TRANSPARENT_HUGE,     // a mapping the kernel was asked to back with transparent huge pages
+    PAGES_HUGE                  // a mapping of reserved huge pages
+} page_kind_t;
+
+/**
+ * Allocates memory for a large table, using huge pages when the system provides them.
+ *
+ * The memory is not cleared and is aligned to at least 64 bytes.
+ *
+ * @param size The number of bytes to allocate.
+ * @param[out] kind Receives how the memory was obtained, to be given to free_large_pages.
+ * @return The allocated memory, or NULL if there is not enough memory.
+ */
+void *allocate_large_pages(size_t size, page_kind_t *kind);
+
+/**
+ * Frees memory allocated by allocate_large_pages.
+ *
+ * @param memory The memory to free, may be NULL.
+ * @param size The size given to allocate_large_pages.
+ * @param kind The kind returned by allocate_large_pages.
+ */
+void free_large_pages(void *memory, size_t size, page_kind_t kind);
+
+/**
+ * Returns a description of a kind of pages, such as "transparent huge pages".
+ *
+ * @param kind The kind of pages.
+ * @return The description.
+ */
+const char *get_page_kind_name(page_kind_t kind);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LARGE_PAGES_H
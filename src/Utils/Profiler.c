@@ -0,0 +1,110 @@
+/* iMate -- Copyright (C) 2024 Martin Newbound */
+
+#include "Profiler.h"
+
+#ifdef ENGINE_PROFILE
+
+#include "Clock.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *REGION_NAMES[PROFILE_REGION_COUNT] = {
+    "move generation",
+    "make move",
+    "attack detection",
+    "evaluation",
+    "tt probe",
+    "tt store",
+    "move ordering"
+};
+
+/**
+ * @brief The counters of one thread, linked into a list so the report can find every thread's counters.
+ */
+typedef struct profile_block {
+    uint64_t calls[PROFILE_REGION_COUNT];
+    uint64_t ticks[PROFILE_REGION_COUNT];
+    struct profile_block *next;
+} profile_block_t;
+
+static _Thread_local profile_block_t *thread_block;
+
+static profile_block_t *blocks;
+static pthread_mutex_t blocks_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// Clock and wall time at the last reset, used to convert ticks to nanoseconds
+static uint64_t reset_ticks;
+static int64_t reset_time_ns;
+
+/**
+ * @brief Creates the counters of the calling thread. They outlive the thread so the report keeps its figures.
+ *
+ * @return The counters of the calling thread.
+ */
+static profile_block_t *register_thread_block(void) {
+    profile_block_t *block = calloc(1, sizeof(profile_block_t));
+
+    pthread_mutex_lock(&blocks_lock);
+    if (blocks == NULL) {
+        reset_ticks = read_cycle_counter();
+        reset_time_ns = get_time_ns();
+    }
+    block->next = blocks;
+    blocks = block;
+    pthread_mutex_unlock(&blocks_lock);
+
+    thread_block = block;
+    return block;
+}
+
+void end_profile_scope(const profile_scope_t *scope) {
+    const uint64_t elapsed = read_cycle_counter() - scope->start;
+    profile_block_t *block = thread_block != NULL ? thread_block : register_thread_block();
+
+    block->calls[scope->region]++;
+    block->ticks[scope->region] += elapsed;
+}
+
+void reset_profile(void) {
+    pthread_mutex_lock(&blocks_lock);
+    for (profile_block_t *block = blocks; block != NULL; block = block->next) {
+        memset(block->calls, 0, sizeof(block->calls));
+        memset(block->ticks, 0, sizeof(block->ticks));
+    }
+    reset_ticks = read_cycle_counter();
+    reset_time_ns = get_time_ns();
+    pthread_mutex_unlock(&blocks_lock);
+}
+
+void print_profile_report(void) {
+    uint64_t calls[PROFILE_REGION_COUNT] = {0}, ticks[PROFILE_REGION_COUNT] = {0};
+
+    pthread_mutex_lock(&blocks_lock);
+    for (profile_block_t *block = blocks; block != NULL; block = block->next) {
+        for (int region = 0; region < PROFILE_REGION_COUNT; region++) {
+            calls[region] += block->calls[region];
+            ticks[region] += block->ticks[region];
+        }
+    }
+
+    const uint64_t elapsed_ticks = read_cycle_counter() - reset_ticks;
+    const int64_t elapsed_ns = get_time_ns() - reset_time_ns;
+    pthread_mutex_unlock(&blocks_lock);
+
+    // The length of a tick is measured against the wall clock over the whole profiling period
+    const double ns_per_tick = elapsed_ticks > 0 ? (double)elapsed_ns / (double)elapsed_ticks : 1.0;
+
+    printf("%-18s %14s %12s %12s %10s\n", "region", "calls", "total ms", "avg ns", "ticks/call");
+    for (int region = 0; region < PROFILE_REGION_COUNT; region++) {
+        const double total_ns = (double)ticks[region] * ns_per_tick;
+        printf("%-18s %14llu %12.1f %12.1f %10.1f\n", REGION_NAMES[region], (unsigned long long)calls[region],
+               total_ns / 1e6, calls[region] ? total_ns / (double)calls[region] : 0.0,
+               calls[region] ? (double)ticks[region] / (double)calls[region] : 0.0);
+    }
+    printf("profiled period %.1f ms, regions may nest so their totals can overlap\n", (double)elapsed_ns / 1e6);
+    fflush(stdout);
+}
+
+#endif // ENGINE_PROFILE
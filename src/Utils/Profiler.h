@@ -0,0 +1,88 @@
+/* iMate -- Copyright (C) 2024 Martin Newbound */
+
+/**
+ * @file Profiler.h
+ * @brief This file contains the declarations of the scoped timers used to measure the cost of each engine subsystem.
+ * 
+ * @details The timers only exist when the engine is built with ENGINE_PROFILE defined (the CMake option
+ * IMATE_PROFILE). Otherwise PROFILE_SCOPE expands to nothing.
+ * 
+ * PROFILE_SCOPE(region) placed at the top of a function times everything up to the function's return and adds
+ * it to the region's total, along with one call. Time is read with read_cycle_counter. Each thread counts into
+ * its own block of counters, the report sums them.
+ * Regions may nest (attack detection runs inside move generation), so the time of a region includes the
+ * regions it calls.
+ * 
+ * @version 1.0.0
+ * @author Martin Newbound
+ * @date 2024
+ * 
+ * @note License:
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "Clock.h"
+
+typedef enum {
+    PROFILE_MOVE_GENERATION     = 0,
+    PROFILE_MAKE_MOVE           = 1,
+    PROFILE_ATTACK_DETECTION    = 2,
+    PROFILE_EVALUATION          = 3,
+    PROFILE_TT_PROBE            = 4,
+    PROFILE_TT_STORE            = 5,
+    PROFILE_MOVE_ORDERING       = 6,
+    PROFILE_REGION_COUNT        = 7
+} profile_region_t;
+
+#ifdef ENGINE_PROFILE
+
+/**
+ * @brief A running timer, recorded when it goes out of scope.
+ */
+typedef struct {
+    profile_region_t region;
+    uint64_t start;
+} profile_scope_t;
+
+/**
+ * Records the end of a timed scope. Called automatically by PROFILE_SCOPE.
+ * 
+ * @param scope The scope which ends.
+ */
+void end_profile_scope(const profile_scope_t *scope);
+
+/**
+ * Clears the counters of every thread.
+ */
+void reset_profile(void);
+
+/**
+ * Prints the number of calls, total time and average time of each region since the last reset.
+ */
+void print_profile_report(void);
+
+#define PROFILE_SCOPE(REGION) \
+    __attribute__((cleanup(end_profile_scope))) const profile_scope_t profile_scope = {(REGION), read_cycle_counter()}
+
+#else
+
+#define PROFILE_SCOPE(REGION) ((void)0)
+
+#endif // ENGINE_PROFILE
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PROFILER_H
@@ -0,0 +1,130 @@
+/* iMate -- Copyright (C) 2024 Martin Newbound */
+
+/**
+ * @file PgnConverter.c
+ * @brief Converts the games of a PGN file to labeled positions, or only decodes them to check the file.
+ *
+ * @details Every position of a finished game is labeled with the game's result and appended to the output, as
+ * "<fen> [1.0|0.5|0.0]" lines (the text format read by parse_labeled_position) or as packed records. Unfinished
+ * games and games which fail to decode are not written. Without an output, the games are only decoded and the
+ * speed of the reader is reported.
+ *
+ * Usage: iMatePgn <pgn file> [fen|packed <output file>]
+ */
+
+#include "Moves/PgnReader.h"
+#include "Moves/SliderAttacks.h"
+#include "State/PackedPosition.h"
+#include "Utils/Clock.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef enum {
+    OUTPUT_NONE,
+    OUTPUT_FEN,
+    OUTPUT_PACKED
+} output_format_t;
+
+// The positions of the game being read, labeled once its result is known
+typedef struct {
+    packed_position_t *positions;
+    size_t count;
+    size_t capacity;
+} game_positions_t;
+
+static void on_position(void *context, const state_t *state, const move_t *move) {
+    (void)move;
+    game_positions_t *game = context;
+
+    if (game->count == game->capacity) {
+        game->capacity = game->capacity == 0 ? 256 : game->capacity * 2;
+        game->positions = realloc(game->positions, game->capacity * sizeof(packed_position_t));
+    }
+
+    if (pack_position(state, 0, PACKED_DRAW, &game->positions[game->count])) game->count++;
+}
+
+static bool write_game(FILE *output, output_format_t format, game_positions_t *game, pgn_result_t result,
+                       state_t *state) {
+    static const char *LABELS[3] = {"0.0", "0.5", "1.0"};
+    const int packed_result = PACKED_WHITE_WINS - (int)result;
+
+    for (size_t i = 0; i < game->count; i++) game->positions[i].result = (uint8_t)packed_result;
+
+    if (format == OUTPUT_PACKED) return write_packed_positions(output, game->positions, game->count);
+
+    char fen[FEN_STRING_LENGTH];
+    for (size_t i = 0; i < game->count; i++) {
+        unpack_position(&game->positions[i], state);
+        state_to_fen(state, fen);
+        if (fprintf(output, "%s [%s]\n", fen, LABELS[packed_result]) < 0) return false;
+    }
+
+    return true;
+}
+
+int main(int argc, char **argv) {
+    output_format_t format = OUTPUT_NONE;
+    if (argc == 4 && strcmp(argv[2], "fen") == 0) format = OUTPUT_FEN;
+    else if (argc == 4 && strcmp(argv[2], "packed") == 0) format = OUTPUT_PACKED;
+    else if (argc != 2) {
+        fprintf(stderr, "usage: %s <pgn file> [fen|packed <output file>]\n", argv[0]);
+        return 1;
+    }
+
+    init_slider_attacks();
+    pgn_reader_t *reader = open_pgn_file(argv[1]);
+    if (reader == NULL) {
+        fprintf(stderr, "cannot open %s\n", argv[1]);
+        return 1;
+    }
+
+    FILE *output = NULL;
+    if (format != OUTPUT_NONE) {
+        output = fopen(argv[3], format == OUTPUT_PACKED ? "ab" : "a");
+        if (output == NULL) {
+            fprintf(stderr, "cannot open %s\n", argv[3]);
+            close_pgn_file(reader);
+            return 1;
+        }
+    }
+
+    game_positions_t positions = {0};
+    state_t *state = new_state();
+    long games = 0, errors = 0, unfinished = 0, moves = 0, written = 0;
+    bool is_written = true;
+    pgn_game_t game;
+    const int64_t start_time = get_time_ms();
+
+    while (is_written && read_pgn_game(reader, &game, output != NULL ? on_position : NULL, &positions)) {
+        games++;
+        moves += game.ply_count;
+
+        if (game.has_error) errors++;
+        else if (game.result == PGN_UNFINISHED) unfinished++;
+        else if (output != NULL) {
+            is_written = write_game(output, format, &positions, game.result, state);
+            written += (long)positions.count;
+        }
+
+        positions.count = 0;
+    }
+
+    const int64_t elapsed = get_time_ms() - start_time;
+    if (output != NULL) is_written = fclose(output) == 0 && is_written;
+
+    free(positions.positions);
+    free_state(state);
+    close_pgn_file(reader);
+
+    if (!is_written) {
+        fprintf(stderr, "cannot write %s\n", argv[3]);
+        return 1;
+    }
+
+    printf("%ld games, %ld with errors, %ld unfinished, %ld moves, %ld positions written, %.0f moves/s\n", games,
+           errors, unfinished, moves, written, elapsed > 0 ? moves * 1000.0 / elapsed : 0.0);
+    return 0;
+}
@@ -0,0 +1,118 @@
+/* iMate -- Copyright (C) 2024 Martin Newbound */
+
+/**
+ * @file PositionPacker.c
+ * @brief Converts labeled positions from text to the packed binary format, and checks packed files.
+ *
+ * @details "pack" reads one labeled position per line (see parse_labeled_position) and appends a record per valid
+ * line to the output. "check" maps a packed file, unpacks every record into the same state and reports the number
+ * of valid records, the result counts and the speed.
+ *
+ * Usage: iMatePack pack <text file> <packed file>
+ *        iMatePack check <packed file>
+ */
+
+#include "Moves/SliderAttacks.h"
+#include "State/PackedPosition.h"
+#include "Utils/Clock.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Records written at a time
+#define PACK_BUFFER_SIZE 4096
+
+static int pack_file(const char *input_path, const char *output_path) {
+    FILE *input = fopen(input_path, "r");
+    if (input == NULL) {
+        fprintf(stderr, "cannot open %s\n", input_path);
+        return 1;
+    }
+
+    FILE *output = fopen(output_path, "ab");
+    if (output == NULL) {
+        fprintf(stderr, "cannot open %s\n", output_path);
+        fclose(input);
+        return 1;
+    }
+
+    static packed_position_t buffer[PACK_BUFFER_SIZE];
+    state_t *state = new_state();
+    char *line = NULL;
+    size_t line_capacity = 0;
+    size_t buffered = 0;
+    long packed = 0, skipped = 0;
+    bool written = true;
+
+    while (written && getline(&line, &line_capacity, input) != -1) {
+        int result;
+        if (!parse_labeled_position(line, state, &result) || !pack_position(state, 0, result, &buffer[buffered])) {
+            skipped++;
+            continue;
+        }
+
+        packed++;
+        if (++buffered == PACK_BUFFER_SIZE) {
+            written = write_packed_positions(output, buffer, buffered);
+            buffered = 0;
+        }
+    }
+
+    if (written) written = write_packed_positions(output, buffer, buffered);
+    written = fclose(output) == 0 && written;
+
+    free(line);
+    free_state(state);
+    fclose(input);
+
+    if (!written) {
+        fprintf(stderr, "cannot write %s\n", output_path);
+        return 1;
+    }
+
+    printf("%ld positions packed, %ld lines skipped\n", packed, skipped);
+    return 0;
+}
+
+static int check_file(const char *path) {
+    packed_position_file_t *file = open_packed_positions(path);
+    if (file == NULL) {
+        fprintf(stderr, "%s is not a file of packed positions\n", path);
+        return 1;
+    }
+
+    size_t count;
+    const packed_position_t *positions = get_packed_positions(file, &count);
+    state_t *state = new_state();
+    long results[3] = {0, 0, 0};
+    long invalid = 0;
+    const int64_t start_time = get_time_ms();
+
+    for (size_t i = 0; i < count; i++) {
+        if (!unpack_position(&positions[i], state) || positions[i].result > PACKED_WHITE_WINS) {
+            invalid++;
+            continue;
+        }
+        results[positions[i].result]++;
+    }
+
+    const int64_t elapsed = get_time_ms() - start_time;
+    printf("%zu records, %ld invalid, white wins %ld, draws %ld, black wins %ld, %.0f records/s\n", count, invalid,
+           results[PACKED_WHITE_WINS], results[PACKED_DRAW], results[PACKED_BLACK_WINS],
+           elapsed > 0 ? count * 1000.0 / elapsed : 0.0);
+
+    free_state(state);
+    close_packed_positions(file);
+    return invalid == 0 ? 0 : 1;
+}
+
+int main(int argc, char **argv) {
+    init_slider_attacks();
+
+    if (argc == 4 && strcmp(argv[1], "pack") == 0) return pack_file(argv[2], argv[3]);
+    if (argc == 3 && strcmp(argv[1], "check") == 0) return check_file(argv[2]);
+
+    fprintf(stderr, "usage: %s pack <text file> <packed file>\n       %s check <packed file>\n", argv[0], argv[0]);
+    return 1;
+}
@@ -0,0 +1,96 @@
+/* iMate -- Copyright (C) 2024 Martin Newbound */
+
+/**
+ * @file TexelTuner.c
+ * @brief Tunes PIECE_WEIGHT and PIECE_SQUARE_TABLES on labeled positions and writes a new EvaluationData.c.
+ *
+ * @details The positions are read once and reduced to their evaluation features, the scale of the sigmoid is
+ * fitted to the current evaluation unless given, then the evaluation data is tuned for a number of epochs on all
+ * the processors. The progress is printed every PROGRESS_INTERVAL epochs.
+ *
+ * Usage: iMateTune <positions> [output <file>] [epochs <n>] [rate <centipawns>] [threads <n>] [k <scale>]
+ */
+
+#include "Evaluation/Tuning.h"
+#include "Moves/SliderAttacks.h"
+#include "Threads/ThreadPool.h"
+#include "Utils/Clock.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DEFAULT_EPOCHS 500
+#define DEFAULT_LEARNING_RATE 1.0
+#define DEFAULT_OUTPUT "EvaluationData.tuned.c"
+#define PROGRESS_INTERVAL 25
+
+/**
+ * @brief Prints the error every PROGRESS_INTERVAL epochs.
+ *
+ * @param context The time the tuning started, in milliseconds.
+ */
+static void print_progress(void *context, int epoch, double error) {
+    if (epoch % PROGRESS_INTERVAL != 0) return;
+
+    const int64_t elapsed = get_time_ms() - *(const int64_t *)context;
+    printf("epoch %5d  error %.8f  %.1f s\n", epoch, error, elapsed / 1000.0);
+    fflush(stdout);
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <positions> [output <file>] [epochs <n>] [rate <centipawns>] [threads <n>] [k <scale>]\n", argv[0]);
+        return 1;
+    }
+
+    const char *output = DEFAULT_OUTPUT;
+    int epochs = DEFAULT_EPOCHS;
+    double learning_rate = DEFAULT_LEARNING_RATE;
+    int thread_count = get_processor_count();
+    double k = 0.0;
+
+    for (int i = 2; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "output") == 0) output = argv[i + 1];
+        else if (strcmp(argv[i], "epochs") == 0) epochs = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "rate") == 0) learning_rate = atof(argv[i + 1]);
+        else if (strcmp(argv[i], "threads") == 0) thread_count = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "k") == 0) k = atof(argv[i + 1]);
+        else fprintf(stderr, "unknown option %s\n", argv[i]);
+    }
+
+    init_slider_attacks();
+    int64_t start_time = get_time_ms();
+    tuning_set_t *set = new_tuning_set();
+    long skipped;
+
+    const long loaded = load_tuning_positions(set, argv[1], &skipped);
+    if (loaded <= 0) {
+        fprintf(stderr, loaded < 0 ? "cannot open %s\n" : "no labeled positions in %s\n", argv[1]);
+        free_tuning_set(set);
+        return 1;
+    }
+    printf("%ld positions loaded, %ld lines skipped, %.1f s\n", loaded, skipped, (get_time_ms() - start_time) / 1000.0);
+
+    thread_pool_t *pool = new_thread_pool(thread_count);
+    evaluation_parameters_t parameters;
+    get_evaluation_parameters(&parameters);
+
+    if (k <= 0.0) k = find_tuning_scale(set, &parameters, pool);
+    printf("k %.4f  initial error %.8f  %d threads\n", k, compute_tuning_error(set, &parameters, k, pool), get_thread_pool_size(pool));
+
+    start_time = get_time_ms();
+    const double error = tune_evaluation(set, &parameters, k, epochs, learning_rate, pool, print_progress, &start_time);
+    printf("final error %.8f after %d epochs, %.1f s\n", error, epochs, (get_time_ms() - start_time) / 1000.0);
+
+    free_thread_pool(pool);
+    free_tuning_set(set);
+
+    if (!write_evaluation_data(output, &parameters)) {
+        fprintf(stderr, "cannot write %s\n", output);
+        return 1;
+    }
+
+    printf("evaluation data written to %s\n", output);
+    return 0;
+}
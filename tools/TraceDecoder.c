@@ -0,0 +1,118 @@
+/* iMate -- Copyright (C) 2024 Martin Newbound */
+
+/**
+ * @file TraceDecoder.c
+ * @brief Prints the search events held by a trace dump ("trace dump" command or SIGUSR1) as text.
+ *
+ * @details Each ring is printed oldest event first, one event per line. Times are in microseconds since tracing
+ * was set up in the engine, converted from cycle counter ticks with the two clock readings of the dump header.
+ *
+ * Usage: iMateTrace <file> [ring id] [event type]
+ */
+
+#include "Search/SearchTrace.h"
+#include "Search/TranspositionTable.h"
+#include "Moves/Move.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *BOUND_NAMES[4] = {"none", "upper", "lower", "exact"};
+
+/**
+ * @brief Prints one event.
+ *
+ * @param event The event.
+ * @param header The header of the dump, used to convert the timestamp.
+ * @param ns_per_tick The length of a tick in nanoseconds.
+ */
+static void print_event(const trace_event_t *event, const trace_file_header_t *header, double ns_per_tick) {
+    const double time_us = (double)(int64_t)(event->timestamp - header->start_ticks) * ns_per_tick / 1000.0;
+    printf("%14.3f us  %-9s depth %3d ply %3d", time_us, get_trace_event_name(event->type), event->depth, event->ply);
+
+    switch (event->type) {
+        case TRACE_NODE:
+            printf("  alpha %d", event->score);
+            break;
+
+        case TRACE_CUTOFF:
+        case TRACE_ITERATION:
+        case TRACE_TT_STORE: {
+            char move_string[MOVE_STRING_LENGTH] = "0000";
+            if (event->move_key != NULL_MOVE_KEY) move_key_to_string(event->move_key, move_string);
+            printf("  move %-5s score %d", move_string, event->score);
+            if (event->type == TRACE_TT_STORE) printf("  bound %s", BOUND_NAMES[event->bound & 3]);
+            break;
+        }
+
+        default:
+            break;
+    }
+
+    printf("\n");
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <file> [ring id] [event type]\n", argv[0]);
+        return 1;
+    }
+
+    const long ring_filter = argc > 2 ? strtol(argv[2], NULL, 10) : -1;
+    const char *type_filter = argc > 3 ? argv[3] : NULL;
+
+    FILE *file = fopen(argv[1], "rb");
+    if (file == NULL) {
+        fprintf(stderr, "cannot open %s\n", argv[1]);
+        return 1;
+    }
+
+    trace_file_header_t header;
+    if (fread(&header, sizeof(header), 1, file) != 1 || memcmp(header.magic, TRACE_FILE_MAGIC, sizeof(header.magic)) != 0) {
+        fprintf(stderr, "%s is not a search trace\n", argv[1]);
+        fclose(file);
+        return 1;
+    }
+    if (header.version != TRACE_FILE_VERSION) {
+        fprintf(stderr, "%s has version %u, expected %d\n", argv[1], header.version, TRACE_FILE_VERSION);
+        fclose(file);
+        return 1;
+    }
+
+    // Without a usable calibration the times are printed in ticks
+    const uint64_t elapsed_ticks = header.dump_ticks - header.start_ticks;
+    const int64_t elapsed_ns = header.dump_time_ns - header.start_time_ns;
+    const double ns_per_tick = elapsed_ticks > 0 && elapsed_ns > 0 ? (double)elapsed_ns / (double)elapsed_ticks : 1000.0;
+
+    printf("%u rings, dumped %.3f s after tracing started\n", header.ring_count, (double)elapsed_ns / 1e9);
+
+    for (uint32_t ring = 0; ring < header.ring_count; ring++) {
+        trace_ring_header_t ring_header;
+        if (fread(&ring_header, sizeof(ring_header), 1, file) != 1) {
+            fprintf(stderr, "truncated trace\n");
+            break;
+        }
+
+        const bool selected = ring_filter < 0 || ring_filter == (long)ring_header.ring_id;
+        if (selected) {
+            printf("\nring %u: %u of %llu events\n", ring_header.ring_id, ring_header.event_count,
+                   (unsigned long long)ring_header.total_events);
+        }
+
+        for (uint32_t i = 0; i < ring_header.event_count; i++) {
+            trace_event_t event;
+            if (fread(&event, sizeof(event), 1, file) != 1) {
+                fprintf(stderr, "truncated trace\n");
+                fclose(file);
+                return 1;
+            }
+
+            if (!selected || (type_filter != NULL && strcmp(type_filter, get_trace_event_name(event.type)) != 0)) continue;
+            print_event(&event, &header, ns_per_tick);
+        }
+    }
+
+    fclose(file);
+    return 0;
+}